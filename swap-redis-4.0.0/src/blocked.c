@@ -189,7 +189,11 @@ void unblockClient(client *c) {
         if (server.masterhost == NULL) {
             removeVisitingSSDBKey(c->cmd, c->argc, c->argv);
             if (c->cmd->flags & CMD_WRITE) {
-                if (c->first_key_index != 0) {
+                if (c->ssdb_split) {
+                    int j;
+                    for (j = 1; j < c->argc; j++)
+                        unblockClientWritingOnSameKey(c->argv[j]);
+                } else if (c->first_key_index != 0) {
                     robj* keyobj = c->argv[c->first_key_index];
                     unblockClientWritingOnSameKey(keyobj);
                 }
@@ -257,7 +261,7 @@ int replyToBlockedClientTimedOut(client *c) {
                                     c->btype == BLOCKED_NO_WRITE_TO_SSDB)) {
         serverLog(LL_DEBUG, "[!!!!]block timeout(client:%p,fd:%d,btype:%d), reset it", (void*)c, c->fd, c->btype);
         if (c->btype == BLOCKED_WRITE_SAME_SSDB_KEY)
-            removeClientFromListForBlockedKey(c, server.db[0].blocking_keys_write_same_ssdbkey, c->argv[1]);
+            removeClientFromListForBlockedKey(c, server.db[0].blocking_keys_write_same_ssdbkey, c->argv[c->first_key_index]);
         else if (c->btype == BLOCKED_NO_READ_WRITE_TO_SSDB)
             removeClientWaitingSSDBflushall(c);
         else if (c->btype == BLOCKED_NO_WRITE_TO_SSDB)
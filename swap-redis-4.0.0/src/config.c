@@ -475,6 +475,12 @@ void loadServerConfigFromString(char *config) {
                 err = "master-max-concurrent-transferring-keys must be 0 or greater";
                 goto loaderr;
             }
+         } else if (!strcasecmp(argv[0],"ssdb-transfer-batch-size") && argc == 2) {
+            server.ssdb_transfer_batch_size = atoi(argv[1]);
+            if (server.ssdb_transfer_batch_size < 1) {
+                err = "ssdb-transfer-batch-size must be 1 or greater";
+                goto loaderr;
+            }
          } else if (!strcasecmp(argv[0],"slave-max-concurrent-ssdb-swap-count") && argc == 2) {
             server.slave_max_concurrent_ssdb_swap_count = atoi(argv[1]);
             if (server.slave_max_concurrent_ssdb_swap_count < 0) {
@@ -1304,6 +1310,8 @@ void configSetCommand(client *c) {
       "master-max-concurrent-loading-keys",server.master_max_concurrent_loading_keys,0,LLONG_MAX) {
     } config_set_numerical_field(
       "master-max-concurrent-transferring-keys",server.master_max_concurrent_transferring_keys,0,LLONG_MAX) {
+    } config_set_numerical_field(
+      "ssdb-transfer-batch-size",server.ssdb_transfer_batch_size,1,LLONG_MAX) {
     } config_set_numerical_field(
       "slave-max-concurrent-ssdb-swap-count",server.slave_max_concurrent_ssdb_swap_count,0,LLONG_MAX) {
     } config_set_numerical_field(
@@ -1507,6 +1515,7 @@ void configGetCommand(client *c) {
     config_get_numerical_field("slave-transfer-ssdb-snapshot-timeout", server.slave_transfer_ssdb_snapshot_timeout);
     config_get_numerical_field("master-max-concurrent-loading-keys", server.master_max_concurrent_loading_keys);
     config_get_numerical_field("master-max-concurrent-transferring-keys", server.master_max_concurrent_transferring_keys);
+    config_get_numerical_field("ssdb-transfer-batch-size", server.ssdb_transfer_batch_size);
     config_get_numerical_field("slave-max-concurrent-ssdb-swap-count", server.slave_max_concurrent_ssdb_swap_count);
     config_get_numerical_field("slave-max-ssdb-swap-count-everytime", server.slave_max_ssdb_swap_count_everytime);
     config_get_numerical_field("coldkey-filter-times-everytime", server.coldkey_filter_times_everytime);
@@ -2283,6 +2292,7 @@ int rewriteConfig(char *path) {
     rewriteConfigNumericalOption(state,"slave-transfer-ssdb-snapshot-timeout",server.slave_transfer_ssdb_snapshot_timeout,SLAVE_SSDB_TRANSFER_SNAPSHOT_TIMEOUT);
     rewriteConfigNumericalOption(state,"master-max-concurrent-loading-keys",server.master_max_concurrent_loading_keys,MASTER_MAX_CONCURRENT_LOADING_KEYS);
     rewriteConfigNumericalOption(state,"master-max-concurrent-transferring-keys",server.master_max_concurrent_transferring_keys,MASTER_MAX_CONCURRENT_TRANSFERRING_KEYS);
+    rewriteConfigNumericalOption(state,"ssdb-transfer-batch-size",server.ssdb_transfer_batch_size,SSDB_TRANSFER_BATCH_SIZE);
     rewriteConfigNumericalOption(state,"slave-max-concurrent-ssdb-swap-count",server.slave_max_concurrent_ssdb_swap_count,SLAVE_MAX_CONCURRENT_SSDB_SWAP_COUNT);
     rewriteConfigNumericalOption(state,"slave-max-ssdb-swap-count-everytime",server.slave_max_ssdb_swap_count_everytime,SLAVE_MAX_SSDB_SWAP_COUNT_EVERYTIME);
     rewriteConfigNumericalOption(state,"coldkey-filter-times-everytime",server.coldkey_filter_times_everytime,COLDKEY_FILTER_TIMES_EVERYTIME);
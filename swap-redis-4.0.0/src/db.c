@@ -169,6 +169,15 @@ robj *lookupKeyWriteOrReply(client *c, robj *key, robj *reply) {
  * counter of the value if needed.
  *
  * The program is aborted if the key already exists. */
+/* The dict of the evicted db only records which keys live in SSDB and does
+ * not keep the value it is given (see evictedDbDictType), so the reference
+ * dbAdd() and dbOverwrite() take over is dropped again. A value nobody else
+ * holds is left alone: callers may still use it right after adding it. */
+static void dbReleaseUnstoredValue(redisDb *db, robj *val) {
+    if (db->dict->type->noValue && val->refcount > 1)
+        decrRefCount(val);
+}
+
 void dbAdd(redisDb *db, robj *key, robj *val) {
     sds copy;
     if (server.swap_mode) {
@@ -182,6 +191,7 @@ void dbAdd(redisDb *db, robj *key, robj *val) {
     serverAssertWithInfo(NULL,key,retval == DICT_OK);
     if (val->type == OBJ_LIST) signalListAsReady(db, key);
     if (server.cluster_enabled) slotToKeyAdd(key);
+    dbReleaseUnstoredValue(db,val);
  }
 
 /* Overwrite an existing key with a new value. Incrementing the reference
@@ -206,6 +216,7 @@ void dbOverwrite(redisDb *db, robj *key, robj *val) {
     } else {
         dictReplace(db->dict, key->ptr, val);
     }
+    dbReleaseUnstoredValue(db,val);
 }
 
 /* High level Set operation. This function can be used in order to set
@@ -217,12 +228,12 @@ void dbOverwrite(redisDb *db, robj *key, robj *val) {
  *
  * All the new keys in the database should be craeted via this interface. */
 void setKey(redisDb *db, robj *key, robj *val) {
+    incrRefCount(val);
     if (lookupKeyWrite(db,key) == NULL) {
         dbAdd(db,key,val);
     } else {
         dbOverwrite(db,key,val);
     }
-    incrRefCount(val);
     removeExpire(db,key);
     signalModifiedKey(db,key);
 }
@@ -147,7 +147,7 @@ int dictIterDefragEntry(dictIterator *iter) {
         if (newde) {
             defragged++;
             iter->nextEntry = newde;
-            iter->entry->next = newde;
+            dictSetNext(iter->entry, newde);
         }
     }
     /* handle the case of the first entry in the hash bucket. */
@@ -256,10 +256,11 @@ double *zslDefrag(zskiplist *zsl, double score, sds oldele, sds newele) {
 dictEntry* replaceSateliteDictKeyPtrAndOrDefragDictEntry(dict *d, sds oldkey, sds newkey, unsigned int hash, int *defragged) {
     dictEntry **deref = dictFindEntryRefByPtrAndHash(d, oldkey, hash);
     if (deref) {
-        dictEntry *de = *deref;
+        dictEntry *de = dictEntryRefGet(deref);
         dictEntry *newde = activeDefragAlloc(de);
         if (newde) {
-            de = *deref = newde;
+            dictEntryRefSet(deref, newde);
+            de = newde;
             (*defragged)++;
         }
         if (newkey)
@@ -429,12 +430,13 @@ void defragScanCallback(void *privdata, const dictEntry *de) {
  * used in order to defrag the dictEntry allocations. */
 void defragDictBucketCallback(void *privdata, dictEntry **bucketref) {
     UNUSED(privdata);
-    while(*bucketref) {
-        dictEntry *de = *bucketref, *newde;
+    while(dictEntryRefGet(bucketref)) {
+        dictEntry *de = dictEntryRefGet(bucketref), *newde;
         if ((newde = activeDefragAlloc(de))) {
-            *bucketref = newde;
+            dictEntryRefSet(bucketref, newde);
+            de = newde;
         }
-        bucketref = &(*bucketref)->next;
+        bucketref = &de->next;
     }
 }
 
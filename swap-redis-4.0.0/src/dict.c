@@ -62,6 +62,9 @@
 static int dict_can_resize = 1;
 static unsigned int dict_force_resize_ratio = 5;
 
+/* Returned by dictGetVal() for the entries of noValue dicts. */
+void *dictNoValue = NULL;
+
 /* -------------------------- private prototypes ---------------------------- */
 
 static int _dictExpandIfNeeded(dict *ht);
@@ -204,10 +207,10 @@ int dictRehash(dict *d, int n) {
         while(de) {
             unsigned int h;
 
-            nextde = de->next;
+            nextde = dictGetNext(de);
             /* Get the index in the new hash table */
             h = dictHashKey(d, de->key) & d->ht[1].sizemask;
-            de->next = d->ht[1].table[h];
+            dictSetNext(de, d->ht[1].table[h]);
             d->ht[1].table[h] = de;
             d->ht[0].used--;
             d->ht[1].used++;
@@ -307,8 +310,13 @@ dictEntry *dictAddRaw(dict *d, void *key, dictEntry **existing)
      * system it is more likely that recently added entries are accessed
      * more frequently. */
     ht = dictIsRehashing(d) ? &d->ht[1] : &d->ht[0];
-    entry = zmalloc(sizeof(*entry));
-    entry->next = ht->table[index];
+    if (d->type->noValue) {
+        entry = zmalloc(offsetof(dictEntry,v));
+        entry->next = (dictEntry*)((uintptr_t)ht->table[index] | DICT_ENTRY_NO_VALUE);
+    } else {
+        entry = zmalloc(sizeof(*entry));
+        entry->next = ht->table[index];
+    }
     ht->table[index] = entry;
     ht->used++;
 
@@ -339,6 +347,7 @@ int dictReplace(dict *d, void *key, void *val)
      * as the previous one. In this context, think to reference counting,
      * you want to increment (set), and then decrement (free), and not the
      * reverse. */
+    if (!dictEntryHasValue(existing)) return 0;
     auxentry = *existing;
     dictSetVal(d, existing, val);
     dictFreeVal(d, &auxentry);
@@ -379,9 +388,9 @@ static dictEntry *dictGenericDelete(dict *d, const void *key, int nofree) {
             if (key==he->key || dictCompareKeys(d, key, he->key)) {
                 /* Unlink the element from the list */
                 if (prevHe)
-                    prevHe->next = he->next;
+                    dictSetNext(prevHe, dictGetNext(he));
                 else
-                    d->ht[table].table[idx] = he->next;
+                    d->ht[table].table[idx] = dictGetNext(he);
                 if (!nofree) {
                     dictFreeKey(d, he);
                     dictFreeVal(d, he);
@@ -391,7 +400,7 @@ static dictEntry *dictGenericDelete(dict *d, const void *key, int nofree) {
                 return he;
             }
             prevHe = he;
-            he = he->next;
+            he = dictGetNext(he);
         }
         if (!dictIsRehashing(d)) break;
     }
@@ -450,7 +459,7 @@ int _dictClear(dict *d, dictht *ht, void(callback)(void *)) {
 
         if ((he = ht->table[i]) == NULL) continue;
         while(he) {
-            nextHe = he->next;
+            nextHe = dictGetNext(he);
             dictFreeKey(d, he);
             dictFreeVal(d, he);
             zfree(he);
@@ -487,7 +496,7 @@ dictEntry *dictFind(dict *d, const void *key)
         while(he) {
             if (key==he->key || dictCompareKeys(d, key, he->key))
                 return he;
-            he = he->next;
+            he = dictGetNext(he);
         }
         if (!dictIsRehashing(d)) return NULL;
     }
@@ -587,7 +596,7 @@ dictEntry *dictNext(dictIterator *iter)
         if (iter->entry) {
             /* We need to save the 'next' here, the iterator user
              * may delete the entry we are returning. */
-            iter->nextEntry = iter->entry->next;
+            iter->nextEntry = dictGetNext(iter->entry);
             return iter->entry;
         }
     }
@@ -639,12 +648,12 @@ dictEntry *dictGetRandomKey(dict *d)
     listlen = 0;
     orighe = he;
     while(he) {
-        he = he->next;
+        he = dictGetNext(he);
         listlen++;
     }
     listele = random() % listlen;
     he = orighe;
-    while(listele--) he = he->next;
+    while(listele--) he = dictGetNext(he);
     return he;
 }
 
@@ -726,7 +735,7 @@ unsigned int dictGetSomeKeys(dict *d, dictEntry **des, unsigned int count) {
                      * empty while iterating. */
                     *des = he;
                     des++;
-                    he = he->next;
+                    he = dictGetNext(he);
                     stored++;
                     if (stored == count) return stored;
                 }
@@ -853,7 +862,7 @@ unsigned long dictScan(dict *d,
         if (bucketfn) bucketfn(privdata, &t0->table[v & m0]);
         de = t0->table[v & m0];
         while (de) {
-            next = de->next;
+            next = dictGetNext(de);
             fn(privdata, de);
             de = next;
         }
@@ -875,7 +884,7 @@ unsigned long dictScan(dict *d,
         if (bucketfn) bucketfn(privdata, &t0->table[v & m0]);
         de = t0->table[v & m0];
         while (de) {
-            next = de->next;
+            next = dictGetNext(de);
             fn(privdata, de);
             de = next;
         }
@@ -887,7 +896,7 @@ unsigned long dictScan(dict *d,
             if (bucketfn) bucketfn(privdata, &t1->table[v & m1]);
             de = t1->table[v & m1];
             while (de) {
-                next = de->next;
+                next = dictGetNext(de);
                 fn(privdata, de);
                 de = next;
             }
@@ -973,7 +982,7 @@ static int _dictKeyIndex(dict *d, const void *key, unsigned int hash, dictEntry
                 if (existing) *existing = he;
                 return -1;
             }
-            he = he->next;
+            he = dictGetNext(he);
         }
         if (!dictIsRehashing(d)) break;
     }
@@ -1017,7 +1026,7 @@ dictEntry **dictFindEntryRefByPtrAndHash(dict *d, const void *oldptr, unsigned i
             if (oldptr==he->key)
                 return heref;
             heref = &he->next;
-            he = *heref;
+            he = dictEntryRefGet(heref);
         }
         if (!dictIsRehashing(d)) return NULL;
     }
@@ -1053,7 +1062,7 @@ size_t _dictGetStatsHt(char *buf, size_t bufsize, dictht *ht, int tableid) {
         he = ht->table[i];
         while(he) {
             chainlen++;
-            he = he->next;
+            he = dictGetNext(he);
         }
         clvector[(chainlen < DICT_STATS_VECTLEN) ? chainlen : (DICT_STATS_VECTLEN-1)]++;
         if (chainlen > maxchainlen) maxchainlen = chainlen;
@@ -34,6 +34,7 @@
  */
 
 #include <stdint.h>
+#include <stddef.h>
 
 #ifndef __DICT_H
 #define __DICT_H
@@ -44,8 +45,12 @@
 /* Unused arguments generate annoying warnings... */
 #define DICT_NOTUSED(V) ((void) V)
 
+/* Entries of dicts whose type sets 'noValue' are allocated without the 'v'
+ * field, only key and next. They are told apart by the low bit of 'next'
+ * (DICT_ENTRY_NO_VALUE), so always go through dictGetNext() / dictSetNext(). */
 typedef struct dictEntry {
     void *key;
+    struct dictEntry *next;
     union {
         void *val;
         uint64_t u64;
@@ -56,7 +61,6 @@ typedef struct dictEntry {
         } visiting_ssdb;
         double d;
     } v;
-    struct dictEntry *next;
 } dictEntry;
 
 typedef struct dictType {
@@ -66,6 +70,8 @@ typedef struct dictType {
     int (*keyCompare)(void *privdata, const void *key1, const void *key2);
     void (*keyDestructor)(void *privdata, void *key);
     void (*valDestructor)(void *privdata, void *obj);
+    int noValue;    /* sets of keys: values passed in are ignored and
+                       dictGetVal() returns dictNoValue. */
 } dictType;
 
 /* This is our hash table structure. Every dictionary has two of this as we
@@ -104,12 +110,31 @@ typedef void (dictScanBucketFunction)(void *privdata, dictEntry **bucketref);
 /* This is the initial size of every hash table */
 #define DICT_HT_INITIAL_SIZE     4
 
+/* What dictGetVal() returns for entries of noValue dicts. */
+extern void *dictNoValue;
+
 /* ------------------------------- Macros ------------------------------------*/
+#define DICT_ENTRY_NO_VALUE ((uintptr_t)1)
+#define dictEntryHasValue(entry) \
+    (((uintptr_t)(entry)->next & DICT_ENTRY_NO_VALUE) == 0)
+#define dictGetNext(entry) \
+    ((dictEntry*)((uintptr_t)(entry)->next & ~DICT_ENTRY_NO_VALUE))
+#define dictSetNext(entry, _next_) dictEntryRefSet(&(entry)->next, _next_)
+/* Bucket heads and 'next' fields, as returned by dictFindEntryRefByPtrAndHash()
+ * or passed to dictScanBucketFunction: the tag belongs to the owner entry. */
+#define dictEntryRefGet(ref) \
+    ((dictEntry*)((uintptr_t)*(ref) & ~DICT_ENTRY_NO_VALUE))
+#define dictEntryRefSet(ref, _de_) \
+    (*(ref) = (dictEntry*)((uintptr_t)(_de_) | \
+        ((uintptr_t)*(ref) & DICT_ENTRY_NO_VALUE)))
+
 #define dictFreeVal(d, entry) \
-    if ((d)->type->valDestructor) \
+    if ((d)->type->valDestructor && dictEntryHasValue(entry)) \
         (d)->type->valDestructor((d)->privdata, (entry)->v.val)
 
 #define dictSetVal(d, entry, _val_) do { \
+    if (!dictEntryHasValue(entry)) \
+        break; \
     if ((d)->type->valDup) \
         (entry)->v.val = (d)->type->valDup((d)->privdata, _val_); \
     else \
@@ -143,11 +168,13 @@ typedef void (dictScanBucketFunction)(void *privdata, dictEntry **bucketref);
 
 #define dictHashKey(d, key) (d)->type->hashFunction(key)
 #define dictGetKey(he) ((he)->key)
-#define dictGetVal(he) ((he)->v.val)
+#define dictGetVal(he) (dictEntryHasValue(he) ? (he)->v.val : dictNoValue)
 #define dictGetSignedIntegerVal(he) ((he)->v.s64)
 #define dictGetUnsignedIntegerVal(he) ((he)->v.u64)
 #define dictGetDoubleVal(he) ((he)->v.d)
 #define dictSlots(d) ((d)->ht[0].size+(d)->ht[1].size)
+#define dictEntrySize(d) \
+    ((d)->type->noValue ? offsetof(dictEntry,v) : sizeof(dictEntry))
 #define dictSize(d) ((d)->ht[0].used+(d)->ht[1].used)
 #define dictIsRehashing(d) ((d)->rehashidx != -1)
 
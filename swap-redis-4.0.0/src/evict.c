@@ -732,7 +732,10 @@ int prologOfLoadingFromSSDB(client* c, robj *keyobj) {
     return C_OK;
 }
 
-int prologOfEvictingToSSDB(robj *keyobj, redisDb *db) {
+/* Compose the "redis_req_restore" command restoring the key to SSDB, under
+ * a new transfer id which is stored in *transfer_id. Returns NULL if the key
+ * no longer exists or has expired. */
+static sds composeRestoreCmdForSSDB(robj *keyobj, redisDb *db, unsigned long long *transfer_id) {
     rio cmd, payload;
     long long ttl = 0;
     long long expiretime;
@@ -743,13 +746,13 @@ int prologOfEvictingToSSDB(robj *keyobj, redisDb *db) {
     de = dictFind(db->dict, keyobj->ptr);
     if (!de) {
         serverLog(LL_DEBUG, "key: %s is not existed in redis.", (char *)keyobj->ptr);
-        return C_ERR;
+        return NULL;
     }
     expiretime = getExpire(db, keyobj);
 
     if (expireIfNeeded(db, keyobj)) {
         serverLog(LL_DEBUG, "key: %s is expired in redis, dbid: %d", (char *)keyobj->ptr, db->id);
-        return C_ERR;
+        return NULL;
     }
 
     /* when the key was expired/evicted before but had not been deleted from SSDB. but now
@@ -790,20 +793,56 @@ int prologOfEvictingToSSDB(robj *keyobj, redisDb *db) {
     server.global_transfer_id++;
     serverAssert(rioWriteBulkLongLong(&cmd, server.global_transfer_id));
 
-    /* sendCommandToSSDB will free cmd.io.buffer.ptr. */
+    *transfer_id = server.global_transfer_id;
+    return cmd.io.buffer.ptr;
+}
+
+int prologOfEvictingToSSDB(robj *keyobj, redisDb *db) {
+    unsigned long long transfer_id;
+    sds cmd;
+
+    if ((cmd = composeRestoreCmdForSSDB(keyobj, db, &transfer_id)) == NULL)
+        return C_ERR;
+
+    /* sendCommandToSSDB will free cmd. */
     /* Using the same connection with propagate method. */
-    if (sendCommandToSSDB(server.ssdb_client, cmd.io.buffer.ptr) != C_OK) {
+    if (sendCommandToSSDB(server.ssdb_client, cmd) != C_OK) {
         serverLog(LL_DEBUG, "Failed to send the restore cmd to SSDB.");
         return C_FD_ERR;
     }
 
-    setTransferringDB(db, keyobj, server.global_transfer_id);
+    setTransferringDB(db, keyobj, transfer_id);
     serverLog(LL_DEBUG, "Evicting key: %s to SSDB, maxmemory: %lld, zmalloc_used_memory: %lu.",
               (char *)(keyobj->ptr), server.maxmemory, zmalloc_used_memory());
 
     return C_OK;
 }
 
+/* Called for every key SSDB answered ssdb-resp-del for, to find out when
+ * all the keys of a batch were transferred. */
+void transferGroupKeyDone(unsigned long long transfer_id) {
+    listIter li;
+    listNode *ln;
+
+    listRewind(server.ssdb_transfer_groups, &li);
+    while ((ln = listNext(&li)) != NULL) {
+        ssdbTransferGroup *group = ln->value;
+
+        if (transfer_id < group->first_id || transfer_id > group->last_id)
+            continue;
+        if (--group->pending == 0) {
+            long long elapsed = ustime() - group->start;
+
+            server.stat_transfer_groups_done++;
+            server.stat_transfer_groups_usec += elapsed;
+            if (elapsed > server.stat_transfer_groups_max_usec)
+                server.stat_transfer_groups_max_usec = elapsed;
+            listDelNode(server.ssdb_transfer_groups, ln);
+        }
+        return;
+    }
+}
+
 #define OBJ_COMPUTE_SIZE_DEF_SAMPLES 5 /* Default sample size. */
 size_t estimateKeyMemoryUsage(dictEntry *de) {
     size_t usage;
@@ -866,27 +905,35 @@ void addHotKeys() {
     }
 }
 
+/* Pick up to ssdb-transfer-batch-size cold keys from ColdKeyPool and restore
+ * them to SSDB with a single write. The keys are still answered one by one by
+ * ssdb-resp-del, the batch is tracked as a ssdbTransferGroup to measure how
+ * long SSDB takes to take them all. */
 int tryEvictingKeysToSSDB(size_t *mem_tofree) {
     mstime_t latency;
-    int k, i;
-    sds bestkey = NULL;
+    int k, i, j, numkeys = 0, batch;
     int bestdbid;
     redisDb *db;
     dict *dict;
     dictEntry *de;
+    robj *keys[EVPOOL_SIZE];
+    unsigned long long ids[EVPOOL_SIZE];
+    sds cmd, buf;
+    long long start;
+    size_t sent;
 
     latencyStartMonitor(latency);
     struct evictionPoolEntry *pool = ColdKeyPool;
 
-    unsigned long total_keys = 0, keys;
+    unsigned long total_keys = 0, nkeys;
 
     db = server.db;
     dict = db->dict;
-    if ((keys = dictSize(dict)) != 0) {
+    if ((nkeys = dictSize(dict)) != 0) {
         for (i = 0; i < server.coldkey_filter_times_everytime; i++) {
             coldKeyPopulate(dict, pool);
         }
-        total_keys += keys;
+        total_keys += nkeys;
     }
 
     /* there are no keys in ColdKeyPool to evict. */
@@ -895,8 +942,18 @@ int tryEvictingKeysToSSDB(size_t *mem_tofree) {
     /* limit concurrent number of transferring keys */
     if (dictSize(EVICTED_DATA_DB->transferring_keys) >= (unsigned long)server.master_max_concurrent_transferring_keys) return C_ERR;
 
+    /* keys of a group may leave transferring_keys without ssdb-resp-del,
+     * e.g. when the SSDB connection is lost, forget such groups. */
+    if (dictSize(EVICTED_DATA_DB->transferring_keys) == 0)
+        listEmpty(server.ssdb_transfer_groups);
+
+    batch = server.master_max_concurrent_transferring_keys -
+        (int)dictSize(EVICTED_DATA_DB->transferring_keys);
+    if (batch > server.ssdb_transfer_batch_size) batch = server.ssdb_transfer_batch_size;
+    if (batch > EVPOOL_SIZE) batch = EVPOOL_SIZE;
+
     /* Go backward from best to worst element to evict. */
-    for (k = EVPOOL_SIZE-1; k >= 0; k--) {
+    for (k = EVPOOL_SIZE-1; k >= 0 && numkeys < batch && *mem_tofree > 0; k--) {
         if (pool[k].key == NULL) continue;
         bestdbid = pool[k].dbid;
 
@@ -918,33 +975,80 @@ int tryEvictingKeysToSSDB(size_t *mem_tofree) {
             && dictFind(EVICTED_DATA_DB->loading_hot_keys, dictGetKey(de)) == NULL) {
             //&& !isMigratingSSDBKey(dictGetKey(de))) {
             size_t usage;
-            bestkey = dictGetKey(de);
+            sds bestkey = dictGetKey(de);
+            unsigned int lfu_counter = 255 & sdsgetlfu(bestkey);
+            unsigned int idle = 255 - lfu_counter;
+
+            /* the pool may hold the same key more than once. */
+            for (j = 0; j < numkeys; j++)
+                if (!sdscmp(keys[j]->ptr, bestkey)) break;
+            if (j < numkeys) continue;
+
             /* Estimate the memory usage of the bestkey. */
             usage = estimateKeyMemoryUsage(de);
 
             serverLog(LL_DEBUG, "The best key size: %lu", usage);
-            *mem_tofree = *mem_tofree - usage;
-            break;
+            *mem_tofree = usage < *mem_tofree ? *mem_tofree - usage : 0;
+
+            if (idle >= (unsigned long long)server.lowest_idle_val_of_cold_key)
+                keys[numkeys++] = createStringObject(bestkey,sdslen(bestkey));
         }
     }
 
-    /* Try to remove the selected key. */
-    if (bestkey) {
-        if (de) {
-            unsigned int lfu_counter = 255 & sdsgetlfu(dictGetKey(de));
-            unsigned int idle = 255 - lfu_counter;
-            if (idle >= (unsigned long long)server.lowest_idle_val_of_cold_key) {
-                robj *keyobj = createStringObject(bestkey,sdslen(bestkey));
-
-                db = server.db+bestdbid;
-                /* Try restoring the redis dumped data to SSDB. */
-                if (prologOfEvictingToSSDB(keyobj, db) == C_FD_ERR)
-                    return C_ERR;
-                decrRefCount(keyobj);
-            }
+    if (numkeys == 0) goto end;
+
+    /* Dump the selected keys into one pipelined restore batch. */
+    start = ustime();
+    db = server.db;
+    buf = sdsempty();
+    for (j = 0; j < numkeys; j++) {
+        cmd = composeRestoreCmdForSSDB(keys[j], db, &ids[j]);
+        if (cmd == NULL) {
+            decrRefCount(keys[j]);
+            keys[j] = NULL;
+            continue;
         }
+        buf = sdscatsds(buf, cmd);
+        sdsfree(cmd);
     }
 
+    sent = sdslen(buf);
+    if (sent == 0) {
+        sdsfree(buf);
+    } else if (sendCommandToSSDB(server.ssdb_client, buf) != C_OK) {
+        /* sendCommandToSSDB will free buf. */
+        serverLog(LL_DEBUG, "Failed to send the restore cmd to SSDB.");
+        for (j = 0; j < numkeys; j++)
+            if (keys[j]) decrRefCount(keys[j]);
+        return C_ERR;
+    } else {
+        ssdbTransferGroup *group = zmalloc(sizeof(*group));
+        int count = 0;
+
+        group->first_id = 0;
+        group->last_id = 0;
+        for (j = 0; j < numkeys; j++) {
+            if (!keys[j]) continue;
+            setTransferringDB(db, keys[j], ids[j]);
+            serverLog(LL_DEBUG, "Evicting key: %s to SSDB, maxmemory: %lld, zmalloc_used_memory: %lu.",
+                      (char *)(keys[j]->ptr), server.maxmemory, zmalloc_used_memory());
+            if (count++ == 0) group->first_id = ids[j];
+            group->last_id = ids[j];
+        }
+        group->pending = count;
+        group->start = start;
+        listAddNodeTail(server.ssdb_transfer_groups, group);
+
+        server.stat_transfer_batches++;
+        server.stat_transfer_batch_keys += count;
+        server.stat_transfer_batch_bytes += sent;
+        server.stat_transfer_batch_usec += ustime() - start;
+    }
+
+    for (j = 0; j < numkeys; j++)
+        if (keys[j]) decrRefCount(keys[j]);
+
+end:
     latencyEndMonitor(latency);
     latencyAddSampleIfNeeded("tryEvictingKeysToSSDB", latency);
     return C_OK;
@@ -1503,19 +1607,12 @@ void transferringOrLoadingBlockedClientTimeOut(client *c) {
 }
 
 /* must reply to SSDB avoid SSDB blocked. */
-void ssdbRespDelCommand(client *c) {
+/* Handle one key/transfer id pair of ssdb-resp-del, exactly one reply
+ * is added to the client. */
+static void ssdbRespDelGeneric(client *c, robj *keyobj, robj *idobj) {
     int numdel = 0;
-    robj* keyobj = c->argv[1];
     dictEntry* de;
 
-    preventCommandPropagation(c);
-
-    if (!server.swap_mode) {
-        addReplyErrorFormat(c,"Command only supported in swap-mode '%s'",
-                            (char *)c->argv[0]->ptr);
-        return;
-    }
-
     if (!(de = dictFind(EVICTED_DATA_DB->transferring_keys, keyobj->ptr))) {
         addReplyError(c, "key is already unblocked");
         return;
@@ -1523,7 +1620,7 @@ void ssdbRespDelCommand(client *c) {
     long long resp_transfer_id;
     unsigned long long transfer_id = dictGetUnsignedIntegerVal(de);
 
-    if (string2ll(c->argv[2]->ptr, sdslen(c->argv[2]->ptr), &resp_transfer_id) != 1 ||
+    if (string2ll(idobj->ptr, sdslen(idobj->ptr), &resp_transfer_id) != 1 ||
             resp_transfer_id != (long long)transfer_id) {
         addReplyError(c, "transfer id is not match");
         return;;
@@ -1533,6 +1630,7 @@ void ssdbRespDelCommand(client *c) {
         addReplyError(c, "flushall is going");
         return;
     } else {
+        transferGroupKeyDone(transfer_id);
         if (epilogOfEvictingToSSDB(keyobj) == C_OK) {
             serverLog(LL_DEBUG, "ssdbRespDelCommand fd:%d key: %s dictDelete ok.",
                       c->fd, (char *)keyobj->ptr);
@@ -1547,8 +1645,38 @@ void ssdbRespDelCommand(client *c) {
     addReplyLongLong(c, numdel);
 }
 
+/* ssdb-resp-del key transfer_id [key transfer_id ...]
+ *
+ * The batched form (more than one pair) replies an array with one
+ * reply per key, in the order of the arguments. */
+void ssdbRespDelCommand(client *c) {
+    int j;
+
+    preventCommandPropagation(c);
+
+    if (!server.swap_mode) {
+        addReplyErrorFormat(c,"Command only supported in swap-mode '%s'",
+                            (char *)c->argv[0]->ptr);
+        return;
+    }
+
+    if ((c->argc - 1) % 2 != 0) {
+        addReply(c, shared.syntaxerr);
+        return;
+    }
+
+    if (c->argc == 3) {
+        ssdbRespDelGeneric(c, c->argv[1], c->argv[2]);
+        return;
+    }
+
+    addReplyMultiBulkLen(c, (c->argc - 1) / 2);
+    for (j = 1; j < c->argc; j += 2)
+        ssdbRespDelGeneric(c, c->argv[j], c->argv[j+1]);
+}
+
 /* must reply to SSDB avoid SSDB blocked. */
-void ssdbRespRestoreCommand(client *c) {
+static void ssdbRespRestoreGeneric(client *c) {
     robj * key = c->argv[1];
     long long old_dirty = server.dirty;
     dictEntry* de;
@@ -1647,6 +1775,38 @@ void ssdbRespRestoreCommand(client *c) {
     }
 }
 
+/* ssdb-resp-restore key ttl payload REPLACE transfer_id [key ttl payload REPLACE transfer_id ...]
+ *
+ * The batched form (more than one group) replies an array with one
+ * reply per key, in the order of the arguments. Every group is handled
+ * as a single ssdb-resp-restore, so the propagation stays the same. */
+void ssdbRespRestoreCommand(client *c) {
+    robj **orig_argv = c->argv, *argv[6];
+    int orig_argc = c->argc, j;
+
+    if ((c->argc - 1) % 5 != 0) {
+        preventCommandPropagation(c);
+        addReply(c, shared.syntaxerr);
+        return;
+    }
+
+    if (c->argc == 6) {
+        ssdbRespRestoreGeneric(c);
+        return;
+    }
+
+    addReplyMultiBulkLen(c, (orig_argc - 1) / 5);
+    argv[0] = orig_argv[0];
+    for (j = 1; j < orig_argc; j += 5) {
+        memcpy(argv + 1, orig_argv + j, 5 * sizeof(robj*));
+        c->argv = argv;
+        c->argc = 6;
+        ssdbRespRestoreGeneric(c);
+    }
+    c->argv = orig_argv;
+    c->argc = orig_argc;
+}
+
 void ssdbRespNotfoundCommand(client *c) {
     dictEntry* de;
     robj *cmd = c->argv[1];
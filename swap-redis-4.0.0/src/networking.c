@@ -137,6 +137,7 @@ client *createClient(int fd) {
         c->ssdb_replies[1] = NULL;
         c->revert_len = 0;
         c->first_key_index = 0;
+        c->ssdb_split = NULL;
     }
     c->bpop.target = NULL;
     c->bpop.numreplicas = 0;
@@ -1637,18 +1638,20 @@ int handleResponseOfDeleteCheckConfirm(client *c) {
 
 void checkSSDBkeyIsDeleted(char* check_reply, struct redisCommand* cmd, int argc, robj** argv) {
     int *indexs = NULL;
-    int numkeys = 0;
+    int numkeys = 0, j;
     sds key;
 
     if (check_reply && !strcmp(check_reply, "check 1")) {
         indexs = getKeysFromCommand(cmd, argv, argc, &numkeys);
 
-        key = argv[indexs[0]]->ptr;
+        for (j = 0; j < numkeys; j++) {
+            key = argv[indexs[j]]->ptr;
 
-        if (NULL == dictFind(EVICTED_DATA_DB->delete_confirm_keys, key))
-            dictAddOrFind(server.maybe_deleted_ssdb_keys, key);
+            if (NULL == dictFind(EVICTED_DATA_DB->delete_confirm_keys, key))
+                dictAddOrFind(server.maybe_deleted_ssdb_keys, key);
 
-        serverLog(LL_DEBUG, "cmd: %s, key: %s is added to delete_confirm_keys.", cmd->name, key);
+            serverLog(LL_DEBUG, "cmd: %s, key: %s is added to delete_confirm_keys.", cmd->name, key);
+        }
 
         if (indexs) getKeysFreeResult(indexs);
     }
@@ -1833,8 +1836,11 @@ int removeVisitingSSDBKey(struct redisCommand *cmd, int argc, robj** argv) {
     if ( (cmd->flags & (CMD_READONLY | CMD_WRITE)) &&
          (cmd->flags & CMD_SWAP_MODE) ) {
         keys = getKeysFromCommand(cmd, argv, argc, &numkeys);
-        /* in swap_mode, we only support one key command. */
-        if (numkeys > 0) serverAssert(1 == numkeys);
+        /* in swap_mode, we only support one key command, except for the
+         * keys of a split command sent to SSDB. */
+        if (numkeys > 1)
+            serverAssert(cmd->proc == delCommand || cmd->proc == existsCommand
+                         || cmd->proc == mgetCommand);
 
         for (j = 0; j < numkeys; j ++) {
             robj* key = argv[keys[j]];
@@ -1866,7 +1872,6 @@ int removeVisitingSSDBKey(struct redisCommand *cmd, int argc, robj** argv) {
                     dictSetVisitingSSDBwriteCount(entry, visiting_write_num-1);
                 else if (cmd->flags & CMD_READONLY)
                     dictSetVisitingSSDBreadCount(entry, visiting_read_num-1);
-                removed = 0;
             }
         }
 
@@ -1887,9 +1892,10 @@ int isSpecialConnection(client *c) {
         return 0;
 }
 
+/* The reply of SSDB to these commands is not passed to the client as is. */
 int isSpecialCommand(client *c) {
-    if (c && c->cmd
-        && c->cmd->proc == migrateCommand)
+    if (c && ((c->cmd && c->cmd->proc == migrateCommand)
+              || c->ssdb_split))
         return 1;
     else
         return 0;
@@ -2029,6 +2035,9 @@ void handleSSDBReply(client *c, int revert_len) {
        }
 #endif
 
+        if (c->ssdb_split)
+            addReplySplitCommand(c, reply);
+
         propagateCmdHandledBySSDB(c);
         server.stat_numcommands++;
         unblockClient(c);
@@ -2508,6 +2517,7 @@ void freeClient(client *c) {
     /* Deallocate structures used to block on blocking ops. */
     if (c->flags & CLIENT_BLOCKED) unblockClient(c);
     dictRelease(c->bpop.keys);
+    if (server.swap_mode) freeSplitCommand(c);
 
     if (server.swap_mode) dictRelease(c->bpop.loading_or_transfer_keys);
 
@@ -2744,7 +2754,10 @@ void resetClient(client *c) {
     c->multibulklen = 0;
     c->bulklen = -1;
 
-    if (server.swap_mode) c->first_key_index = 0;
+    if (server.swap_mode) {
+        c->first_key_index = 0;
+        freeSplitCommand(c);
+    }
 
     /* We clear the ASKING flag as well if we are not inside a MULTI, and
      * if what we just executed is not the ASKING command itself. */
@@ -886,9 +886,9 @@ struct redisMemOverhead *getMemoryOverheadData(void) {
         mh->db = zrealloc(mh->db,sizeof(mh->db[0])*(mh->num_dbs+1));
         mh->db[mh->num_dbs].dbid = j;
 
-        mem = dictSize(db->dict) * sizeof(dictEntry) +
+        mem = dictSize(db->dict) * dictEntrySize(db->dict) +
               dictSlots(db->dict) * sizeof(dictEntry*) +
-              dictSize(db->dict) * sizeof(robj);
+              (db->dict->type->noValue ? 0 : dictSize(db->dict) * sizeof(robj));
         mh->db[mh->num_dbs].overhead_ht_main = mem;
         mem_total+=mem;
 
@@ -1615,6 +1615,11 @@ int rdbLoadRio(rio *rdb, rdbSaveInfo *rsi) {
             decrRefCount(val);
             continue;
         }
+        /* Cold keys are stored without values, see evictedDbDictType. */
+        if (db->dict->type->noValue) {
+            decrRefCount(val);
+            val = shared.integers[0];
+        }
         /* Add the new object in the hash table */
         dbAdd(db,key,val);
 
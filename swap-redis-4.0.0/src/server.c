@@ -143,10 +143,11 @@ struct redisCommand redisCommandTable[] = {
     {"psetex",psetexCommand,4,"wmJ",0,NULL,1,1,1,0,0},
     {"append",appendCommand,3,"wmJ",0,NULL,1,1,1,0,0},
     {"strlen",strlenCommand,2,"rFJ",0,NULL,1,1,1,0,0},
-    /* in swap mode, we only support one key command */
-    {"del",delCommand,2,"wJ",0,NULL,1,1,1,0,0},
+    /* in swap mode, we only support one key command, except for del, exists
+     * and mget which are split between redis and SSDB, see isSplitCommand. */
+    {"del",delCommand,-2,"wJ",0,NULL,1,-1,1,0,0},
     {"unlink",unlinkCommand,2,"wF",0,NULL,1,1,1,0,0},
-    {"exists",existsCommand,2,"rFJ",0,NULL,1,1,1,0,0},
+    {"exists",existsCommand,-2,"rFJ",0,NULL,1,-1,1,0,0},
     {"setbit",setbitCommand,4,"wmJ",0,NULL,1,1,1,0,0},
     {"getbit",getbitCommand,3,"rFJ",0,NULL,1,1,1,0,0},
     {"bitfield",bitfieldCommand,-2,"wm",0,NULL,1,1,1,0,0},
@@ -159,7 +160,7 @@ struct redisCommand redisCommandTable[] = {
     {"incr",incrCommand,2,"wmFJ",0,NULL,1,1,1,0,0},
 #endif
     {"decr",decrCommand,2,"wmFJ",0,NULL,1,1,1,0,0},
-    {"mget",mgetCommand,-2,"rF",0,NULL,1,-1,1,0,0},
+    {"mget",mgetCommand,-2,"rFJ",0,NULL,1,-1,1,0,0},
     {"rpush",rpushCommand,-3,"wmFJ",0,NULL,1,1,1,0,0},
     {"lpush",lpushCommand,-3,"wmFJ",0,NULL,1,1,1,0,0},
     {"rpushx",rpushxCommand,-3,"wmFJ",0,NULL,1,1,1,0,0},
@@ -326,8 +327,8 @@ struct redisCommand redisCommandTable[] = {
     {"latency",latencyCommand,-2,"aslt",0,NULL,0,0,0,0,0},
 
     /* Interfaces called by SSDB. */
-    {"ssdb-resp-del",ssdbRespDelCommand,3,"wj",0,NULL,1,-1,1,0,0},
-    {"ssdb-resp-restore",ssdbRespRestoreCommand,6,"wmj",0,NULL,1,1,1,0,0},
+    {"ssdb-resp-del",ssdbRespDelCommand,-3,"wj",0,NULL,1,-1,2,0,0},
+    {"ssdb-resp-restore",ssdbRespRestoreCommand,-6,"wmj",0,NULL,1,-1,5,0,0},
     {"ssdb-resp-fail",ssdbRespFailCommand,4,"wj",0,NULL,1,1,1,0,0},
     {"ssdb-resp-notfound",ssdbRespNotfoundCommand,4,"wj",0,NULL,1,1,1,0,0},
 
@@ -689,6 +690,19 @@ dictType dbDictType = {
     dictObjectDestructor   /* val destructor */
 };
 
+/* Db->dict of the evicted db, keys are sds strings and the values are never
+ * stored: it only tells which keys live in SSDB, and every lookup gets
+ * shared.integers[0] back. Saves the value pointer in each entry. */
+dictType evictedDbDictType = {
+    dictSdsHash,                /* hash function */
+    NULL,                       /* key dup */
+    NULL,                       /* val dup */
+    dictSdsKeyCompare,          /* key compare */
+    dictSdsDestructor,          /* key destructor */
+    NULL,                       /* val destructor */
+    1                           /* no value */
+};
+
 /* server.lua_scripts sha (as sds string) -> scripts (as robj) cache. */
 dictType shaScriptObjectDictType = {
     dictSdsCaseHash,            /* hash function */
@@ -2006,6 +2020,7 @@ void createSharedObjects(void) {
             makeObjectShared(createObject(OBJ_STRING,(void*)(long)j));
         shared.integers[j]->encoding = OBJ_ENCODING_INT;
     }
+    dictNoValue = shared.integers[0];
     for (j = 0; j < OBJ_SHARED_BULKHDR_LEN; j++) {
         shared.mbulkhdr[j] = createObject(OBJ_STRING,
             sdscatprintf(sdsempty(),"*%d\r\n",j));
@@ -2205,6 +2220,7 @@ void initServerConfig(void) {
     server.slave_transfer_ssdb_snapshot_timeout = SLAVE_SSDB_TRANSFER_SNAPSHOT_TIMEOUT;
     server.master_max_concurrent_loading_keys = MASTER_MAX_CONCURRENT_LOADING_KEYS;
     server.master_max_concurrent_transferring_keys = MASTER_MAX_CONCURRENT_TRANSFERRING_KEYS;
+    server.ssdb_transfer_batch_size = SSDB_TRANSFER_BATCH_SIZE;
     server.slave_max_concurrent_ssdb_swap_count = SLAVE_MAX_CONCURRENT_SSDB_SWAP_COUNT;
     server.slave_max_ssdb_swap_count_everytime = SLAVE_MAX_SSDB_SWAP_COUNT_EVERYTIME;
     server.coldkey_filter_times_everytime = COLDKEY_FILTER_TIMES_EVERYTIME;
@@ -2515,6 +2531,14 @@ void resetServerStats(void) {
     server.stat_keyspace_misses = 0;
     server.stat_keyspace_hits = 0;
     server.stat_keyspace_ssdb_hits = 0;
+    server.stat_split_ssdb_commands = 0;
+    server.stat_transfer_batches = 0;
+    server.stat_transfer_batch_keys = 0;
+    server.stat_transfer_batch_bytes = 0;
+    server.stat_transfer_batch_usec = 0;
+    server.stat_transfer_groups_done = 0;
+    server.stat_transfer_groups_usec = 0;
+    server.stat_transfer_groups_max_usec = 0;
     server.stat_active_defrag_hits = 0;
     server.stat_active_defrag_misses = 0;
     server.stat_active_defrag_key_hits = 0;
@@ -2603,7 +2627,8 @@ void initServer(void) {
 
     /* Create the Redis databases, and initialize other internal state. */
     for (j = 0; j < server.dbnum; j++) {
-        server.db[j].dict = dictCreate(&dbDictType,NULL);
+        server.db[j].dict = dictCreate((server.swap_mode && j == EVICTED_DATA_DBID) ?
+                                       &evictedDbDictType : &dbDictType,NULL);
         server.db[j].expires = dictCreate(&keyptrDictType,NULL);
         server.db[j].blocking_keys = dictCreate(&keylistDictType,NULL);
         server.db[j].ready_keys = dictCreate(&objectKeyPointerValueDictType,NULL);
@@ -2630,6 +2655,9 @@ void initServer(void) {
 
         server.storetossdb_migrate_keys = listCreate();
         listSetFreeMethod(server.storetossdb_migrate_keys, (void (*)(void*))decrRefCount);
+
+        server.ssdb_transfer_groups = listCreate();
+        listSetFreeMethod(server.ssdb_transfer_groups, zfree);
     }
 
     evictionPoolAlloc(); /* Initialize the LRU keys pool. */
@@ -3942,6 +3970,199 @@ int processBeforeVisitingSSDB(client *c, robj *keyobj) {
     return C_ERR;
 }
 
+/* MGET, EXISTS and DEL with several keys are split between redis and SSDB
+ * when some of their keys are in SSDB, see processSplitCommandInSSDB(). */
+int isSplitCommand(client *c) {
+    return server.swap_mode && c->cmd && c->argc > 2
+        && (c->cmd->proc == mgetCommand || c->cmd->proc == existsCommand
+            || c->cmd->proc == delCommand);
+}
+
+static int hasKeysInSSDB(client *c) {
+    int j;
+
+    for (j = 1; j < c->argc; j++)
+        if (dictFind(EVICTED_DATA_DB->dict, c->argv[j]->ptr)) return 1;
+    return 0;
+}
+
+/* Return the first key of the command another client is writing in SSDB. */
+static robj *keyVisitingWriteSSDB(client *c) {
+    int j;
+
+    if (!isSplitCommand(c)) {
+        robj *keyobj = c->argv[c->first_key_index];
+        return isThisKeyVisitingWriteSSDB(keyobj->ptr) ? keyobj : NULL;
+    }
+    for (j = 1; j < c->argc; j++) {
+        if (isThisKeyVisitingWriteSSDB(c->argv[j]->ptr)) {
+            c->first_key_index = j;
+            return c->argv[j];
+        }
+    }
+    return NULL;
+}
+
+void freeSplitCommand(client *c) {
+    ssdbSplitCmd *sc = c->ssdb_split;
+    int j;
+
+    if (!sc) return;
+    if (sc->vals) {
+        for (j = 0; j < sc->numkeys; j++)
+            if (sc->vals[j]) decrRefCount(sc->vals[j]);
+        zfree(sc->vals);
+    }
+    zfree(sc->cold);
+    zfree(sc);
+    c->ssdb_split = NULL;
+}
+
+/* Merge the reply of SSDB for the keys it was sent with the results of the
+ * keys in redis, in the order of the original command. */
+void addReplySplitCommand(client *c, redisReply *reply) {
+    ssdbSplitCmd *sc = c->ssdb_split;
+    size_t cold = 0;
+    int j;
+
+    if (reply->type == REDIS_REPLY_ERROR) {
+        addReplySds(c, sdscatprintf(sdsempty(), "-%s\r\n", reply->str));
+        return;
+    }
+
+    if (!sc->vals) {
+        addReplyLongLong(c, sc->count +
+                         (reply->type == REDIS_REPLY_INTEGER ? reply->integer : 0));
+        return;
+    }
+
+    addReplyMultiBulkLen(c, sc->numkeys);
+    for (j = 0; j < sc->numkeys; j++) {
+        if (!sc->cold[j]) {
+            if (sc->vals[j])
+                addReplyBulk(c, sc->vals[j]);
+            else
+                addReply(c, shared.nullbulk);
+            continue;
+        }
+
+        redisReply *r = (reply->type == REDIS_REPLY_ARRAY && cold < reply->elements) ?
+            reply->element[cold] : NULL;
+        cold++;
+        if (r && r->type == REDIS_REPLY_STRING)
+            addReplyBulkCBuffer(c, r->str, r->len);
+        else
+            addReply(c, shared.nullbulk);
+    }
+}
+
+/* Send the keys of a split command that are in SSDB to SSDB as one command,
+ * serve the rest from redis now, and block the client until SSDB answers.
+ * From then on c->argv only holds the keys sent to SSDB, so visiting keys,
+ * propagation and delete confirmation work as for a command on one key. */
+static int processSplitCommandInSSDB(client *c) {
+    ssdbSplitCmd *sc;
+    robj **argv, **hotargv;
+    int j, argc = 1, hotargc = 1, ret;
+
+    /* Commands in MULTI are queued and run in redis, see sendCommandToSSDB. */
+    if (c->flags & CLIENT_MULTI) return C_ERR;
+
+    sc = zcalloc(sizeof(*sc));
+    sc->numkeys = c->argc-1;
+    sc->cold = zcalloc(sc->numkeys);
+    argv = zmalloc(sizeof(robj*)*c->argc);
+    argv[0] = c->argv[0];
+
+    for (j = 1; j < c->argc; j++) {
+        robj *keyobj = c->argv[j];
+
+        /* Calling lookupKey to update lru or lfu counter. */
+        if (lookupKey(EVICTED_DATA_DB, keyobj, LOOKUP_NONE)
+            && expireIfNeeded(EVICTED_DATA_DB, keyobj) == 0) {
+            sc->cold[j-1] = 1;
+            argv[argc++] = keyobj;
+        }
+    }
+
+    /* All the keys in SSDB have just expired. */
+    if (argc == 1) {
+        zfree(argv);
+        zfree(sc->cold);
+        zfree(sc);
+        return C_ERR;
+    }
+
+    ret = sendCommandToSSDB(c, composeCmdFromArgs(argc, argv));
+    if (ret != C_OK) {
+        zfree(argv);
+        zfree(sc->cold);
+        zfree(sc);
+        return ret;
+    }
+
+    /* Serve the keys in redis the way the command itself does. */
+    if (c->cmd->proc == mgetCommand)
+        sc->vals = zcalloc(sizeof(robj*)*sc->numkeys);
+    hotargv = zmalloc(sizeof(robj*)*c->argc);
+    hotargv[0] = c->argv[0];
+    for (j = 1; j < c->argc; j++) {
+        robj *keyobj = c->argv[j], *o;
+
+        if (sc->cold[j-1]) continue;
+        if (c->cmd->proc == mgetCommand) {
+            o = lookupKeyRead(c->db, keyobj);
+            if (o && o->type == OBJ_STRING) {
+                incrRefCount(o);
+                sc->vals[j-1] = o;
+            }
+        } else if (c->cmd->proc == existsCommand) {
+            expireIfNeeded(c->db, keyobj);
+            if (dbExists(c->db, keyobj)) sc->count++;
+        } else {
+            expireIfNeeded(c->db, keyobj);
+            if (dbSyncDelete(c->db, keyobj)) {
+                signalModifiedKey(c->db, keyobj);
+                notifyKeyspaceEvent(NOTIFY_GENERIC, "del", keyobj, c->db->id);
+                server.dirty++;
+                sc->count++;
+                hotargv[hotargc++] = keyobj;
+            }
+        }
+    }
+    if (hotargc > 1)
+        propagate(c->cmd, c->db->id, hotargv, hotargc, PROPAGATE_AOF|PROPAGATE_REPL);
+    zfree(hotargv);
+
+    for (j = 0; j < argc; j++) incrRefCount(argv[j]);
+    replaceClientCommandVector(c, argc, argv);
+    c->ssdb_split = sc;
+
+    if (listLength(server.monitors) &&
+        !server.loading &&
+        !(c->cmd->flags & (CMD_SKIP_MONITOR|CMD_ADMIN)))
+    {
+        replicationFeedMonitors(c,server.monitors,EVICTED_DATA_DBID,c->argv,c->argc);
+    }
+
+    server.stat_keyspace_ssdb_hits ++;
+    server.stat_split_ssdb_commands ++;
+
+    /* Record the keys visting SSDB. */
+    if (server.masterhost == NULL)
+        recordVisitingSSDBkeys(c->cmd, c->argv, c->argc);
+
+    c->bpop.timeout = server.client_visiting_ssdb_timeout + mstime();
+    blockClient(c, BLOCKED_VISITING_SSDB);
+
+    /* Slaves do not load data from ssdb automatically. */
+    if (server.masterhost || c->cmd->proc == delCommand) return C_OK;
+
+    for (j = 1; j < c->argc; j++)
+        chooseHotKeysByLFUcounter(c->argv[j]);
+    return C_OK;
+}
+
 /* Process keys may be in SSDB, only handle the command swap_mode supported.
  The rest cases will be handled by processCommand. */
 int processCommandMaybeInSSDB(client *c) {
@@ -3964,8 +4185,11 @@ int processCommandMaybeInSSDB(client *c) {
     else
         keyobj = NULL;
 
-    if (!keyobj || !dictFind(EVICTED_DATA_DB->dict, keyobj->ptr))
+    if (isSplitCommand(c)) {
+        if (!hasKeysInSSDB(c)) return C_ERR;
+    } else if (!keyobj || !dictFind(EVICTED_DATA_DB->dict, keyobj->ptr)) {
         return C_ERR;
+    }
 
     /* prohibit write operations to SSDB when replication,
      *
@@ -3990,6 +4214,9 @@ int processCommandMaybeInSSDB(client *c) {
         return C_OK;
     }
 
+    if (isSplitCommand(c))
+        return processSplitCommandInSSDB(c);
+
     if ((c->cmd->flags & (CMD_READONLY | CMD_WRITE)) &&
          (c->cmd->flags & CMD_SWAP_MODE)) {
         int lookup_flags = LOOKUP_NONE;
@@ -4308,6 +4535,8 @@ int runCommand(client *c) {
     if (server.swap_mode) {
         ret = processCommandMaybeInSSDB(c);
         if (ret == C_OK) {
+            /* A split command only keeps the keys sent to SSDB. */
+            if (c->ssdb_split) firstkey = c->argv[1];
             /* Otherwise, return C_ERR to avoid calling resetClient,
                the resetClient is delayed to ssdbClientUnixHandler. */
             serverLog(LL_DEBUG, "processing %s, fd: %d in ssdb: %s",
@@ -4384,8 +4613,7 @@ int tryBlockingClient(client *c) {
     if (server.masterhost == NULL
         && (c->cmd->flags & CMD_WRITE)
         && c->first_key_index
-        && (keyobj = c->argv[c->first_key_index])
-        && isThisKeyVisitingWriteSSDB(keyobj->ptr)) {
+        && (keyobj = keyVisitingWriteSSDB(c))) {
         addClientToListForBlockedKey(c, c->cmd, server.db[0].blocking_keys_write_same_ssdbkey, keyobj);
         c->bpop.timeout = server.client_visiting_ssdb_timeout + mstime();
         serverLog(LL_DEBUG, "client fd:%d, cmd: %s, key: %s is blocked by another write on the same key",
@@ -4483,8 +4711,13 @@ int processCommand(client *c) {
          * is trying to execute is denied during OOM conditions? Error. */
         if ((c->cmd->flags & CMD_DENYOOM) && retval == C_ERR) {
             if (server.swap_mode && c->cmd->proc == ssdbRespRestoreCommand) {
-                if (dictDelete(EVICTED_DATA_DB->loading_hot_keys, c->argv[1]->ptr) == DICT_OK)
-                    signalBlockingKeyAsReady(c->db, c->argv[1]);
+                int j;
+
+                /* ssdb-resp-restore may carry a batch of keys. */
+                for (j = 1; j < c->argc; j += 5) {
+                    if (dictDelete(EVICTED_DATA_DB->loading_hot_keys, c->argv[j]->ptr) == DICT_OK)
+                        signalBlockingKeyAsReady(c->db, c->argv[j]);
+                }
             }
             flagTransaction(c);
             addReply(c, shared.oomerr);
@@ -4990,6 +5223,26 @@ void listLoadingKeysCommand(client* c) {
     addReplyBulkSds(c, info);
 }
 
+/* Estimate the memory used to remember the keys living in SSDB: the dict
+ * entries, the bucket array and the key names, whose average size is taken
+ * from a few random keys. */
+#define EVICTED_KEYS_MEMORY_SAMPLES 64
+size_t evictedKeysMemoryUsage(void) {
+    dict *d = EVICTED_DATA_DB->dict;
+    dictEntry *samples[EVICTED_KEYS_MEMORY_SAMPLES];
+    unsigned long count, j;
+    size_t keysize = 0;
+
+    if (dictSize(d) == 0) return 0;
+    count = dictGetSomeKeys(d,samples,EVICTED_KEYS_MEMORY_SAMPLES);
+    for (j = 0; j < count; j++)
+        keysize += sdsZmallocSize(dictGetKey(samples[j]));
+    if (count) keysize = keysize / count * dictSize(d);
+
+    return dictSize(d) * dictEntrySize(d) +
+           dictSlots(d) * sizeof(dictEntry*) + keysize;
+}
+
 /* Create the string returned by the INFO command. This is decoupled
  * by the INFO command itself as we need to report the same information
  * on memory corruption problems. */
@@ -5282,6 +5535,7 @@ sds genRedisInfoString(char *section) {
             "evicted_keys:%lld\r\n"
             "keyspace_hits:%lld\r\n"
             "keyspace_hits_ssdb:%lld\r\n"
+            "split_commands_ssdb:%lld\r\n"
             "keyspace_misses:%lld\r\n"
             "pubsub_channels:%ld\r\n"
             "pubsub_patterns:%lu\r\n"
@@ -5308,6 +5562,7 @@ sds genRedisInfoString(char *section) {
             server.stat_evictedkeys,
             server.stat_keyspace_hits,
             server.stat_keyspace_ssdb_hits,
+            server.stat_split_ssdb_commands,
             server.stat_keyspace_misses,
             dictSize(server.pubsub_channels),
             listLength(server.pubsub_patterns),
@@ -5516,10 +5771,14 @@ sds genRedisInfoString(char *section) {
     }
 
     if (server.swap_mode && (allsections || defsections || !strcasecmp(section,"redis-ssdb"))) {
+        size_t evicted_mem = evictedKeysMemoryUsage();
+
         if (sections++) info = sdscat(info,"\r\n");
         info = sdscatprintf(info, "# Redis-SSDB\r\n"
                                     "keys_in_redis_count:%lu\r\n"
                                     "keys_in_ssdb_count:%lu\r\n"
+                                    "keys_in_ssdb_memory:%zu\r\n"
+                                    "keys_in_ssdb_bytes_per_key:%.2f\r\n"
                                     "keys_loading_from_ssdb:%lu\r\n"
                                     "keys_transferring_to_ssdb:%lu\r\n"
                                     "keys_visiting_ssdb:%lu\r\n"
@@ -5528,6 +5787,9 @@ sds genRedisInfoString(char *section) {
                                     "keys_may_be_deleted:%lu\r\n",
                             dictSize(server.db[0].dict),
                             dictSize(EVICTED_DATA_DB->dict),
+                            evicted_mem,
+                            dictSize(EVICTED_DATA_DB->dict) ?
+                                (double)evicted_mem/dictSize(EVICTED_DATA_DB->dict) : 0,
                             dictSize(EVICTED_DATA_DB->loading_hot_keys),
                             dictSize(EVICTED_DATA_DB->transferring_keys),
                             dictSize(EVICTED_DATA_DB->visiting_ssdb_keys),
@@ -5536,6 +5798,28 @@ sds genRedisInfoString(char *section) {
                             dictSize(server.maybe_deleted_ssdb_keys)
         );
 
+        long long batches = server.stat_transfer_batches;
+        long long groups = server.stat_transfer_groups_done;
+        info = sdscatprintf(info, "transfer_batches:%lld\r\n"
+                                    "transfer_batch_keys:%lld\r\n"
+                                    "transfer_batch_bytes:%lld\r\n"
+                                    "transfer_batch_avg_keys:%.2f\r\n"
+                                    "transfer_batch_avg_usec:%.2f\r\n"
+                                    "transfer_groups_in_flight:%lu\r\n"
+                                    "transfer_groups_done:%lld\r\n"
+                                    "transfer_group_avg_usec:%.2f\r\n"
+                                    "transfer_group_max_usec:%lld\r\n",
+                            batches,
+                            server.stat_transfer_batch_keys,
+                            server.stat_transfer_batch_bytes,
+                            batches ? (double)server.stat_transfer_batch_keys/batches : 0,
+                            batches ? (double)server.stat_transfer_batch_usec/batches : 0,
+                            listLength(server.ssdb_transfer_groups),
+                            groups,
+                            groups ? (double)server.stat_transfer_groups_usec/groups : 0,
+                            server.stat_transfer_groups_max_usec
+        );
+
         if (server.masterhost) {
             info = sdscatprintf(info, "\r\nslave_unprocessed_transferring_or_loading_keys:%lu\r\n"
                                         "slave_write_op_list_num:%lu\r\n"
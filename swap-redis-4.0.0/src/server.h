@@ -804,6 +804,27 @@ typedef struct readyList {
     robj *key;
 } readyList;
 
+/* In swap-mode, state of a multi-key command (MGET/EXISTS/DEL) whose keys are
+ * partly in redis and partly in SSDB: the keys in redis are served at once,
+ * the rest go to SSDB as one command, and both are merged into one reply in
+ * argument order when SSDB answers. */
+typedef struct ssdbSplitCmd {
+    int numkeys;        /* Keys of the original command. */
+    char *cold;         /* cold[j] is 1 if key j was sent to SSDB. */
+    robj **vals;        /* MGET: values of the keys in redis, NULL if missing. */
+    long long count;    /* EXISTS/DEL: result over the keys in redis. */
+} ssdbSplitCmd;
+
+/* Cold keys evicted to SSDB with one write. Their transfer ids are the
+ * consecutive range [first_id, last_id], the group is done once SSDB
+ * answered ssdb-resp-del for all of them. */
+typedef struct ssdbTransferGroup {
+    unsigned long long first_id;
+    unsigned long long last_id;
+    int pending;            /* Keys not answered yet. */
+    long long start;        /* ustime() the batch was sent. */
+} ssdbTransferGroup;
+
 /* With multiplexing we need to take per-client state.
  * Clients are taken in a linked list. */
 typedef struct client {
@@ -875,6 +896,7 @@ typedef struct client {
                      * to revert it from client buffer. */
     int first_key_index;
     long long visit_ssdb_start;
+    ssdbSplitCmd *ssdb_split; /* Multi-key command split between redis and SSDB. */
 } client;
 
 #define TYPE_TRANSFER_TO_SSDB 999
@@ -1459,6 +1481,15 @@ struct redisServer {
     time_t ssdb_down_time;
     int slave_ssdb_critical_err_cnt;
     long long stat_keyspace_ssdb_hits;   /* Number of successful lookups of keys in SSDB. */
+    long long stat_split_ssdb_commands;  /* Multi-key commands split between redis and SSDB. */
+    list *ssdb_transfer_groups;          /* ssdbTransferGroup of batches still in flight. */
+    long long stat_transfer_batches;     /* Restore batches sent to SSDB. */
+    long long stat_transfer_batch_keys;  /* Keys sent in those batches. */
+    long long stat_transfer_batch_bytes; /* Bytes sent in those batches. */
+    long long stat_transfer_batch_usec;  /* Time spent dumping and sending batches. */
+    long long stat_transfer_groups_done; /* Batches whose keys were all answered by SSDB. */
+    long long stat_transfer_groups_usec; /* Sum of their round trip times. */
+    long long stat_transfer_groups_max_usec; /* Slowest of them. */
 
     int client_visiting_ssdb_timeout;
     int client_blocked_by_keys_timeout;
@@ -1472,6 +1503,7 @@ struct redisServer {
     int slave_transfer_ssdb_snapshot_timeout;
     int master_max_concurrent_loading_keys;
     int master_max_concurrent_transferring_keys;
+    int ssdb_transfer_batch_size;   /* Max cold keys restored to SSDB in one write. */
     int slave_max_concurrent_ssdb_swap_count;
     int slave_max_ssdb_swap_count_everytime;
 
@@ -1585,6 +1617,7 @@ extern dictType zsetDictType;
 extern dictType clusterNodesDictType;
 extern dictType clusterNodesBlackListDictType;
 extern dictType dbDictType;
+extern dictType evictedDbDictType;
 extern dictType shaScriptObjectDictType;
 extern double R_Zero, R_PosInf, R_NegInf, R_Nan;
 extern dictType hashDictType;
@@ -1945,6 +1978,9 @@ int checkKeysInMediateState(client* c);
 int checkKeysForMigrate(client *c);
 int processCommandReplicationConn(client* c, struct ssdb_write_op* slave_retry_write);
 int processCommandMaybeInSSDB(client *c);
+int isSplitCommand(client *c);
+void addReplySplitCommand(client *c, redisReply *reply);
+void freeSplitCommand(client *c);
 int isMigratingSSDBKey(sds keysds);
 int addMigratingSSDBKey(sds keysds);
 int delMigratingSSDBKey(sds keysds);
@@ -2149,6 +2185,7 @@ void disconnectAllBlockedClients(void);
 void activeExpireCycle(int type);
 /* expire.c -- Handling of evicting keys to SSDB. */
 int epilogOfEvictingToSSDB(robj *keyobj);
+void transferGroupKeyDone(unsigned long long transfer_id);
 void expireSlaveKeys(void);
 void rememberSlaveKeyWithExpire(redisDb *db, robj *key);
 void flushSlaveKeysWithExpireList(void);
@@ -2445,6 +2482,7 @@ int isThisKeyVisitingWriteSSDB(sds key);
 /* config options for swap mode */
 #define MASTER_MAX_CONCURRENT_LOADING_KEYS 5
 #define MASTER_MAX_CONCURRENT_TRANSFERRING_KEYS 5
+#define SSDB_TRANSFER_BATCH_SIZE 5
 
 #define SLAVE_MAX_CONCURRENT_SSDB_SWAP_COUNT 10
 #define SLAVE_MAX_SSDB_SWAP_COUNT_EVERYTIME 2
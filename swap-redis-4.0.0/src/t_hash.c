@@ -241,10 +241,10 @@ int hashTypeSet(robj *o, sds field, sds value, int flags) {
         if (de) {
             sdsfree(dictGetVal(de));
             if (flags & HASH_SET_TAKE_VALUE) {
-                dictGetVal(de) = value;
+                dictSetVal((dict*)o->ptr,de,value);
                 value = NULL;
             } else {
-                dictGetVal(de) = sdsdup(value);
+                dictSetVal((dict*)o->ptr,de,sdsdup(value));
             }
             update = 1;
         } else {
@@ -1355,7 +1355,7 @@ int zsetAdd(robj *zobj, double score, sds ele, int *flags, double *newscore) {
                 /* Note that we did not removed the original element from
                  * the hash table representing the sorted set, so we just
                  * update the score. */
-                dictGetVal(de) = &znode->score; /* Update score ptr. */
+                dictSetVal(zs->dict,de,&znode->score); /* Update score ptr. */
                 *flags |= ZADD_UPDATED;
             }
             return 1;
@@ -16,6 +16,10 @@ int notifyNotFoundToRedis(RedisUpstream *redisUpstream, const std::string &respo
 int notifyToRedis(RedisUpstream *redisUpstream, const std::string &response_type, const std::string &response_cmd,
                   const std::string &data_key, const std::string &trans_id);
 
+// keys and payload bytes carried by one batched ssdb-resp-* command
+static const size_t BATCH_CMD_MAX_KEYS = 16;
+static const size_t BATCH_CMD_MAX_BYTES = 1024 * 1024;
+
 int bproc_COMMAND_DATA_SAVE(Context &ctx, TransferWorker *worker, const std::string &data_key,
                             const std::string &trans_id, void *value) {
 
@@ -109,6 +113,183 @@ int bproc_COMMAND_DATA_DUMP(Context &ctx, TransferWorker *worker, const std::str
     return 0;
 }
 
+/*
+ * batched form: ssdb-resp-del key1 id1 [key2 id2 ...], every command carries
+ * up to BATCH_CMD_MAX_KEYS keys and all commands are pipelined in one flush.
+ */
+int bproc_batch_COMMAND_DATA_SAVE(TransferWorker *worker, const std::vector<TransferJob *> &jobs) {
+
+    SSDBServer *serv = (SSDBServer *) jobs[0]->ctx.net->data;
+
+    std::set<std::string> keys;
+    for (auto job : jobs) {
+        keys.insert(job->data_key);
+    }
+    RecordLocks<Mutex> tl(&serv->transfer_mutex_record_, keys);
+    tl.Lock();
+
+    const std::string cmd = "ssdb-resp-dump";
+
+    std::vector<std::vector<std::string>> reqs;
+    std::vector<std::string> req;
+
+    for (auto job : jobs) {
+        DumpData *dumpData = job->dumpData;
+
+        std::string val;
+
+        PTST(restore, 0.03)
+        int ret = serv->ssdb->restore(job->ctx, dumpData->key, dumpData->expire, dumpData->data, dumpData->replace, &val);
+        PTE(restore, hexstr(job->data_key))
+
+        if (ret < 0) {
+            //notify failed
+            notifyFailedToRedis(worker->redisUpstream, cmd, job->data_key, job->trans_id);
+            continue;
+        }
+
+        if (req.empty()) {
+            req.emplace_back("ssdb-resp-del");
+        }
+        req.push_back(job->data_key);
+        req.push_back(job->trans_id);
+
+        if ((req.size() - 1) / 2 >= BATCH_CMD_MAX_KEYS) {
+            reqs.push_back(std::move(req));
+            req.clear();
+        }
+    }
+
+    if (!req.empty()) {
+        reqs.push_back(std::move(req));
+    }
+
+    if (reqs.empty()) {
+        return 0;
+    }
+
+    std::vector<RedisResponse *> res;
+    if (worker->redisUpstream->sendCommands(reqs, &res) != 0) {
+        log_error("[ssdb-resp-del x %d] redis response is null", reqs.size());
+        //redis res failed
+        return -1;
+    }
+
+    for (size_t i = 0; i < res.size(); ++i) {
+        log_debug("[response<-redis] : %s %s ... %s", hexcstr(reqs[i][0]), hexcstr(reqs[i][1]),
+                  res[i]->toString().c_str());
+        delete res[i];
+    }
+
+    return 0;
+}
+
+/*
+ * batched form: ssdb-resp-restore key1 pttl1 val1 replace id1 [key2 ...],
+ * redis replies an array with one reply per key.
+ */
+int bproc_batch_COMMAND_DATA_DUMP(TransferWorker *worker, const std::vector<TransferJob *> &jobs) {
+
+    SSDBServer *serv = (SSDBServer *) jobs[0]->ctx.net->data;
+
+    std::set<std::string> keys;
+    for (auto job : jobs) {
+        keys.insert(job->data_key);
+    }
+    RecordLocks<Mutex> tl(&serv->transfer_mutex_record_, keys);
+    tl.Lock();
+
+    const std::string cmd = "ssdb-resp-restore";
+
+    std::vector<std::vector<std::string>> reqs;
+    std::vector<std::vector<TransferJob *>> carried;
+
+    std::vector<std::string> req;
+    std::vector<TransferJob *> req_jobs;
+    size_t req_bytes = 0;
+
+    for (auto job : jobs) {
+        std::string val;
+
+        int64_t pttl = 0;
+
+        PTST(dump, 0.03)
+        int ret = serv->ssdb->dump(job->ctx, job->data_key, &val, &pttl, serv->opt.rdb_compression);
+        PTE(dump, hexstr(job->data_key))
+
+        if (ret < 0) {
+            //notify failed
+            notifyFailedToRedis(worker->redisUpstream, cmd, job->data_key, job->trans_id);
+            continue;
+        } else if (ret == 0) {
+            //notify key not found
+            notifyNotFoundToRedis(worker->redisUpstream, cmd, job->data_key, job->trans_id);
+            continue;
+        }
+
+        if (req.empty()) {
+            req.push_back(cmd);
+        }
+        req_bytes += val.size();
+        req.push_back(job->data_key);
+        req.push_back(str(pttl));
+        req.push_back(std::move(val));
+        req.emplace_back("replace");
+        req.push_back(job->trans_id);
+        req_jobs.push_back(job);
+
+        if (req_jobs.size() >= BATCH_CMD_MAX_KEYS || req_bytes >= BATCH_CMD_MAX_BYTES) {
+            reqs.push_back(std::move(req));
+            carried.push_back(std::move(req_jobs));
+            req.clear();
+            req_jobs.clear();
+            req_bytes = 0;
+        }
+    }
+
+    if (!req.empty()) {
+        reqs.push_back(std::move(req));
+        carried.push_back(std::move(req_jobs));
+    }
+
+    if (reqs.empty()) {
+        return 0;
+    }
+
+    std::vector<RedisResponse *> res;
+    if (worker->redisUpstream->sendCommands(reqs, &res) != 0) {
+        log_error("[%s x %d] redis response is null", cmd.c_str(), reqs.size());
+        //redis res failed
+        return -1;
+    }
+
+    for (size_t i = 0; i < res.size(); ++i) {
+        std::unique_ptr<RedisResponse> t_res(res[i]);
+        const std::vector<TransferJob *> &req_carried = carried[i];
+
+        for (size_t j = 0; j < req_carried.size(); ++j) {
+            // a command carrying one key is the plain form, and gets a plain reply
+            RedisResponse *key_res = nullptr;
+            if (req_carried.size() == 1) {
+                key_res = t_res.get();
+            } else if (t_res->type == REDIS_REPLY_ARRAY && j < t_res->size()) {
+                key_res = t_res->at(j);
+            }
+
+            const std::string &data_key = req_carried[j]->data_key;
+            if (key_res != nullptr && key_res->isOk()) {
+                log_debug("mark deleting %s", hexcstr(data_key));
+                serv->ssdb->del(req_carried[j]->ctx, data_key);
+            } else {
+                log_debug("[response<-redis] : %s %s %s", hexcstr(cmd), hexcstr(data_key),
+                          key_res == nullptr ? "null" : key_res->toString().c_str());
+            }
+        }
+    }
+
+    return 0;
+}
+
 
 int notifyFailedToRedis(RedisUpstream *redisUpstream, const std::string &response_cmd, const std::string &data_key,
                         const std::string &trans_id) {
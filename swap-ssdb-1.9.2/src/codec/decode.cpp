@@ -6,6 +6,18 @@ found in the LICENSE file.
 #include <util/error.h>
 #include "decode.h"
 #include "util/bytes.h"
+#include "encode.h"
+
+static inline int decode_slot_internal(Decoder &decoder, uint16_t *slot){
+    if (get_key_format() != KEY_FORMAT_SLOT) {
+        return 0;
+    }
+    if (decoder.read_uint16(slot) == -1) {
+        return -1;
+    }
+    *slot = be16toh(*slot);
+    return 0;
+}
 
 
 int MetaKey::DecodeMetaKey(const Bytes &str) {
@@ -16,11 +28,9 @@ int MetaKey::DecodeMetaKey(const Bytes &str) {
     if (str[POS_TYPE] != DataType::META){
         return -1;
     }
-//    if (decoder.read_uint16(&slot) == -1){
-//        return -1;
-//    } else{
-//        slot = be16toh(slot);
-//    }
+    if (decode_slot_internal(decoder, &slot) == -1){
+        return -1;
+    }
     decoder.read_data(key);
     return 0;
 }
@@ -33,6 +43,9 @@ int ItemKey::DecodeItemKey(const Bytes &str) {
     if (str[POS_TYPE] != DataType::ITEM){
         return -1;
     }
+    if (decode_slot_internal(decoder, &slot) == -1){
+        return -1;
+    }
     if (decoder.read_16_data(&key) == -1){
         return -1;
     }
@@ -53,6 +66,9 @@ int ZScoreItemKey::DecodeItemKey(const Bytes &str) {
     if (str[POS_TYPE] != DataType::ZSCORE){
         return -1;
     }
+    if (decode_slot_internal(decoder, &slot) == -1){
+        return -1;
+    }
     if (decoder.read_16_data(&key) == -1){
         return -1;
     }
@@ -82,6 +98,9 @@ int ListItemKey::DecodeItemKey(const Bytes &str) {
     if (str[POS_TYPE] != DataType::ITEM){
         return -1;
     }
+    if (decode_slot_internal(decoder, &slot) == -1){
+        return -1;
+    }
     if (decoder.read_16_data(&key) == -1){
         return -1;
     }
@@ -290,3 +309,100 @@ int RepoKey::DecodeRepoKey(const Bytes &str) {
 
     return 0;
 }
+
+static bool add_delta(int64_t value, int64_t delta, int64_t *out) {
+    if ((delta > 0 && value > INT64_MAX - delta) || (delta < 0 && value < INT64_MIN - delta)) {
+        return false;
+    }
+    *out = value + delta;
+    return true;
+}
+
+int decode_meta_delta(const Bytes &str, char *type, int64_t *delta) {
+    Decoder decoder(str.data(), str.size());
+    if(decoder.skip(1) == -1){
+        return -1;
+    }
+    *type = str.data()[0];
+
+    uint64_t u64 = 0;
+    if (decoder.read_uint64(&u64) == -1 || decoder.size() != 0){
+        return -1;
+    }
+    *delta = (int64_t) be64toh(u64);
+    return 0;
+}
+
+int apply_meta_delta(string *meta_val, bool exists, const Bytes &operand) {
+    char type;
+    int64_t delta;
+    if (decode_meta_delta(operand, &type, &delta) == -1){
+        return -1;
+    }
+
+    if (type == DataType::KV){
+        // same rules as GetKvMetaVal: a missing key starts at 0, a deleted one at the next version
+        uint16_t version = 0;
+        long long value = 0;
+        if (exists){
+            KvMetaVal kv;
+            if (kv.DecodeMetaVal(*meta_val) != 0){
+                return -1;
+            }
+            if (kv.del == KEY_DELETE_MASK){
+                version = (uint16_t) (kv.version == UINT16_MAX ? 0 : kv.version + 1);
+            } else {
+                version = kv.version;
+                if (string2ll(kv.value.data(), kv.value.size(), &value) == 0){
+                    return -1;
+                }
+            }
+        }
+
+        int64_t result;
+        if (!add_delta(value, delta, &result)){
+            return -1;
+        }
+        *meta_val = encode_kv_val(str(result), version);
+        return 0;
+    }
+
+    if (type != DataType::HSIZE && type != DataType::SSIZE && type != DataType::ZSIZE){
+        return -1;
+    }
+    if (!exists){
+        return -1;
+    }
+    MetaVal mv;
+    if (mv.DecodeMetaVal(*meta_val) != 0 || mv.type != type || mv.del != KEY_ENABLED_MASK){
+        return -1;
+    }
+
+    // an emptied collection is written as a delete marker, never as a delta
+    int64_t length;
+    if (mv.length > INT64_MAX || !add_delta((int64_t) mv.length, delta, &length) || length <= 0){
+        return -1;
+    }
+
+    if (type == DataType::HSIZE){
+        *meta_val = encode_hash_meta_val((uint64_t) length, mv.version);
+    } else if (type == DataType::SSIZE){
+        *meta_val = encode_set_meta_val((uint64_t) length, mv.version);
+    } else {
+        *meta_val = encode_zset_meta_val((uint64_t) length, mv.version);
+    }
+    return 0;
+}
+
+int combine_meta_delta(const Bytes &left, const Bytes &right, string *out) {
+    char ltype, rtype;
+    int64_t ldelta, rdelta, delta;
+    if (decode_meta_delta(left, &ltype, &ldelta) == -1 || decode_meta_delta(right, &rtype, &rdelta) == -1){
+        return -1;
+    }
+    if (ltype != rtype || !add_delta(ldelta, rdelta, &delta)){
+        return -1;
+    }
+    *out = encode_meta_delta(ltype, delta);
+    return 0;
+}
@@ -13,7 +13,7 @@ class MetaKey{
 public:
     int DecodeMetaKey(const Bytes& str);
 public:
-//    uint16_t slot;
+    uint16_t slot = 0;
     Bytes   key;
 };
 
@@ -22,6 +22,7 @@ public:
      virtual int DecodeItemKey(const Bytes& str);
 
 public:
+    uint16_t    slot = 0;
     uint16_t    version;
     string      key;
     Bytes       field;
@@ -120,4 +121,21 @@ public:
     uint64_t    timestamp;
 };
 
+
+/*
+ * meta delta, see encode_meta_delta
+ */
+int decode_meta_delta(const Bytes& str, char *type, int64_t *delta);
+
+/*
+ * applies one delta to meta_val, exists tells if meta_val holds a value.
+ * @return 0, or -1 if the delta does not apply and meta_val is left unchanged
+ */
+int apply_meta_delta(string *meta_val, bool exists, const Bytes& operand);
+
+/*
+ * folds two deltas of the same type into one, -1 if they can not be folded
+ */
+int combine_meta_delta(const Bytes& left, const Bytes& right, string *out);
+
 #endif //SSDB_DECODE_H
@@ -9,12 +9,38 @@ found in the LICENSE file.
 static string encode_key_internal(char type, const Bytes& key, const Bytes& field, uint16_t version);
 static string encode_meta_val_internal(const char type, uint64_t length, uint16_t version, char del);
 
+static int key_format = KEY_FORMAT_PLAIN;
+
+void set_key_format(int format){
+    key_format = format;
+}
+
+int get_key_format(){
+    return key_format;
+}
+
+static inline void encode_slot_internal(string &buf, const Bytes& key){
+    if (key_format != KEY_FORMAT_SLOT) {
+        return;
+    }
+    uint16_t slot = (uint16_t)keyHashSlot(key.data(), key.size());
+    slot = htobe16(slot);
+    buf.append((char *)&slot, sizeof(uint16_t));
+}
+
+string encode_slot_prefix(char type, uint16_t slot){
+    string buf(1, type);
+
+    slot = htobe16(slot);
+    buf.append((char *)&slot, sizeof(uint16_t));
+
+    return buf;
+}
+
 string encode_meta_key(const Bytes& key){
     string buf(1, DataType::META);
 
-//    uint16_t slot = (uint16_t)keyHashSlot(key.data(), key.size());
-//    slot = htobe16(slot);
-//    buf.append((char *)&slot, sizeof(uint16_t));
+    encode_slot_internal(buf, key);
 
     buf.append(key.data(), key.size());
 
@@ -24,6 +50,8 @@ string encode_meta_key(const Bytes& key){
 static string encode_key_internal(char type, const Bytes& key, const Bytes& field, uint16_t version){
     string buf(1, type);
 
+    encode_slot_internal(buf, key);
+
     uint16_t len = htobe16((uint16_t)key.size());
     buf.append((char *)&len, sizeof(uint16_t));
     buf.append(key.data(), key.size());
@@ -52,6 +80,23 @@ string encode_zscore_prefix(const Bytes &key, uint16_t version){
     return encode_key_internal(DataType::ZSCORE, key, Bytes(""), version);
 }
 
+string encode_zrank_prefix(const Bytes &key, uint16_t version){
+    return encode_key_internal(DataType::ZRANK, key, Bytes(""), version);
+}
+
+/*
+ * rank index node: 'r' + len + key + version + level + score_prefix,
+ * score_prefix is the first `level` bytes of the big-endian encoded score.
+ */
+string encode_zrank_key(const Bytes& key, uint16_t version, uint8_t level, const Bytes& score_prefix){
+    string buf = encode_key_internal(DataType::ZRANK, key, Bytes(""), version);
+
+    buf.append(1, (char)level);
+    buf.append(score_prefix.data(), score_prefix.size());
+
+    return buf;
+}
+
 string encode_eset_key(const Bytes& member){
     string buf(1, DataType::EKEY);
 
@@ -63,6 +108,8 @@ string encode_eset_key(const Bytes& member){
 string encode_zscore_key(const Bytes& key, const Bytes& field, double score, uint16_t version){
     string buf(1, DataType::ZSCORE);
 
+    encode_slot_internal(buf, key);
+
     uint16_t len = htobe16((uint16_t)key.size());
     buf.append((char *)&len, sizeof(uint16_t));
     buf.append(key.data(), key.size());
@@ -98,6 +145,8 @@ void update_list_key(std::string& old, uint64_t seq){
 string encode_list_key(const Bytes& key, uint64_t seq, uint16_t version){
     string buf(1, DataType::ITEM);
 
+    encode_slot_internal(buf, key);
+
     uint16_t len = htobe16((uint16_t)key.size());
     buf.append((char *)&len, sizeof(uint16_t));
     buf.append(key.data(), key.size());
@@ -169,6 +218,15 @@ string encode_list_meta_val(uint64_t length, uint64_t left, uint64_t right, uint
     return buf;
 }
 
+string encode_meta_delta(char type, int64_t delta){
+    string buf(1, type);
+
+    uint64_t u64 = htobe64((uint64_t) delta);
+    buf.append((char *)&u64, sizeof(uint64_t));
+
+    return buf;
+}
+
 /*
  * delete key
  */
@@ -196,6 +254,12 @@ string encode_repo_key() {
     return buf;
 }
 
+string encode_key_format_key() {
+    string buf(1, DataType::KEYFORMAT);
+
+    return buf;
+}
+
 string encode_repo_item(uint64_t timestamp, uint64_t index) {
     string buf(1, DataType::REPOITEM);
 
@@ -207,3 +271,82 @@ string encode_repo_item(uint64_t timestamp, uint64_t index) {
 
     return buf;
 }
+
+
+/*
+ * re-encode a raw data key from one key format to another, used to migrate
+ * a data dir. returns 1 if the key was rewritten, 0 if the key type carries
+ * no slot and is kept as is, -1 on malformed key.
+ */
+int convert_key_format(const Bytes& raw, int from, int to, string *out){
+    out->assign(raw.data(), (size_t) raw.size());
+    if (raw.size() < 1) {
+        return -1;
+    }
+
+    char type = raw.data()[0];
+    if (type != DataType::META && type != DataType::ITEM && type != DataType::ZSCORE && type != DataType::ZRANK) {
+        return 0;
+    }
+    if (from == to) {
+        return 1;
+    }
+
+    size_t pos = 1;
+    if (from == KEY_FORMAT_SLOT) {
+        pos += sizeof(uint16_t);
+    }
+    if (raw.size() < pos) {
+        return -1;
+    }
+
+    Bytes key;
+    if (type == DataType::META) {
+        key = Bytes(raw.data() + pos, raw.size() - pos);
+    } else {
+        if (raw.size() < pos + sizeof(uint16_t)) {
+            return -1;
+        }
+        uint16_t len = be16toh(*(uint16_t *)(raw.data() + pos));
+        if (raw.size() < pos + sizeof(uint16_t) + len) {
+            return -1;
+        }
+        key = Bytes(raw.data() + pos + sizeof(uint16_t), len);
+    }
+
+    out->assign(1, type);
+    if (to == KEY_FORMAT_SLOT) {
+        uint16_t slot = (uint16_t)keyHashSlot(key.data(), key.size());
+        slot = htobe16(slot);
+        out->append((char *)&slot, sizeof(uint16_t));
+    }
+    out->append(raw.data() + pos, raw.size() - pos);
+
+    return 1;
+}
+
+int collection_prefix_size(const char *data, size_t size, int format){
+    if (size < 1) {
+        return -1;
+    }
+
+    char type = data[0];
+    if (type != DataType::ITEM && type != DataType::ZSCORE && type != DataType::ZRANK) {
+        return -1;
+    }
+
+    size_t pos = 1;
+    if (format == KEY_FORMAT_SLOT) {
+        pos += sizeof(uint16_t);
+    }
+    if (size < pos + sizeof(uint16_t)) {
+        return -1;
+    }
+    uint16_t len = be16toh(*(uint16_t *)(data + pos));
+    pos += sizeof(uint16_t) + len + sizeof(uint16_t);
+    if (size < pos) {
+        return -1;
+    }
+
+    return (int) pos;
+}
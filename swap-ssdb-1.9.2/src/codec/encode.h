@@ -11,6 +11,25 @@ found in the LICENSE file.
 
 class Bytes;
 
+/*
+ * on-disk key format. KEY_FORMAT_SLOT puts the big-endian cluster slot right
+ * after the type byte of meta/item/zscore/zrank keys, so all keys of one slot
+ * are contiguous within each type. set once when the db is opened.
+ */
+void set_key_format(int format);
+
+int get_key_format();
+
+string encode_slot_prefix(char type, uint16_t slot);
+
+int convert_key_format(const Bytes& raw, int from, int to, string *out);
+
+/*
+ * size of type + [slot] + len + key + version, the prefix shared by all item,
+ * zscore and zrank keys of one collection version. -1 for other keys.
+ */
+int collection_prefix_size(const char *data, size_t size, int format);
+
 string encode_meta_key(const Bytes& key);
 
 string encode_hash_key(const Bytes& key, const Bytes& field, uint16_t version);
@@ -27,6 +46,10 @@ string encode_zscore_prefix(const Bytes &key, uint16_t version);
 
 string encode_zscore_key(const Bytes& key, const Bytes& field, double score, uint16_t version);
 
+string encode_zrank_prefix(const Bytes &key, uint16_t version);
+
+string encode_zrank_key(const Bytes& key, uint16_t version, uint8_t level, const Bytes& score_prefix);
+
 string encode_eset_key(const Bytes& member);
 
 string encode_escore_key(const Bytes& member, uint64_t score);
@@ -45,6 +68,12 @@ string encode_zset_meta_val(uint64_t length, uint16_t version, char del = KEY_EN
 
 string encode_list_meta_val(uint64_t length, uint64_t left, uint64_t right, uint16_t version, char del = KEY_ENABLED_MASK);
 
+/*
+ * merge operand of a meta value: DataType::KV adds delta to an integer value,
+ * HSIZE/SSIZE/ZSIZE add delta to the length of an enabled collection
+ */
+string encode_meta_delta(char type, int64_t delta);
+
 /*
  * delete key
  */
@@ -58,5 +87,7 @@ string encode_repo_key();
 
 string encode_repo_item(uint64_t timestamp, uint64_t index);
 
+string encode_key_format_key();
+
 
 #endif //SSDB_ENCODE_H
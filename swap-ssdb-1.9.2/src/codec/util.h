@@ -18,6 +18,9 @@ using namespace std;
 #define POS_TYPE 0
 #define POS_DEL  3
 
+#define KEY_FORMAT_PLAIN 0
+#define KEY_FORMAT_SLOT  1
+
 #define ZSET_SCORE_SHIFT 1000000000000000000LL
 
 #define OBJ_SET_NO_FLAGS 0
@@ -61,6 +64,7 @@ public:
     static const char ITEM		= 'S'; // meta value item
 
     static const char ZSCORE	= 'z';
+    static const char ZRANK 	= 'r'; // zset rank index
 
     static const char ESCORE	= 'T'; // expire key
     static const char EKEY   	= 'E'; // expire timestamp key
@@ -71,6 +75,8 @@ public:
     static const char REPOKEY		= 'L';
     static const char REPOITEM		= 'l';
 
+    static const char KEYFORMAT		= 'F'; // key format marker, repo column family
+
 };
 
 
@@ -30,6 +30,7 @@ Link::Link(bool is_server) {
     sock = -1;
     noblock_ = false;
     error_ = false;
+    recv_redis_ = false;
     remote_ip[0] = '\0';
     remote_port = -1;
     auth = false;
@@ -395,6 +396,7 @@ int Link::flush() {
 
 const std::vector<Bytes> *Link::recv() {
     this->recv_data.clear();
+    this->recv_redis_ = false;
 
     if (input->empty()) {
         return &this->recv_data;
@@ -420,6 +422,7 @@ const std::vector<Bytes> *Link::recv() {
         const std::vector<Bytes> *ret = redis->recv_req(input);
         if (ret) {
             this->recv_data = *ret;
+            this->recv_redis_ = !ret->empty();
             return &this->recv_data;
         } else {
             return NULL;
@@ -503,6 +506,16 @@ const std::vector<Bytes> *Link::recv() {
     return &this->recv_data;
 }
 
+RedisLink *Link::detach_redis_req() {
+    if (!recv_redis_) {
+        return NULL;
+    }
+    RedisLink *req = new RedisLink();
+    redis->move_req(req);
+    recv_redis_ = false;
+    return req;
+}
+
 int Link::send_append_res(const std::vector<std::string> &resp) {
     if (resp.empty()) {
         return 0;
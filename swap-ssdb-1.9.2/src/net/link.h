@@ -16,12 +16,14 @@ found in the LICENSE file.
 
 #include "link_redis.h"
 class Context;
+struct ProcJob;
 
 class Link{
 	private:
 		int sock;
 		bool noblock_;
 		bool error_;
+		bool recv_redis_;
 		std::vector<Bytes> recv_data;
 	public:
 		bool append_reply;
@@ -42,6 +44,12 @@ class Link{
 		double create_time;
 		double active_time;
 
+		// pipelined requests handed to workers together, the first one not
+		// fitting into that batch waits in pending
+		std::vector<ProcJob *> pipeline;
+		ProcJob *pending = nullptr;
+		int in_flight = 0;
+
 		Link(bool is_server=false);
 		~Link();
 		void close();
@@ -102,6 +110,9 @@ class Link{
 		const std::vector<Bytes>* last_recv(){
 			return &recv_data;
 		}
+		// takes the RESP request of the last recv() away from this link,
+		// NULL if it was not RESP
+		RedisLink* detach_redis_req();
 
 		/** these methods will send a request to the server, and wait until a response received.
 		 * @return
@@ -7,6 +7,7 @@ found in the LICENSE file.
 #include <map>
 #include <cstring>
 #include <net/redis/reponse_redis.h>
+#include <net/redis/resp_writer.h>
 #include <unordered_map>
 
 enum REPLY{
@@ -569,22 +570,35 @@ const std::vector<Bytes>* RedisLink::recv_req(Buffer *input){
 	return &recv_bytes;
 }
 
+void RedisLink::move_req(RedisLink *req){
+	req->cmd.swap(cmd);
+	req->req_desc = req_desc;
+	req->recv_string.swap(recv_string);
+}
+
+// bytes of the array header plus every step-th bulk of resp from begin on
+static size_t multi_bulk_size(const std::vector<std::string> &resp, size_t begin, size_t step){
+	size_t count = 0;
+	size_t size = 0;
+	for(size_t i=begin; i<resp.size(); i+=step){
+		size += RespWriter::bulk_size(resp[i].size());
+		count ++;
+	}
+	return RespWriter::header_size((long long) count) + size;
+}
+
 int RedisLink::send_append_resp(Buffer *output, const std::vector<std::string> &resp_append){
 	if(resp_append.empty()){
 		return 0;
 	}
 
-	char buf[32];
-	snprintf(buf, sizeof(buf), "*%d\r\n", (int) resp_append.size());
- 	output->append(buf);
-
+	RespWriter writer(output);
+	if(writer.reserve(multi_bulk_size(resp_append, 0, 1)) == -1){
+		return -1;
+	}
+	writer.array((int) resp_append.size());
 	for(int i=0; i<resp_append.size(); i++){
-		const std::string &val = resp_append[i];
-		char buf[32];
-		snprintf(buf, sizeof(buf), "$%d\r\n", (int)val.size());
-		output->append(buf);
-		output->append(val.data(), val.size());
-		output->append("\r\n");
+		writer.bulk(resp_append[i]);
 	}
 
 	return 0;
@@ -618,35 +632,37 @@ int RedisLink::send_resp(Buffer *output, const std::vector<std::string> &resp){
 	}
 	
 	// not supported command
+	RespWriter writer(output);
+
 	if(req_desc == NULL){
-		{
-			char buf[32];
-			snprintf(buf, sizeof(buf), "*%d\r\n", (int)resp.size() - 1);
-			output->append(buf);
+		if(writer.reserve(multi_bulk_size(resp, 1, 1)) == -1){
+			return -1;
 		}
+		writer.array((int)resp.size() - 1);
 		for(int i=1; i<resp.size(); i++){
-			const std::string &val = resp[i];
-			char buf[32];
-			snprintf(buf, sizeof(buf), "$%d\r\n", (int)val.size());
-			output->append(buf);
-			output->append(val.data(), val.size());
-			output->append("\r\n");
+			writer.bulk(resp[i]);
 		}
 		return 0;
 	}
 	if(req_desc->reply_type == REPLY_INFO){
-
-		std::string tmp;
+		// one bulk of all lines
+		size_t len = 0;
 		for(int i=1; i<resp.size(); i++){
-			const std::string &val = resp[i];
-			tmp.append(val);
-			tmp.append("\r\n");
+			len += resp[i].size() + 2;
+		}
+		if(writer.reserve(RespWriter::bulk_size(len)) == -1){
+			return -1;
 		}
 
-		char buf[32];
-		snprintf(buf, sizeof(buf), "$%d\r\n", (int)tmp.size());
-		output->append(buf);
-		output->append(tmp.data(), tmp.size());
+		char buf[24];
+		buf[0] = '$';
+		int n = ll2string(buf + 1, sizeof(buf) - 1, (long long) len);
+		output->append(buf, n + 1);
+		output->append("\r\n");
+		for(int i=1; i<resp.size(); i++){
+			output->append(resp[i].data(), resp[i].size());
+			output->append("\r\n");
+		}
 		output->append("\r\n");
 
 		return 0;
@@ -687,12 +703,10 @@ int RedisLink::send_resp(Buffer *output, const std::vector<std::string> &resp){
 	}
 	if(req_desc->reply_type == REPLY_BULK){
 		if(resp.size() >= 2){
-			const std::string &val = resp[1];
-			char buf[32];
-			snprintf(buf, sizeof(buf), "$%d\r\n", (int)val.size());
-			output->append(buf);
-			output->append(val.data(), val.size());
-			output->append("\r\n");
+			if(writer.reserve(RespWriter::bulk_size(resp[1].size())) == -1){
+				return -1;
+			}
+			writer.bulk(resp[1]);
 		}else{
 			output->append("$0\r\n");
 		}
@@ -715,16 +729,20 @@ int RedisLink::send_resp(Buffer *output, const std::vector<std::string> &resp){
 			//log_error("bad response for multi_(h)get");
 			return 0;
 		}
-		char buf[32];
 		std::vector<std::string>::const_iterator req_it, resp_it;
 		if(req_desc->strategy == STRATEGY_MGET){
 			req_it = recv_string.begin() + 1;
-			snprintf(buf, sizeof(buf), "*%d\r\n", (int)recv_string.size() - 1);
 		}else{
 			req_it = recv_string.begin() + 2;
-			snprintf(buf, sizeof(buf), "*%d\r\n", (int)recv_string.size() - 2);
 		}
-		output->append(buf);
+		// values, plus a nil for every key not found
+		size_t keys = recv_string.end() - req_it;
+		size_t found = (resp.size() - 1) / 2;
+		size_t missing = keys > found ? keys - found : 0;
+		if(writer.reserve(multi_bulk_size(resp, 2, 2) + missing * 5) == -1){
+			return -1;
+		}
+		writer.array((long long) keys);
 		
 		resp_it = resp.begin() + 1;
 
@@ -743,12 +761,7 @@ int RedisLink::send_resp(Buffer *output, const std::vector<std::string> &resp){
 				continue;
 			}
 				
-			const std::string &val = *(resp_it + 1);
-			char buf[32];
-			snprintf(buf, sizeof(buf), "$%d\r\n", (int)val.size());
-			output->append(buf);
-			output->append(val.data(), val.size());
-			output->append("\r\n");
+			writer.bulk(*(resp_it + 1));
 				
 			resp_it += 2;
 		}
@@ -763,26 +776,15 @@ int RedisLink::send_resp(Buffer *output, const std::vector<std::string> &resp){
 			 if (resp.size() == 1) {
 				 output->append("$-1\r\n");
 			 } else {
-				 const std::string &val = resp[1];
-				 char buf[32];
-				 snprintf(buf, sizeof(buf), "$%d\r\n", (int)val.size());
-				 output->append(buf);
-				 output->append(val.data(), val.size());
-				 output->append("\r\n");
+				 writer.bulk(resp[1]);
 			 }
 		} else {
-			{
-				char buf[32];
-				snprintf(buf, sizeof(buf), "*%d\r\n", ((int)resp.size() - 1));
-				output->append(buf);
+			if(writer.reserve(multi_bulk_size(resp, 1, 1)) == -1){
+				return -1;
 			}
+			writer.array((int)resp.size() - 1);
 			for(int i=1; i<resp.size(); i++){
-				const std::string &val = resp[i];
-				char buf[32];
-				snprintf(buf, sizeof(buf), "$%d\r\n", (int)val.size());
-				output->append(buf);
-				output->append(val.data(), val.size());
-				output->append("\r\n");
+				writer.bulk(resp[i]);
 			}
 		}
 
@@ -797,27 +799,15 @@ int RedisLink::send_resp(Buffer *output, const std::vector<std::string> &resp){
 				break;
 			}
 
-			output->append("*2\r\n");
-
-			const std::string &cursor = resp[1];
-			char buf[32];
-			snprintf(buf, sizeof(buf), "$%d\r\n", (int)cursor.size());
-			output->append(buf);
-			output->append(cursor.data(), cursor.size());
-			output->append("\r\n");
-
-			size_t count = resp.size() - 2;
-
-			snprintf(buf, sizeof(buf), "*%d\r\n", (int)count);
-			output->append(buf);
+			if(writer.reserve(4 + RespWriter::bulk_size(resp[1].size()) + multi_bulk_size(resp, 2, 1)) == -1){
+				return -1;
+			}
+			writer.array(2);
+			writer.bulk(resp[1]);
 
+			writer.array((int)resp.size() - 2);
 			for(int i=2; i<resp.size(); i++){
-				const std::string &val = resp[i];
-				char buf[32];
-				snprintf(buf, sizeof(buf), "$%d\r\n", (int)val.size());
-				output->append(buf);
-				output->append(val.data(), val.size());
-				output->append("\r\n");
+				writer.bulk(resp[i]);
 			}
 
 		} while (0);
@@ -837,25 +827,17 @@ int RedisLink::send_resp(Buffer *output, const std::vector<std::string> &resp){
 				withscores = false;
 			}
 		}
-		{
-			char buf[32];
-			if(withscores){
-				snprintf(buf, sizeof(buf), "*%d\r\n", (int)resp.size() - 1);
-			}else{
-				snprintf(buf, sizeof(buf), "*%d\r\n", ((int)resp.size() - 1)/2);
-			}
-			output->append(buf);
+		size_t step = withscores ? 1 : 2;
+		if(writer.reserve(multi_bulk_size(resp, 1, step)) == -1){
+			return -1;
 		}
-		for(int i=1; i<resp.size(); i++){
-			const std::string &val = resp[i];
-			char buf[32];
-			snprintf(buf, sizeof(buf), "$%d\r\n", (int)val.size());
-			output->append(buf);
-			output->append(val.data(), val.size());
-			output->append("\r\n");
-			if(!withscores){
-				i += 1;
-			}
+		if(withscores){
+			writer.array((int)resp.size() - 1);
+		}else{
+			writer.array(((int)resp.size() - 1)/2);
+		}
+		for(int i=1; i<resp.size(); i+=step){
+			writer.bulk(resp[i]);
 		}
 		return 0;
 	}
@@ -893,6 +875,7 @@ int RedisLink::parse_req(Buffer *input){
 		size -= (lf - ptr);
 		parsed += (lf - ptr);
 		
+		errno = 0;
 		int len = (int)strtol(ptr + 1, NULL, 10); // ptr + 1: skip '$' or '*'
 		if(errno == EINVAL){
 			return -1;
@@ -41,6 +41,9 @@ public:
 	}
 	
 	const std::vector<Bytes>* recv_req(Buffer *input);
+	// hand the request of the last recv_req() over to req, the Bytes it
+	// returned keep pointing into the moved strings
+	void move_req(RedisLink *req);
 	int recv_res(Buffer *input, RedisResponse *r, int shit);
 	int send_resp(Buffer *output, const std::vector<std::string> &resp);
 	int send_append_resp(Buffer *output, const std::vector<std::string> &resp_append);
@@ -5,8 +5,51 @@ found in the LICENSE file.
 */
 #include "proc.h"
 #include "server.h"
+#include "link.h"
+#include "redis/reponse_redis.h"
 #include "../util/log.h"
 
+ProcJob::~ProcJob(){
+	delete redis;
+	delete own_output;
+}
+
+void ProcJob::detach(){
+	own_ctx = *link->context;
+	ctx = &own_ctx;
+	if(own_output == NULL){
+		own_output = new Buffer(1024);
+	}
+	output = own_output;
+}
+
+int ProcJob::reply(){
+	int ret = 0;
+	if(resp.redisResponse != nullptr && redis != NULL){
+		// raw redis protocol
+		ret = resp.redisResponse->toRedis(output);
+	}else if(redis != NULL){
+		ret = redis->send_resp(output, resp.resp);
+	}else if(!resp.resp.empty()){
+		for(int i=0; i<resp.resp.size(); i++){
+			output->append_record(resp.resp[i]);
+		}
+		output->append('\n');
+	}
+	if(resp.redisResponse != nullptr){
+		delete resp.redisResponse;
+		resp.redisResponse = nullptr;
+	}
+	if(ret == -1){
+		return -1;
+	}
+
+	if(link->append_reply && redis != NULL && !resp.resp.empty()){
+		return redis->send_append_resp(output, ctx->get_append_array());
+	}
+	return 0;
+}
+
 ProcMap::ProcMap(){
 }
 
@@ -13,9 +13,11 @@ found in the LICENSE file.
 #include "../util/bytes.h"
 
 class Link;
+class RedisLink;
 class NetworkServer;
 class SSDBServer;
 class TransferWorker;
+class TransferJob;
 
 #define PROC_OK			0
 #define PROC_ERROR		-1
@@ -24,6 +26,7 @@ class TransferWorker;
 
 #define DEF_PROC(f) int proc_##f(Context &ctx, Link *link, const Request &req, Response *resp)
 #define DEF_BPROC(c) int bproc_##c(Context &ctx, TransferWorker *worker, const std::string &dataKey, const std::string &trasId, void* value)
+#define DEF_BPROC_BATCH(c) int bproc_batch_##c(TransferWorker *worker, const std::vector<TransferJob *> &jobs)
 
 typedef std::vector<Bytes> Request;
 typedef int (*proc_t)(Context &ctx, Link *link, const Request &req, Response *resp);
@@ -63,6 +66,20 @@ struct ProcJob{
 
 	const Request *req;
 	Response resp;
+
+	// a job owns its request, so the pipelined requests of a link can be
+	// parsed and handed to workers together, see NetworkServer::proc_link()
+	Request req_data;
+	std::vector<std::string> req_buf;
+	RedisLink *redis;	// reply format of a RESP request, NULL for ssdb protocol
+
+	Context *ctx;		// link->context, or own_ctx once detached
+	Buffer *output;		// link->output, or own_output once detached
+	Context own_ctx;
+	Buffer *own_output;
+
+	// writes of the same batch, run in order right after this one
+	std::vector<ProcJob *> batch;
 	
 	ProcJob(){
 		result = 0;
@@ -72,9 +89,19 @@ struct ProcJob{
 		stime = 0;
 		time_wait = 0;
 		time_proc = 0;
+		req = NULL;
+		redis = NULL;
+		ctx = NULL;
+		output = NULL;
+		own_output = NULL;
 	}
-	~ProcJob(){
-	}
+	~ProcJob();
+
+	// reads running concurrently with others of their link get a copy of the
+	// link context and buffer their reply until it is their turn
+	void detach();
+	// append the reply of resp to output
+	int reply();
 };
 
 
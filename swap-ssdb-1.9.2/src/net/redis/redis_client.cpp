@@ -69,6 +69,32 @@ RedisResponse *RedisClient::redisRequest(const std::vector<std::string> &args) {
     return this->redisResponse();
 }
 
+int RedisClient::redisRequests(const std::vector<std::vector<std::string>> &reqs, std::vector<RedisResponse *> *res) {
+    if (so_link == nullptr) {
+        return -1;
+    }
+
+    for (const auto &args : reqs) {
+        if (this->redisRequestSend(args) == -1) {
+            return -1;
+        }
+    }
+
+    if (so_link->flush() == -1) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < reqs.size(); ++i) {
+        RedisResponse *r = this->redisResponse();
+        if (r == nullptr) {
+            return -1;
+        }
+        res->push_back(r);
+    }
+
+    return 0;
+}
+
 RedisClient *RedisClient::connect(const char *host, int port, long timeout_ms) {
     Link *so_link = Link::connect(host, port, timeout_ms);
     if (so_link == nullptr) {
@@ -23,6 +23,9 @@ public:
 
     RedisResponse *redisRequest(const std::vector<std::string> &args);
 
+    // pipelined: send all requests in one flush, then read one response per request
+    int redisRequests(const std::vector<std::vector<std::string>> &reqs, std::vector<RedisResponse *> *res);
+
     static RedisClient *connect(const char *host, int port, long timeout_ms = -1);
 
 private:
@@ -70,6 +70,36 @@ RedisResponse *RedisUpstream::sendCommand(const std::vector<std::string> &args)
     return res;
 }
 
+int RedisUpstream::sendCommands(const std::vector<std::vector<std::string>> &reqs, std::vector<RedisResponse *> *res) {
+    int ret = -1;
+
+    for (int i = 0; i < maxRetry; ++i) {
+        if (client == nullptr) {
+            //reconnect
+            reset();
+            continue;
+        }
+
+        ret = client->redisRequests(reqs, res);
+        if (ret == -1) {
+            for (auto r : *res) {
+                delete r;
+            }
+            res->clear();
+            reset();
+            continue;
+        } else {
+            break;
+        }
+    }
+
+    if (client == nullptr) {
+        log_error("send commands to redis failed due to cannot connect to redis");
+    }
+
+    return ret;
+}
+
 void RedisUpstream::setMaxRetry(int maxRetry) {
     RedisUpstream::maxRetry = maxRetry;
 }
\ No newline at end of file
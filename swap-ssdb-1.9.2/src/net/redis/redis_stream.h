@@ -24,6 +24,8 @@ public:
 
     RedisResponse *sendCommand(const std::vector<std::string> &args);
 
+    int sendCommands(const std::vector<std::vector<std::string>> &reqs, std::vector<RedisResponse *> *res);
+
     void setMaxRetry(int maxRetry);
 
     bool isConnected() {
@@ -9,6 +9,7 @@ found in the LICENSE file.
 
 #include <vector>
 #include <string>
+#include "resp_writer.h"
 
 #define REDIS_REPLY_STRING 1
 #define REDIS_REPLY_ARRAY 2
@@ -61,6 +62,14 @@ public:
         element.push_back(response);
     }
 
+    size_t size() const {
+        return element.size();
+    }
+
+    RedisResponse *at(size_t i) {
+        return element[i];
+    }
+
 
 
     void reset() {
@@ -129,45 +138,65 @@ public:
     }
 
 
-    std::string toRedis() {
-
-        std::string tmp;
-
+    // bytes written by toRedis
+    size_t redisSize() const {
         switch (type) {
             case REDIS_REPLY_NIL:
-                tmp += "$-1\r\n";
-                break;
-
+                return 5;
             case REDIS_REPLY_STRING:
-                tmp += "$" + std::to_string(str.length()) + "\r\n";
-                if (str.length() != 0) {
-                    tmp += str + "\r\n";
-                }
-                break;
-
+                return RespWriter::bulk_size(str.size());
             case REDIS_REPLY_STATUS:
-                tmp += "+" + str + "\r\n";
-                break;
-
             case REDIS_REPLY_ERROR:
-                tmp += "-" + str + "\r\n";
-                break;
-
+                return str.size() + 3;
             case REDIS_REPLY_INTEGER:
-                tmp += ":" + std::to_string(integer) + "\r\n";
-                break;
-
+                return RespWriter::header_size(integer);
             case REDIS_REPLY_ARRAY: {
-                tmp += "*" + std::to_string(element.size()) + "\r\n";
-                for (int i = 0; i < element.size(); ++i) {
-                    tmp += element[i]->toRedis();
+                size_t size = RespWriter::header_size((long long) element.size());
+                for (const RedisResponse *e : element) {
+                    size += e->redisSize();
                 }
-                break;
+                return size;
             }
+            default:
+                return 0;
+        }
+    }
 
+    int toRedis(Buffer *output) const {
+        RespWriter writer(output);
+        if (writer.reserve(redisSize()) == -1) {
+            return -1;
         }
+        return write(&writer);
+    }
 
-        return tmp;
+private:
+    int write(RespWriter *writer) const {
+        switch (type) {
+            case REDIS_REPLY_NIL:
+                return writer->nil();
+            case REDIS_REPLY_STRING:
+                return writer->bulk(str);
+            case REDIS_REPLY_STATUS:
+                return writer->line('+', str.data(), str.size());
+            case REDIS_REPLY_ERROR:
+                return writer->line('-', str.data(), str.size());
+            case REDIS_REPLY_INTEGER:
+                return writer->integer(integer);
+            case REDIS_REPLY_ARRAY: {
+                if (writer->array((long long) element.size()) == -1) {
+                    return -1;
+                }
+                for (const RedisResponse *e : element) {
+                    if (e->write(writer) == -1) {
+                        return -1;
+                    }
+                }
+                return 0;
+            }
+            default:
+                return 0;
+        }
     }
 };
 
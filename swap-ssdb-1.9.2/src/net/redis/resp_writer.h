@@ -0,0 +1,79 @@
+/*
+Copyright (c) 2017, Timothy. All rights reserved.
+Use of this source code is governed by a BSD-style license that can be
+found in the LICENSE file.
+*/
+
+#ifndef SSDB_RESP_WRITER_H
+#define SSDB_RESP_WRITER_H
+
+#include <string>
+#include "util/bytes.h"
+#include "util/strings.h"
+
+/*
+ * writes RESP straight into an output Buffer, lengths are formatted on the
+ * stack. big replies sum the *_size() of their parts and reserve() once.
+ */
+class RespWriter {
+public:
+    explicit RespWriter(Buffer *output) : output(output) {}
+
+    static size_t header_size(long long n) {
+        char buf[24];
+        return (size_t) ll2string(buf, sizeof(buf), n) + 3;
+    }
+
+    static size_t bulk_size(size_t len) {
+        return header_size((long long) len) + len + 2;
+    }
+
+    int reserve(size_t size) {
+        return output->reserve((int) size);
+    }
+
+    int array(long long n) {
+        return header('*', n);
+    }
+
+    int integer(long long n) {
+        return header(':', n);
+    }
+
+    int nil() {
+        return output->append("$-1\r\n", 5);
+    }
+
+    int bulk(const char *data, size_t len) {
+        if (header('$', (long long) len) == -1 || output->append(data, (int) len) == -1) {
+            return -1;
+        }
+        return output->append("\r\n", 2);
+    }
+
+    int bulk(const std::string &s) {
+        return bulk(s.data(), s.size());
+    }
+
+    // simple strings, status and error lines
+    int line(char type, const char *data, size_t len) {
+        if (output->append(type) == -1 || output->append(data, (int) len) == -1) {
+            return -1;
+        }
+        return output->append("\r\n", 2);
+    }
+
+private:
+    Buffer *output;
+
+    int header(char type, long long n) {
+        char buf[24];
+        buf[0] = type;
+        int len = ll2string(buf + 1, sizeof(buf) - 3, n);
+        buf[len + 1] = '\r';
+        buf[len + 2] = '\n';
+        return output->append(buf, len + 3);
+    }
+};
+
+#endif //SSDB_RESP_WRITER_H
@@ -27,8 +27,7 @@ void TransferWorker::init() {
     this->last = 0;
 }
 
-int TransferWorker::proc(TransferJob *job) {
-
+int TransferWorker::checkUpstream(TransferJob *job) {
     if (redisUpstream == nullptr) {
         auto serv = ((SSDBServer* )(job->ctx.net->data));
         if (serv->opt.upstream_port == 0) {
@@ -44,6 +43,15 @@ int TransferWorker::proc(TransferJob *job) {
         return -1;
     }
 
+    return 0;
+}
+
+int TransferWorker::proc(TransferJob *job) {
+
+    if (checkUpstream(job) != 0) {
+        return -1;
+    }
+
     int64_t current = time_ms();
     int res = (*job->proc)(job->ctx, this, job->data_key, job->trans_id, job->dumpData);
     if (res != 0) {
@@ -51,12 +59,73 @@ int TransferWorker::proc(TransferJob *job) {
     }
 
     int64_t process_time = time_ms() - current;
-    int64_t wait_time = current -  job->ts;
 
     if (process_time > 100) {
         log_warn("task %s process %d ms",  job->dump().c_str(), process_time);
     }
 
+    stat(job, current, process_time);
+
+    return 0;
+}
+
+/*
+ * consecutive jobs sharing the same batch_proc and having distinct keys are
+ * handed over as one batch, so that the round trips to redis are shared.
+ */
+int TransferWorker::proc_batch(std::vector<TransferJob *> &jobs) {
+
+    size_t i = 0;
+    while (i < jobs.size()) {
+        TransferJob *job = jobs[i];
+        if (job->batch_proc == nullptr) {
+            proc(job);
+            i++;
+            continue;
+        }
+
+        std::vector<TransferJob *> group;
+        std::set<std::string> keys;
+        while (i < jobs.size() && jobs[i]->batch_proc == job->batch_proc && keys.insert(jobs[i]->data_key).second) {
+            group.push_back(jobs[i]);
+            i++;
+        }
+
+        if (group.size() == 1) {
+            proc(job);
+            continue;
+        }
+
+        if (checkUpstream(job) != 0) {
+            continue;
+        }
+
+        int64_t current = time_ms();
+        int res = (*job->batch_proc)(this, group);
+        if (res != 0) {
+            log_error("bg_job batch failed, size: %d, first %s ", group.size(), job->dump().c_str());
+        }
+
+        int64_t process_time = time_ms() - current;
+
+        if (process_time > 100) {
+            log_warn("batch of %d tasks process %d ms", group.size(), process_time);
+        }
+
+        auto serv = ((SSDBServer* )(job->ctx.net->data));
+        serv->transfer_stats.add(group.size(), (uint64_t) process_time);
+
+        for (auto j : group) {
+            stat(j, current, process_time);
+        }
+    }
+
+    return 0;
+}
+
+void TransferWorker::stat(TransferJob *job, int64_t current, int64_t process_time) {
+    int64_t wait_time = current -  job->ts;
+
     if (wait_time > 100) {
         log_debug("task %s had waited %d ms",  job->dump().c_str(), wait_time);
     }
@@ -80,7 +149,4 @@ int TransferWorker::proc(TransferJob *job) {
         }
 
     }
-
-    return 0;
 }
-
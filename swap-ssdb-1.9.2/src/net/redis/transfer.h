@@ -23,6 +23,9 @@ found in the LICENSE file.
 typedef int (*bproc_t)(Context &ctx, TransferWorker *, const std::string &data_key, const std::string &trans_id, void *value);
 
 class SSDBServer;
+class TransferJob;
+
+typedef int (*bproc_batch_t)(TransferWorker *, const std::vector<TransferJob *> &jobs);
 
 
 class TransferJob {
@@ -39,6 +42,7 @@ public:
 
     DumpData *dumpData;
     bproc_t proc;
+    bproc_batch_t batch_proc = nullptr; // optional, for jobs coalesced by TransferWorker::proc_batch
 
     TransferJob(Context &ctx, uint16_t type, const std::string &key, const std::string &id, DumpData *value = nullptr) :
             ctx(ctx), type(type), data_key(key),  trans_id(id), dumpData(value) {
@@ -62,6 +66,25 @@ public:
 
 };
 
+// stat of coalesced transfer batches, shared by all transfer workers
+class TransferStats {
+public:
+    std::atomic<uint64_t> batches{0};
+    std::atomic<uint64_t> batch_keys{0};
+    std::atomic<uint64_t> batch_time{0}; //ms
+    std::atomic<uint64_t> batch_max_time{0}; //ms
+
+    void add(uint64_t keys, uint64_t time) {
+        batches++;
+        batch_keys += keys;
+        batch_time += time;
+
+        uint64_t max = batch_max_time.load();
+        while (time > max && !batch_max_time.compare_exchange_weak(max, time)) {
+        }
+    }
+};
+
 // WARN: pipe latency is about 20 us, it is really slow!
 class TransferWorker : public WorkerPool<TransferWorker, TransferJob *>::Worker {
 public:
@@ -72,12 +95,18 @@ public:
 
     int proc(TransferJob *job);
 
+    int proc_batch(std::vector<TransferJob *> &jobs);
+
     virtual ~TransferWorker();
 
     RedisUpstream *redisUpstream = nullptr;
 
 private:
 
+    int checkUpstream(TransferJob *job);
+
+    void stat(TransferJob *job, int64_t current, int64_t process_time);
+
     //stat only
     int64_t count;
     double avg_wait;
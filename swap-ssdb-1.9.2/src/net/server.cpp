@@ -140,14 +140,20 @@ NetworkServer::~NetworkServer(){
 	if (serv_socket != nullptr ) {
 		delete serv_socket;
 	}
-	delete fdes;
 	delete ip_filter;
 
-	writer->stop();
-	delete writer;
-
-	reader->stop();
-	delete reader;
+	for(int i=0; i<reactors.size(); i++){
+		NetworkReactor *r = reactors[i];
+		r->writer->stop();
+		delete r->writer;
+		r->reader->stop();
+		delete r->reader;
+		if(r->fdes != fdes){
+			delete r->fdes;
+		}
+		delete r;
+	}
+	delete fdes;
 
 	redis->stop();
 	delete redis;
@@ -210,9 +216,21 @@ NetworkServer* NetworkServer::init(const Config &conf, int num_readers, int num_
 			serv->num_transfers = conf.get_num("server.transfers");
 		}
 
+        if(conf.get_num("server.transfer_batch") > 0){
+			serv->num_transfer_batch = conf.get_num("server.transfer_batch");
+		}
+
         if(conf.get_num("server.num_background") > 0){
 			serv->num_background = conf.get_num("server.num_background");
 		}
+
+        if(conf.get_num("server.reactors") > 0){
+			serv->num_reactors = conf.get_num("server.reactors");
+		}
+
+        if(conf.get_num("server.pipeline_depth") > 0){
+			serv->pipeline_depth = conf.get_num("server.pipeline_depth");
+		}
 	}
 
 	// init ip_filter
@@ -292,48 +310,102 @@ NetworkServer* NetworkServer::init(const Config &conf, int num_readers, int num_
 }
 
 void NetworkServer::serve(){
-	writer = new ProcWorkerPool("writer");
-	writer->start(num_writers);
-	reader = new ProcWorkerPool("reader");
-	reader->start(num_readers);
+	// readers and writers are split among the reactors
+	int readers = std::max(1, num_readers / num_reactors);
+	int writers = std::max(1, num_writers / num_reactors);
+	for(int i=0; i<num_reactors; i++){
+		NetworkReactor *r = new NetworkReactor();
+		r->id = i;
+		r->serv = this;
+		r->fdes = (i == 0) ? fdes : new Fdevents();
+		r->writer = new ProcWorkerPool("writer");
+		r->writer->start(writers);
+		r->reader = new ProcWorkerPool("reader");
+		r->reader->start(readers);
+		reactors.push_back(r);
+	}
 
 	redis = new TransferWorkerPool("transfer");
+	redis->set_batch_size(num_transfer_batch);
 	redis->start(num_transfers);
 
     background = new BackgroundThreadPool("background");
     background->start(num_background);
 
-	ready_list_t ready_list;
-	ready_list_t ready_list_2;
-	ready_list_t::iterator it;
-	const Fdevents::events_t *events;
-
 	fdes->set(serv_link->fd(), FDEVENT_IN, 0, serv_link);
 	if (serv_socket != nullptr) {
 		fdes->set(serv_socket->fd(), FDEVENT_IN, 0, serv_socket);
 	}
-	fdes->set(this->reader->fd(), FDEVENT_IN, 0, this->reader);
-	fdes->set(this->writer->fd(), FDEVENT_IN, 0, this->writer);
 	fdes->set(this->redis->fd(), FDEVENT_IN, 0, this->redis);
 	fdes->set(this->background->fd(), FDEVENT_IN, 0, this->background);
 
+	for(int i=1; i<reactors.size(); i++){
+		if(pthread_create(&reactors[i]->tid, NULL, &NetworkServer::_run_reactor, reactors[i]) != 0){
+			log_fatal("can't create reactor thread: %s", strerror(errno));
+			exit(1);
+		}
+	}
+
+	log_info("ssdb server started, reactors: %d", (int)reactors.size());
+	run(reactors[0]);
+
+	for(int i=1; i<reactors.size(); i++){
+		pthread_join(reactors[i]->tid, NULL);
+	}
+}
+
+void* NetworkServer::_run_reactor(void *arg){
+	NetworkReactor *r = (NetworkReactor *)arg;
+	r->serv->run(r);
+	return (void *)NULL;
+}
+
+// called by reactors[0] only
+void NetworkServer::add_link(NetworkReactor *r, Link *link){
+	this->link_count ++;
+	NetworkReactor *to = reactors[next_reactor];
+	next_reactor = (next_reactor + 1) % (int)reactors.size();
+	if(to == r){
+		r->fdes->set(link->fd(), FDEVENT_IN, 1, link);
+	}else{
+		to->links.push(link);
+	}
+}
+
+void NetworkServer::run(NetworkReactor *r){
+	bool main = (r->id == 0);
+	Fdevents *fdes = r->fdes;
+
+	ready_list_t ready_list;
+	ready_list_t ready_list_2;
+	ready_list_t::iterator it;
+	const Fdevents::events_t *events;
+	std::vector<ProcJob *> proc_jobs;
+	std::vector<TransferJob *> transfer_jobs;
+	std::vector<BackgroundThreadJob *> background_jobs;
+	std::vector<Link *> new_links;
+
+	fdes->set(r->reader->fd(), FDEVENT_IN, 0, r->reader);
+	fdes->set(r->writer->fd(), FDEVENT_IN, 0, r->writer);
+	fdes->set(r->links.fd(), FDEVENT_IN, 0, &r->links);
+
 	uint32_t status_ticks = g_ticks;
 	uint32_t cursor_ticks = g_ticks;
 
-	log_info("ssdb server started.");
-
 	while(!quit){
 		double loop_stime = millitime();
 
-		// status report
-		if((uint32_t)(g_ticks - status_ticks) >= STATUS_REPORT_TICKS){
-			status_ticks = g_ticks;
-			log_info("server running, links: %d", this->link_count);
-		}
+		if(main){
+			// status report
+			if((uint32_t)(g_ticks - status_ticks) >= STATUS_REPORT_TICKS){
+				status_ticks = g_ticks;
+				log_info("server running, links: %d", this->link_count.load());
+			}
 
-		if((uint32_t)(g_ticks - cursor_ticks) >= CURSOR_CLEANUP_TICKS){
-			cursor_ticks = g_ticks;
-			cleanup_cursor();
+			if((uint32_t)(g_ticks - cursor_ticks) >= CURSOR_CLEANUP_TICKS){
+				cursor_ticks = g_ticks;
+				cleanup_cursor();
+			}
 		}
 
 		ready_list.swap(ready_list_2);
@@ -355,10 +427,9 @@ void NetworkServer::serve(){
 			if(fde->data.ptr == serv_link){
 				Link *link = accept_link(serv_link);
 				if(link){
-					this->link_count ++;
 					log_debug("new link from %s:%d, fd: %d, links: %d",
-						link->remote_ip, link->remote_port, link->fd(), this->link_count);
-					fdes->set(link->fd(), FDEVENT_IN, 1, link);
+						link->remote_ip, link->remote_port, link->fd(), this->link_count.load() + 1);
+					add_link(r, link);
 				}else{
 					log_debug("accept return NULL");
 				}
@@ -366,102 +437,65 @@ void NetworkServer::serve(){
 				Link *link = accept_link(serv_socket);
 				if(link){
                     link->append_reply = true;
-					this->link_count ++;
-					log_debug("new udf link fd: %d, links: %d",  link->fd(), this->link_count);
-					fdes->set(link->fd(), FDEVENT_IN, 1, link);
+					log_debug("new udf link fd: %d, links: %d",  link->fd(), this->link_count.load() + 1);
+					add_link(r, link);
 				}else{
 					log_debug("accept return NULL");
 				}
-			}else if(fde->data.ptr == this->reader || fde->data.ptr == this->writer){
+			}else if(fde->data.ptr == &r->links){
+				if(r->links.pop_all(&new_links) == -1){
+					log_fatal("reading new links error!");
+					exit(0);
+				}
+				for(int j=0; j<(int)new_links.size(); j++){
+					fdes->set(new_links[j]->fd(), FDEVENT_IN, 1, new_links[j]);
+				}
+			}else if(fde->data.ptr == r->reader || fde->data.ptr == r->writer){
+				// one wakeup hands over every job finished since the last one
 				ProcWorkerPool *worker = (ProcWorkerPool *)fde->data.ptr;
-				ProcJob *job = NULL;
-				if(worker->pop(&job) == 0){
+				if(worker->pop_all(&proc_jobs) == -1){
 					log_fatal("reading result from workers error!");
 					exit(0);
 				}
-				if(proc_result(job, &ready_list) == PROC_ERROR){
-					//
+				for(int j=0; j<(int)proc_jobs.size(); j++){
+					proc_result(r, proc_jobs[j], &ready_list);
 				}
 			}else if(fde->data.ptr == this->redis){
 				TransferWorkerPool *worker = (TransferWorkerPool *)fde->data.ptr;
-				TransferJob *job = nullptr;
-				if(worker->pop(&job) == 0){
+				if(worker->pop_all(&transfer_jobs) == -1){
 					log_fatal("reading result from workers error!");
 					exit(0);
 				}
-
-				if (job != nullptr) {
-					delete job;
+				for(int j=0; j<(int)transfer_jobs.size(); j++){
+					delete transfer_jobs[j];
 				}
 
 			} else if(fde->data.ptr == this->background){
                 BackgroundThreadPool *worker = (BackgroundThreadPool *)fde->data.ptr;
-                BackgroundThreadJob *job = nullptr;
-                if(worker->pop(&job) == 0){
+                if(worker->pop_all(&background_jobs) == -1){
                     log_fatal("reading result from workers error!");
                     exit(0);
                 }
 
-				job->callback(this, fdes);
-                
-                if (job != nullptr) {
-                    delete job;
-                }
+				// links coming back from background jobs join reactors[0]
+				for(int j=0; j<(int)background_jobs.size(); j++){
+					BackgroundThreadJob *job = background_jobs[j];
+					job->callback(this, fdes);
+					delete job;
+				}
 
             } else{
-                proc_client_event(fde, &ready_list);
+                proc_client_event(r, fde, &ready_list);
             }
         }
 
 		for(it = ready_list.begin(); it != ready_list.end(); it ++){
 			Link *link = *it;
 			if(link->error()){
-				this->link_count --;
-				fdes->del(link->fd());
-				delete link;
-                link = NULL;
+				close_link(r, link);
 				continue;
 			}
-
-			const Request *req = link->recv();
-			if(req == NULL){
-				log_warn("fd: %d, link parse error, delete link", link->fd());
-                log_debug("error data length: %d  error data: %s", link->input->size(), hexmem(link->input->data(), link->input->size()).c_str());
-				this->link_count --;
-				fdes->del(link->fd());
-				delete link;
-                link = NULL;
-				continue;
-			}
-			if(req->empty()){
-				fdes->set(link->fd(), FDEVENT_IN, 1, link);
-                net_debug("fd: %d, req is empty ", link->fd());
-				continue;
-			}
-
-
-			link->active_time = millitime();
-
-			ProcJob *job = new ProcJob();
-			job->link = link;
-			job->link->context->net = this;
-			job->req = link->last_recv();
-			int result = this->proc(job);
-			if(result == PROC_THREAD){
-				if(log_level() >= Logger::LEVEL_DEBUG) {
-					log_debug("[receive] req: %s", serialize_req(*job->req).c_str());
-				}
-
-				fdes->del(link->fd());
-			}else if(result == PROC_BACKEND){
-				fdes->del(link->fd());
-				this->link_count --;
-				delete job;
-			}else{
-				if(proc_result(job, &ready_list_2) == PROC_ERROR){
-					//
-				}
-			}
+			proc_link(r, link, &ready_list_2);
 		} // end foreach ready link
 
 		double loop_time = millitime() - loop_stime;
@@ -503,27 +537,192 @@ Link* NetworkServer::accept_link(Link *l){
 	return link;
 }
 
-int NetworkServer::proc_result(ProcJob *job, ready_list_t *ready_list){
+void NetworkServer::close_link(NetworkReactor *r, Link *link){
+	this->link_count --;
+	r->fdes->del(link->fd());
+	for(int i=0; i<link->pipeline.size(); i++){
+		delete link->pipeline[i];
+	}
+	link->pipeline.clear();
+	delete link->pending;
+	link->pending = NULL;
+	delete link;
+}
+
+// write what is buffered, then wait for more input or, when requests are
+// left in the link, come back in the next round through ready_list
+int NetworkServer::flush_link(NetworkReactor *r, Link *link, ready_list_t *ready_list, bool more){
+	if(!link->output->empty()){
+		int len = link->write();
+		//log_debug("write: %d", len);
+		if(len < 0){
+			log_debug("fd: %d, write: %d, delete link", link->fd(), len);
+			close_link(r, link);
+			return PROC_ERROR;
+		}
+	}
+
+	if(!link->output->empty()){
+		r->fdes->set(link->fd(), FDEVENT_OUT, 1, link);
+	}
+	if(more){
+		r->fdes->clr(link->fd(), FDEVENT_IN);
+		ready_list->push_back(link);
+	}else{
+		r->fdes->set(link->fd(), FDEVENT_IN, 1, link);
+	}
+	return PROC_OK;
+}
+
+/*
+Parse up to pipeline_depth buffered requests of a link in one go:
+	not threaded => run in place, the reply goes straight to link->output
+	reads => one job per request, run concurrently by the readers
+	writes => one job carrying the whole run, so one writer keeps their order
+A batch holds reads or writes only, the first request of the other kind waits
+in link->pending. The link stays out of fdes until every job of the batch is
+back, proc_result() then appends the replies in request order. The first job
+replies into link->output itself, the others are detached.
+*/
+int NetworkServer::proc_link(NetworkReactor *r, Link *link, ready_list_t *ready_list){
+	std::vector<ProcJob *> &batch = link->pipeline;
+	int kind = 0;
+	bool more = false;
+
+	for(int n=0; ; n++){
+		if(n >= pipeline_depth){
+			more = true;
+			break;
+		}
+
+		ProcJob *job = link->pending;
+		link->pending = NULL;
+		if(job == NULL && recv_job(link, &job) == -1){
+			log_warn("fd: %d, link parse error, delete link", link->fd());
+			log_debug("error data length: %d  error data: %s", link->input->size(), hexmem(link->input->data(), link->input->size()).c_str());
+			close_link(r, link);
+			return PROC_ERROR;
+		}
+		if(job == NULL){
+			net_debug("fd: %d, req is empty ", link->fd());
+			break;
+		}
+		link->active_time = millitime();
+
+		Command *cmd = thread_cmd(job);
+		int flags = 0;
+		if(cmd != NULL){
+			flags = (cmd->flags & Command::FLAG_WRITE) ? Command::FLAG_WRITE : Command::FLAG_READ;
+		}
+		if(!batch.empty() && flags != kind){
+			link->pending = job;
+			break;
+		}
+
+		if(cmd == NULL){
+			int result = this->proc(job);
+			if(result == PROC_BACKEND){
+				r->fdes->del(link->fd());
+				this->link_count --;
+				delete job;
+				return PROC_BACKEND;
+			}
+			result = finish_job(job);
+			delete job;
+			if(result == PROC_ERROR){
+				close_link(r, link);
+				return PROC_ERROR;
+			}
+			continue;
+		}
+
+		if(log_level() >= Logger::LEVEL_DEBUG) {
+			log_debug("[receive] req: %s", serialize_req(*job->req).c_str());
+		}
+		job->cmd = cmd;
+		kind = flags;
+		batch.push_back(job);
+	}
+
+	if(batch.empty()){
+		return flush_link(r, link, ready_list, more);
+	}
+
+	// detach before anything is pushed, workers may touch link->context
+	double stime = millitime();
+	for(int i=0; i<batch.size(); i++){
+		batch[i]->stime = stime;
+		if(kind == Command::FLAG_READ && i > 0){
+			batch[i]->detach();
+		}
+	}
+
+	r->fdes->del(link->fd());
+	if(kind == Command::FLAG_WRITE){
+		ProcJob *head = batch[0];
+		head->batch.assign(batch.begin() + 1, batch.end());
+		link->in_flight = 1;
+		r->writer->push(head);
+	}else{
+		link->in_flight = (int)batch.size();
+		for(int i=0; i<batch.size(); i++){
+			r->reader->push(batch[i]);
+		}
+	}
+	return PROC_THREAD;
+}
+
+int NetworkServer::proc_result(NetworkReactor *r, ProcJob *job, ready_list_t *ready_list){
 	Link *link = job->link;
-	int result = job->result;
-			
+	if(--link->in_flight > 0){
+		return PROC_OK;
+	}
+
+	// the whole batch is back, replies go out in request order
+	int result = PROC_OK;
+	for(int i=0; i<link->pipeline.size(); i++){
+		ProcJob *j = link->pipeline[i];
+		if(result == PROC_OK){
+			result = finish_job(j);
+		}
+		if(result == PROC_OK && j->output != link->output){
+			if(link->output->append(j->output->data(), j->output->size()) == -1){
+				log_error("fd: %d, unable to resize output buffer!", link->fd());
+				result = PROC_ERROR;
+			}
+		}
+		delete j;
+	}
+	link->pipeline.clear();
+
+	if(result == PROC_ERROR){
+		close_link(r, link);
+		return PROC_ERROR;
+	}
+	return flush_link(r, link, ready_list, !link->input->empty() || link->pending != NULL);
+}
+
+int NetworkServer::finish_job(ProcJob *job){
 	if(log_level() >= Logger::LEVEL_DEBUG){
-        auto dreply = job->link->context->get_append_array();
+        auto dreply = job->ctx->get_append_array();
 		log_debug("[result] w:%.3f,p:%.3f, req: %s, resp: %s, dreply: %s",
 			job->time_wait, job->time_proc,
 			serialize_req(*job->req).c_str(),
 			serialize_req(job->resp.resp).c_str(),
 			serialize_req(dreply).c_str());
 	}
-	if(job->cmd){
-		job->cmd->calls += 1;
-		job->cmd->time_wait += job->time_wait;
-		job->cmd->time_proc += job->time_proc;
-	}
+	{
+		Locking<Mutex> l(&stats_mutex);
+		if(job->cmd){
+			job->cmd->calls += 1;
+			job->cmd->time_wait += job->time_wait;
+			job->cmd->time_proc += job->time_proc;
+		}
 
-	slowlog.pushEntryIfNeeded(job->req, (int64_t) job->time_proc);
+		slowlog.pushEntryIfNeeded(job->req, (int64_t) job->time_proc);
+	}
 
-	if(result == PROC_ERROR){
+	if(job->result == PROC_ERROR){
 
 		std::string error_cmd = "cmd: ";
 		for_each(job->req->begin(), job->req->end(), [&](Bytes b) {
@@ -537,39 +736,10 @@ int NetworkServer::proc_result(ProcJob *job, ready_list_t *ready_list){
 			error_cmd.append(" ");
 		});
 
-		log_info("fd: %d, proc error, delete link, %s", link->fd(), error_cmd.c_str());
-		delete job;
-		goto proc_err;
-	}
-
-	delete job;
-
-	if(!link->output->empty()){
-		int len = link->write();
-		//log_debug("write: %d", len);
-		if(len < 0){
-			log_debug("fd: %d, write: %d, delete link", link->fd(), len);
-			goto proc_err;
-		}
+		log_info("fd: %d, proc error, delete link, %s", job->link->fd(), error_cmd.c_str());
+		return PROC_ERROR;
 	}
-
-	if(!link->output->empty()){
-		fdes->set(link->fd(), FDEVENT_OUT, 1, link);
-	}
-	if(link->input->empty()){
-		fdes->set(link->fd(), FDEVENT_IN, 1, link);
-	}else{
-		fdes->clr(link->fd(), FDEVENT_IN);
-		ready_list->push_back(link);
-	}
-
 	return PROC_OK;
-
-proc_err:
-	this->link_count --;
-	fdes->del(link->fd());
-	delete link;
-	return PROC_ERROR;
 }
 
 /*
@@ -595,7 +765,7 @@ A link is in either one of these places:
 	2. async worker queue
 So it safe to delete link when processing ready list and async worker result.
 */
-int NetworkServer::proc_client_event(const Fdevent *fde, ready_list_t *ready_list){
+int NetworkServer::proc_client_event(NetworkReactor *r, const Fdevent *fde, ready_list_t *ready_list){
 	Link *link = (Link *)fde->data.ptr;
 	if(fde->events & FDEVENT_IN){
 		ready_list->push_back(link);
@@ -622,12 +792,63 @@ int NetworkServer::proc_client_event(const Fdevent *fde, ready_list_t *ready_lis
 			return 0;
 		}
 		if(link->output->empty()){
-			fdes->clr(link->fd(), FDEVENT_OUT);
+			r->fdes->clr(link->fd(), FDEVENT_OUT);
 		}
 	}
 	return 0;
 }
 
+int NetworkServer::recv_job(Link *link, ProcJob **job){
+	*job = NULL;
+	const Request *req = link->recv();
+	if(req == NULL){
+		return -1;
+	}
+	if(req->empty()){
+		return 0;
+	}
+
+	ProcJob *j = new ProcJob();
+	j->serv = this;
+	j->link = link;
+	j->ctx = link->context;
+	j->output = link->output;
+	link->context->net = this;
+
+	j->redis = link->detach_redis_req();
+	if(j->redis != NULL){
+		j->req_data = *req;
+	}else{
+		// ssdb protocol, req points into link->input which the next recv()
+		// may compact
+		j->req_buf.reserve(req->size());
+		j->req_data.reserve(req->size());
+		for(int i=0; i<req->size(); i++){
+			j->req_buf.push_back(req->at(i).String());
+		}
+		for(int i=0; i<j->req_buf.size(); i++){
+			j->req_data.push_back(Bytes(j->req_buf[i]));
+		}
+	}
+	j->req = &j->req_data;
+
+	*job = j;
+	return 1;
+}
+
+// the command job runs with in a worker, NULL when it runs in place
+Command* NetworkServer::thread_cmd(const ProcJob *job){
+	const Request *req = job->req;
+	if(this->need_auth && job->link->auth == false && req->at(0) != "auth"){
+		return NULL;
+	}
+	Command *cmd = proc_map.get_proc(req->at(0));
+	if(cmd == NULL || !(cmd->flags & Command::FLAG_THREAD)){
+		return NULL;
+	}
+	return cmd;
+}
+
 int NetworkServer::proc(ProcJob *job){
 	job->serv = this;
 	job->result = PROC_OK;
@@ -652,64 +873,18 @@ int NetworkServer::proc(ProcJob *job){
 		job->cmd = cmd;
 //		job->cmd->proc_after = proc_after_proc;
 
-		if(cmd->flags & Command::FLAG_THREAD){
-			if(cmd->flags & Command::FLAG_WRITE){
-				writer->push(job);
-			}else{
-				reader->push(job);
-			}
-			return PROC_THREAD;
-		}
-
 		proc_t p = cmd->proc;
 		job->time_wait = 1000 * (millitime() - job->stime);
-		job->link->context->reset();
-		job->result = (*p)(*job->link->context, job->link, *req, &job->resp);
+		job->ctx->reset();
+		job->result = (*p)(*job->ctx, job->link, *req, &job->resp);
 		job->time_proc = 1000 * (millitime() - job->stime) - job->time_wait;
 	}while(0);
 
-
-
-	if (job->resp.redisResponse != nullptr && job->link->redis != nullptr) {
-		// raw redis protocol
-		if(job->link->output->append(job->resp.redisResponse->toRedis()) == -1) {
-			log_debug("job->link->send error");
-			job->result = PROC_ERROR;
-
-			delete job->resp.redisResponse;
-			job->resp.redisResponse = nullptr;
-			return 0;
-		}
-
-		delete job->resp.redisResponse;
-		job->resp.redisResponse = nullptr;
-
-	} else {
-		if (job->resp.redisResponse != nullptr) {
-			delete job->resp.redisResponse;
-			job->resp.redisResponse = nullptr;
-		}
-
-		if(job->link->send(job->resp.resp) == -1){
-
-			log_debug("job->link->send error");
-			job->result = PROC_ERROR;
-			return 0;
-		}
-
+	if(job->reply() == -1){
+		log_debug("job->link->send error");
+		job->result = PROC_ERROR;
 	}
 
-	if (job->link->append_reply) {
-        if (!job->resp.resp.empty()) {
-            if(job->link->send_append_res(job->link->context->get_append_array()) == -1){
-                log_debug("job->link->send_append_res error");
-                job->result = PROC_ERROR;
-                return job->result;
-            }
-
-        }
-    }
-
 	return job->result;
 }
 
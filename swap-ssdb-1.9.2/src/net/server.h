@@ -9,6 +9,7 @@ found in the LICENSE file.
 #include "../include.h"
 #include <string>
 #include <vector>
+#include <atomic>
 #include <util/slowlog.h>
 
 #include "fde.h"
@@ -23,6 +24,20 @@ class Fdevents;
 
 typedef std::vector<Link *> ready_list_t;
 
+// an event loop thread with its own workers, it reads, parses and answers
+// the links it owns. reactor 0 runs in serve(), accepts new links and hands
+// them round robin to the others through their links queue
+struct NetworkReactor
+{
+	int id;
+	NetworkServer *serv;
+	pthread_t tid;
+	Fdevents *fdes;
+	ProcWorkerPool *reader;
+	ProcWorkerPool *writer;
+	SelectableQueue<Link *> links;
+};
+
 class NetworkServer
 {
 private:
@@ -32,21 +47,34 @@ private:
 	//Config *conf;
 	Link *serv_link;
 	Link *serv_socket;
-	Fdevents *fdes;
+	Fdevents *fdes;		// of reactors[0]
 
-	Link* accept_link(Link *link);
-	int proc_result(ProcJob *job, ready_list_t *ready_list);
-	int proc_client_event(const Fdevent *fde, ready_list_t *ready_list);
+	std::vector<NetworkReactor *> reactors;
+	int next_reactor = 0;
+
+	static void* _run_reactor(void *arg);
+	void run(NetworkReactor *r);
+	void add_link(NetworkReactor *r, Link *link);
 
+	Link* accept_link(Link *link);
+	void close_link(NetworkReactor *r, Link *link);
+	int flush_link(NetworkReactor *r, Link *link, ready_list_t *ready_list, bool more);
+	int proc_link(NetworkReactor *r, Link *link, ready_list_t *ready_list);
+	int proc_result(NetworkReactor *r, ProcJob *job, ready_list_t *ready_list);
+	int proc_client_event(NetworkReactor *r, const Fdevent *fde, ready_list_t *ready_list);
+
+	int recv_job(Link *link, ProcJob **job);
+	Command* thread_cmd(const ProcJob *job);
+	int finish_job(ProcJob *job);
 	int proc(ProcJob *job);
 
+	int num_reactors = 1;
 	int num_readers;
 	int num_writers;
 	int num_transfers = 5;
+	int num_transfer_batch = 64;
 	int num_background = 3;
-
-	ProcWorkerPool *writer;
-	ProcWorkerPool *reader;
+	int pipeline_depth = 64;
 
 	NetworkServer();
 
@@ -62,7 +90,7 @@ public:
 	IpFilter *ip_filter;
 	void *data;
 	ProcMap proc_map;
-	int link_count;
+	std::atomic<int> link_count;
 	bool need_auth;
 	std::string password;
 
@@ -73,6 +101,8 @@ public:
 	static NetworkServer* init(const Config &conf, int num_readers=-1, int num_writers=-1);
 	void serve();
 
+	// command stats and slowlog are updated by every reactor
+	Mutex stats_mutex;
 	Slowlog slowlog;
 
 };
@@ -3,7 +3,6 @@ Copyright (c) 2012-2014 The SSDB Authors. All rights reserved.
 Use of this source code is governed by a BSD-style license that can be
 found in the LICENSE file.
 */
-#include <net/redis/reponse_redis.h>
 #include "worker.h"
 #include "link.h"
 #include "../util/log.h"
@@ -17,62 +16,39 @@ void ProcWorker::init(){
 	log_debug("%s %d init", this->name.c_str(), this->id);
 }
 
-int ProcWorker::proc(ProcJob *job){
+static void proc_job(ProcJob *job){
 	const Request *req = job->req;
 
 	proc_t p = job->cmd->proc;
 	job->time_wait = 1000 * (millitime() - job->stime);
-	job->link->context->reset();
-	job->result = (*p)(*job->link->context, job->link, *req, &job->resp);
+	job->ctx->reset();
+	job->result = (*p)(*job->ctx, job->link, *req, &job->resp);
 	job->time_proc = 1000 * (millitime() - job->stime) - job->time_wait;
 
-
-	if (job->resp.redisResponse != nullptr && job->link->redis != nullptr) {
-		// raw redis protocol
-		if(job->link->output->append(job->resp.redisResponse->toRedis()) == -1) {
-			log_debug("job->link->send error");
-			job->result = PROC_ERROR;
-
-			delete job->resp.redisResponse;
-			job->resp.redisResponse = nullptr;
-			return 0;
-		}
-
-		delete job->resp.redisResponse;
-		job->resp.redisResponse = nullptr;
-
-	} else {
-		if (job->resp.redisResponse != nullptr) {
-			delete job->resp.redisResponse;
-			job->resp.redisResponse = nullptr;
-		}
-
-		if(job->link->send(job->resp.resp) == -1){
-
-			log_debug("job->link->send error");
-			job->result = PROC_ERROR;
-			return 0;
-		}
-
+	if(job->reply() == -1){
+		log_debug("job->link->send error");
+		job->result = PROC_ERROR;
 	}
+}
 
-
-	//todo append custom reply
-	if (job->link->append_reply) {
-		if (!job->resp.resp.empty()) {
-				if(job->link->send_append_res(job->link->context->get_append_array()) == -1){
-
-				log_debug("job->link->send_append_res error");
-				job->result = PROC_ERROR;
-				return 0;
-			}
-		}
+int ProcWorker::proc(ProcJob *job){
+	proc_job(job);
+	int result = job->result;
+	for(int i=0; i<job->batch.size() && result != PROC_ERROR; i++){
+		proc_job(job->batch[i]);
+		result = job->batch[i]->result;
+	}
+	if(result == PROC_ERROR){
+		return 0;
 	}
 
-	int len = job->link->write();
-	if(len < 0){
-		log_debug("job->link->write error");
-		job->result = PROC_ERROR;
+	// detached jobs are written out by the network thread in request order
+	if(job->output == job->link->output){
+		int len = job->link->write();
+		if(len < 0){
+			log_debug("job->link->write error");
+			job->result = PROC_ERROR;
+		}
 	}
 
 	return 0;
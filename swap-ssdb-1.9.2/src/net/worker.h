@@ -12,7 +12,7 @@ found in the LICENSE file.
 
 class Fdevents;
 
-// WARN: pipe latency is about 20 us, it is really slow!
+// results come back through an eventfd, one wakeup per burst of jobs
 class ProcWorker : public WorkerPool<ProcWorker, ProcJob *>::Worker{
 public:
 	explicit ProcWorker(const std::string &name);
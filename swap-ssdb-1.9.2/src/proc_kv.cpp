@@ -414,17 +414,18 @@ int proc_multi_get(Context &ctx, Link *link, const Request &req, Response *resp)
 	SSDBServer *serv = (SSDBServer *) ctx.net->data;
 	CHECK_NUM_PARAMS(2);
 
+	std::vector<std::string> vals;
+	std::vector<int> rets;
+	int ret = serv->ssdb->multi_get(ctx, req, 1, &vals, &rets);
+	if(ret < 0){
+		reply_err_return(ret);
+	}
+
 	resp->reply_list_ready();
 	for(int i=1; i<req.size(); i++){
-		std::string val;
-		int ret = serv->ssdb->get(ctx, req[i], &val);
-//		if(ret < 0){
-//			resp->resp.clear();
-//			reply_err_return(ret);
-//		}
-		if(ret == 1){
+		if(rets[i - 1] == 1){
 			resp->push_back(req[i].String());
-			resp->push_back(val);
+			resp->push_back(vals[i - 1]);
 		}
 	}
 	return 0;
@@ -579,6 +580,83 @@ int proc_keys(Context &ctx, Link *link, const Request &req, Response *resp){
 	return 0;
 }
 
+static int _parse_slot(const Bytes &arg, uint16_t *slot){
+	uint64_t v = arg.Uint64();
+	if (errno == EINVAL || v >= 16384){
+		return INVALID_INT;
+	}
+	*slot = (uint16_t) v;
+	return 0;
+}
+
+int proc_ssdb_slot_count(Context &ctx, Link *link, const Request &req, Response *resp){
+	SSDBServer *serv = (SSDBServer *) ctx.net->data;
+	CHECK_NUM_PARAMS(2);
+
+	uint16_t slot = 0;
+	int ret = _parse_slot(req[1], &slot);
+	if (ret < 0){
+		reply_err_return(ret);
+	}
+
+	uint64_t count = 0;
+	ret = serv->ssdb->slotcount(ctx, slot, &count);
+	if (ret < 0){
+		reply_err_return(ret);
+	}
+
+	resp->reply_int(0, count);
+	return 0;
+}
+
+int proc_ssdb_slot_keys(Context &ctx, Link *link, const Request &req, Response *resp){
+	SSDBServer *serv = (SSDBServer *) ctx.net->data;
+	CHECK_NUM_PARAMS(3);
+
+	uint16_t slot = 0;
+	int ret = _parse_slot(req[1], &slot);
+	if (ret < 0){
+		reply_err_return(ret);
+	}
+
+	uint64_t limit = req[2].Uint64();
+	if (errno == EINVAL){
+		reply_err_return(INVALID_INT);
+	}
+
+	std::vector<std::string> keys;
+	ret = serv->ssdb->slotkeys(ctx, slot, limit, keys);
+	if (ret < 0){
+		reply_err_return(ret);
+	}
+
+	resp->reply_list_ready();
+	for (auto &key : keys) {
+		resp->emplace_back(std::move(key));
+	}
+	return 0;
+}
+
+int proc_ssdb_slot_del(Context &ctx, Link *link, const Request &req, Response *resp){
+	SSDBServer *serv = (SSDBServer *) ctx.net->data;
+	CHECK_NUM_PARAMS(2);
+
+	uint16_t slot = 0;
+	int ret = _parse_slot(req[1], &slot);
+	if (ret < 0){
+		reply_err_return(ret);
+	}
+
+	uint64_t count = 0;
+	ret = serv->ssdb->slotdel(ctx, slot, &count);
+	if (ret < 0){
+		reply_err_return(ret);
+	}
+
+	resp->reply_int(0, count);
+	return 0;
+}
+
 // dir := +1|-1
 static int _incr(Context &ctx, SSDB *ssdb, const Request &req, Response *resp, int dir){
 	CHECK_NUM_PARAMS(2);
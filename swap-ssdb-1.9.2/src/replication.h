@@ -27,6 +27,7 @@ namespace leveldb{
 namespace rocksdb {
 #endif
     class Slice;
+    class Snapshot;
 
 }
 
@@ -38,6 +39,7 @@ const uint64_t MIN_PACKAGE_SIZE = 1024 * 1024;
 
 
 void *ssdb_sync2(void *arg);
+void *ssdb_sync2_range(void *arg);
 
 int replic_decode_len(const char *data, int *offset, uint64_t *lenptr);
 std::string replic_save_len(uint64_t len);
@@ -58,6 +60,15 @@ public:
 #define USE_SNAPPY true
 
 
+class ReplicRangeJob {
+public:
+    Context ctx;
+    Link *link = nullptr;
+    int64_t replTs = 0;
+    int index = 0;
+};
+
+
 class ReplicationByIterator2 : public BackgroundThreadJob {
 public:
     int64_t ts;
@@ -66,6 +77,10 @@ public:
 
     bool compress = true;
     bool heartbeat = false;
+    // number of key ranges sent in parallel, on slave side the number of ranges to receive
+    int parallel = 1;
+    // full sync by checkpoint files instead of key/values
+    bool checkpoint = false;
 
     volatile bool quit = false;
 
@@ -98,6 +113,15 @@ public:
     };
     int process() override;
 
+    int processParallel(const leveldb::Snapshot *snapshot, const std::vector<std::string> &bounds);
+    int sendRange(const leveldb::Snapshot *snapshot, int index, std::string start, std::string end);
+    int processCheckpoint(const std::string &dir);
+    int sendCheckpointFiles(Link *ssdb_slave_link, const std::string &dir, const std::vector<std::string> &files,
+                            uint64_t *sendBytes);
+    bool waitSenders(Link *master_link, std::vector<std::future<int>> &senders);
+    int finishTransfer(Link *ssdb_slave_link, bool brokenLink, bool transFailed, uint64_t *sendBytes);
+    void sendHeartbeat(Link *master_link, Fdevents *fdes);
+
     std::future<CompressResult> bg;
 
     int64_t replTs = 0;
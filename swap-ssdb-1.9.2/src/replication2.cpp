@@ -5,6 +5,7 @@ found in the LICENSE file.
 */
 #include "replication.h"
 #include "serv.h"
+#include <rocksdb/env.h>
 
 #ifdef USE_SNAPPY
 
@@ -21,6 +22,54 @@ static void moveBufferSync(Buffer *dst, Buffer *src, bool compress);
 
 static void moveBufferAsync(ReplicationByIterator2 *job, Buffer *dst, Buffer *input, bool compress);
 
+static bool sendCompleteToSlave(Link *ssdb_slave_link, uint64_t *sendBytes);
+
+/*
+ * pick up to parallel-1 split keys so that the ranges between them hold about
+ * the same amount of sst data. the keys only need to be ordered, they do not
+ * have to exist in the snapshot, data still in memtable just falls into
+ * whichever range covers it.
+ */
+static std::vector<std::string> splitRanges(leveldb::DB *db, int parallel) {
+    std::vector<std::string> bounds;
+    if (parallel <= 1) {
+        return bounds;
+    }
+
+    std::vector<leveldb::LiveFileMetaData> files;
+    db->GetLiveFilesMetaData(&files);
+
+    std::vector<std::pair<std::string, uint64_t>> starts;
+    uint64_t total = 0;
+    for (const auto &file : files) {
+        if (file.column_family_name == REPOPID_CF) {
+            continue;
+        }
+        starts.emplace_back(file.smallestkey, file.size);
+        total += file.size;
+    }
+    std::sort(starts.begin(), starts.end());
+
+    uint64_t visited = 0;
+    int next = 1;
+    for (const auto &start : starts) {
+        if (next >= parallel) {
+            break;
+        }
+        if (visited >= total * next / parallel) {
+            if (!start.first.empty() && (bounds.empty() || start.first > bounds.back())) {
+                bounds.push_back(start.first);
+            }
+            while (next < parallel && visited >= total * next / parallel) {
+                next++;
+            }
+        }
+        visited += start.second;
+    }
+
+    return bounds;
+}
+
 
 int ReplicationByIterator2::process() {
     log_info("ReplicationByIterator2::process");
@@ -29,11 +78,13 @@ int ReplicationByIterator2::process() {
     SSDBServer *serv = (SSDBServer *) ctx.net->data;
     Link *master_link = client_link;
     const leveldb::Snapshot *snapshot = nullptr;
+    std::string checkpoint_dir;
 
     log_info("[ReplicationByIterator2] send snapshot[%d] to %s start!", replTs, hnp.String().c_str());
     {
         Locking<Mutex> l(&serv->replicState.rMutex);
         snapshot = serv->replicState.rSnapshot;
+        checkpoint_dir = serv->replicState.rCheckpoint;
 
         if (snapshot == nullptr) {
             log_error("[ReplicationByIterator2] snapshot is null, maybe rr_make_snapshot not receive or error!");
@@ -42,12 +93,24 @@ int ReplicationByIterator2::process() {
         }
     }
 
+    if (!checkpoint_dir.empty()) {
+        return processCheckpoint(checkpoint_dir);
+    }
+
+    if (parallel > 1) {
+        std::vector<std::string> bounds = splitRanges(serv->ssdb->getLdb(), parallel);
+        if (!bounds.empty()) {
+            return processParallel(snapshot, bounds);
+        }
+        log_info("[ReplicationByIterator2] too few sst files to split, send snapshot over one link");
+    }
+
     leveldb::ReadOptions iterate_options;
     iterate_options.fill_cache = false;
     iterate_options.snapshot = snapshot;
     iterate_options.readahead_size = 4 * 1024 * 1024;
 
-    auto iterator_ptr = serv->ssdb->getLdb()->NewIterator(iterate_options);
+    auto iterator_ptr = serv->ssdb->newDataIterator(iterate_options);
     iterator_ptr->Seek("");
     std::unique_ptr<leveldb::Iterator> fit(iterator_ptr);
 
@@ -109,19 +172,8 @@ int ReplicationByIterator2::process() {
 
         if (heartbeat) {
             if ((ts - lastHeartBeat) > 5000) {
-                if (!master_link->output->empty()) {
-                    log_debug("[ReplicationByIterator2] master_link->output not empty , redis may blocked ?");
-                }
-
-                RedisResponse r("rr_transfer_snapshot continue");
-                master_link->output->append(Bytes(r.toRedis()));
-                if (master_link->append_reply) {
-                    master_link->send_append_res(std::vector<std::string>({"check 0"}));
-                }
+                sendHeartbeat(master_link, fdes.get());
                 lastHeartBeat = ts;
-                if (!master_link->output->empty()) {
-                    fdes->set(master_link->fd(), FDEVENT_OUT, 1, master_link);
-                }
             }
         }
 
@@ -297,36 +349,7 @@ int ReplicationByIterator2::process() {
         fdes->del(master_link->fd());
     }
 
-    bool transFailed = false;
-
-    {
-        //write "complete" to slave_ssdb
-        ssdb_slave_link->noblock(false);
-        saveStrToBuffer(ssdb_slave_link->output, "complete");
-        int len = ssdb_slave_link->write();
-        if (len > 0) { sendBytes = sendBytes + len; }
-
-        const std::vector<Bytes> *res = ssdb_slave_link->response();
-        if (res != nullptr && !res->empty()) {
-            std::string result = (*res)[0].String();
-
-            if (result == "failed" || result == "error") {
-                transFailed = true;
-            }
-
-            std::string ret;
-            for_each(res->begin(), res->end(), [&ret](const Bytes &h) {
-                ret.append(" ");
-                ret.append(hexstr(h));
-            });
-
-            log_info("[ReplicationByIterator2] %s~", ret.c_str());
-
-        } else {
-            transFailed = true;
-        }
-
-    }
+    bool transFailed = sendCompleteToSlave(ssdb_slave_link, &sendBytes);
 
 
     if (transFailed) {
@@ -359,6 +382,451 @@ int ReplicationByIterator2::process() {
 
 }
 
+int ReplicationByIterator2::processParallel(const leveldb::Snapshot *snapshot, const std::vector<std::string> &bounds) {
+    SSDBServer *serv = (SSDBServer *) ctx.net->data;
+    Link *master_link = client_link;
+    int ranges = (int) bounds.size() + 1;
+
+    log_info("[ReplicationByIterator2] send snapshot[%d] to %s in %d ranges", replTs, hnp.String().c_str(), ranges);
+    {
+        Locking<Mutex> l(&serv->replicState.rMutex);
+        serv->replicState.resetRanges(replTs, (size_t) ranges);
+        for (int i = 0; i < ranges; ++i) {
+            serv->replicState.ranges[i].start = (i == 0 ? "" : bounds[i - 1]);
+            serv->replicState.ranges[i].end = (i == ranges - 1 ? "" : bounds[i]);
+        }
+    }
+
+    Link *ssdb_slave_link = Link::connect((hnp.ip).c_str(), hnp.port);
+    if (ssdb_slave_link == nullptr) {
+        log_error("[ReplicationByIterator2] fail to connect to slave node %s!", hnp.String().c_str());
+        reportError();
+        return -1;
+    }
+
+    ssdb_slave_link->noblock(false);
+    std::vector<std::string> ssdb_sync_cmd({"ssdb_sync2", "replts", str(replTs), "ranges", str(ranges)});
+    if (heartbeat) {
+        ssdb_sync_cmd.emplace_back("heartbeat");
+        ssdb_sync_cmd.emplace_back("1");
+    }
+    ssdb_slave_link->send(ssdb_sync_cmd);
+    ssdb_slave_link->write();
+    const std::vector<Bytes> *res = ssdb_slave_link->response();
+    if (res == nullptr || res->empty() || (*res)[0] != "ok") {
+        log_error("[ReplicationByIterator2] slave node %s refused ssdb_sync2", hnp.String().c_str());
+        reportError();
+        delete ssdb_slave_link;
+        return -1;
+    }
+
+    int64_t start = time_ms();
+
+    std::vector<std::future<int>> senders;
+    for (int i = 0; i < ranges; ++i) {
+        senders.emplace_back(std::async(std::launch::async, &ReplicationByIterator2::sendRange, this, snapshot, i,
+                                        (i == 0 ? std::string() : bounds[i - 1]),
+                                        (i == ranges - 1 ? std::string() : bounds[i])));
+    }
+
+    bool brokenLink = waitSenders(master_link, senders);
+
+    bool transFailed = brokenLink;
+    for (auto &sender : senders) {
+        if (sender.get() != 0) {
+            transFailed = true;
+        }
+    }
+
+    uint64_t rawBytes = 0;
+    uint64_t sendBytes = 0;
+    {
+        Locking<Mutex> l(&serv->replicState.rMutex);
+        for (const auto &range : serv->replicState.ranges) {
+            rawBytes += range.bytes;
+        }
+    }
+
+    if (finishTransfer(ssdb_slave_link, brokenLink, transFailed, &sendBytes) != 0) {
+        return -1;
+    }
+
+    log_info("[ReplicationByIterator2] send snapshot[%d] to %s finished!", replTs, hnp.String().c_str());
+    log_info("[ReplicationByIterator2] task stats : ranges %d, dataSize %s, elapsed %s",
+             ranges,
+             bytesToHuman(rawBytes).c_str(),
+             timestampToHuman((time_ms() - start)).c_str()
+    );
+    return 0;
+}
+
+int ReplicationByIterator2::processCheckpoint(const std::string &dir) {
+    SSDBServer *serv = (SSDBServer *) ctx.net->data;
+    Link *master_link = client_link;
+
+    std::vector<std::string> children;
+    leveldb::Status s = leveldb::Env::Default()->GetChildren(dir, &children);
+    if (!s.ok()) {
+        log_error("[ReplicationByIterator2] list checkpoint %s error: %s", dir.c_str(), s.ToString().c_str());
+        reportError();
+        return -1;
+    }
+    std::vector<std::string> files;
+    for (const auto &child : children) {
+        if (child != "." && child != "..") {
+            files.push_back(child);
+        }
+    }
+
+    log_info("[ReplicationByIterator2] send checkpoint[%d] to %s, %d files", replTs, hnp.String().c_str(),
+             (int) files.size());
+
+    Link *ssdb_slave_link = Link::connect((hnp.ip).c_str(), hnp.port);
+    if (ssdb_slave_link == nullptr) {
+        log_error("[ReplicationByIterator2] fail to connect to slave node %s!", hnp.String().c_str());
+        reportError();
+        return -1;
+    }
+
+    ssdb_slave_link->noblock(false);
+    std::vector<std::string> ssdb_sync_cmd({"ssdb_sync2", "replts", str(replTs), "checkpoint", "1"});
+    if (heartbeat) {
+        ssdb_sync_cmd.emplace_back("heartbeat");
+        ssdb_sync_cmd.emplace_back("1");
+    }
+    ssdb_slave_link->send(ssdb_sync_cmd);
+    ssdb_slave_link->write();
+    const std::vector<Bytes> *res = ssdb_slave_link->response();
+    if (res == nullptr || res->empty() || (*res)[0] != "ok") {
+        log_error("[ReplicationByIterator2] slave node %s refused ssdb_sync2", hnp.String().c_str());
+        reportError();
+        delete ssdb_slave_link;
+        return -1;
+    }
+
+    int64_t start = time_ms();
+    uint64_t sendBytes = 0;
+
+    std::vector<std::future<int>> senders;
+    senders.emplace_back(std::async(std::launch::async, [&]() {
+        return sendCheckpointFiles(ssdb_slave_link, dir, files, &sendBytes);
+    }));
+
+    bool brokenLink = waitSenders(master_link, senders);
+    bool transFailed = brokenLink;
+    for (auto &sender : senders) {
+        if (sender.get() != 0) {
+            transFailed = true;
+        }
+    }
+
+    if (finishTransfer(ssdb_slave_link, brokenLink, transFailed, &sendBytes) != 0) {
+        return -1;
+    }
+
+    double elapsed = (time_ms() - start) * 1.0 / 1000.0 + 0.0000001;
+    log_info("[ReplicationByIterator2] send checkpoint[%d] to %s finished!", replTs, hnp.String().c_str());
+    log_info("[ReplicationByIterator2] task stats : files %d, sendByes %s, elapsed %s, speed %s/s",
+             (int) files.size(),
+             bytesToHuman(sendBytes).c_str(),
+             timestampToHuman((time_ms() - start)).c_str(),
+             bytesToHuman((int64_t) (sendBytes / elapsed)).c_str()
+    );
+    return 0;
+}
+
+/*
+ * sst files are already compressed, they are sent as they are in
+ * "file" packages : name, chunk
+ */
+int ReplicationByIterator2::sendCheckpointFiles(Link *ssdb_slave_link, const std::string &dir,
+                                                const std::vector<std::string> &files, uint64_t *sendBytes) {
+    std::string chunk(MAX_PACKAGE_SIZE, '\0');
+
+    for (const auto &name : files) {
+        std::string path = dir + "/" + name;
+        FILE *fp = fopen(path.c_str(), "rb");
+        if (fp == nullptr) {
+            log_error("[ReplicationByIterator2] open %s error: %s", path.c_str(), strerror(errno));
+            return -1;
+        }
+
+        bool first = true;
+        while (!quit) {
+            size_t n = fread(&chunk[0], 1, chunk.size(), fp);
+            if (n == 0 && ferror(fp)) {
+                log_error("[ReplicationByIterator2] read %s error", path.c_str());
+                fclose(fp);
+                return -1;
+            }
+            if (n == 0 && !first) {
+                break;
+            }
+            first = false;
+
+            saveStrToBuffer(ssdb_slave_link->output, "file");
+            saveStrToBuffer(ssdb_slave_link->output, name);
+            saveStrToBuffer(ssdb_slave_link->output, Bytes(chunk.data(), (int) n));
+            int len = ssdb_slave_link->flush();
+            if (len < 0) {
+                log_error("[ReplicationByIterator2] link to slave node broken");
+                fclose(fp);
+                return -1;
+            }
+            *sendBytes += len;
+        }
+        fclose(fp);
+
+        if (quit) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * senders block on their own links, this loop only keeps the link to redis
+ * alive until all of them return. returns true if the link to redis broke.
+ */
+bool ReplicationByIterator2::waitSenders(Link *master_link, std::vector<std::future<int>> &senders) {
+    unique_ptr<Fdevents> fdes = unique_ptr<Fdevents>(new Fdevents());
+    fdes->set(master_link->fd(), FDEVENT_IN, 1, master_link);
+    master_link->noblock(true);
+
+    int64_t lastHeartBeat = time_ms();
+    bool brokenLink = false;
+    while (true) {
+        int64_t ts = time_ms();
+        if (heartbeat && (ts - lastHeartBeat) > 5000) {
+            sendHeartbeat(master_link, fdes.get());
+            lastHeartBeat = ts;
+        }
+
+        const Fdevents::events_t *events = fdes->wait(50);
+        if (events == nullptr) {
+            log_fatal("[ReplicationByIterator2] events.wait error: %s", strerror(errno));
+            brokenLink = true;
+        } else {
+            for (int i = 0; i < (int) events->size(); i++) {
+                const Fdevent *fde = events->at(i);
+                if ((fde->events & FDEVENT_IN) && master_link->read() <= 0) {
+                    master_link->mark_error();
+                }
+                if (fde->events & FDEVENT_OUT) {
+                    if (!master_link->output->empty() && master_link->write() <= 0) {
+                        master_link->mark_error();
+                    }
+                    if (master_link->output->empty()) {
+                        fdes->clr(master_link->fd(), FDEVENT_OUT);
+                    }
+                }
+            }
+            if (master_link->error()) {
+                log_info("[ReplicationByIterator2] link to redis broken");
+                brokenLink = true;
+            }
+        }
+
+        if (brokenLink) {
+            quit = true;
+            break;
+        }
+
+        bool finished = true;
+        for (auto &sender : senders) {
+            if (sender.wait_for(std::chrono::milliseconds(0)) != std::future_status::ready) {
+                finished = false;
+                break;
+            }
+        }
+        if (finished) {
+            break;
+        }
+    }
+
+    fdes->del(master_link->fd());
+    return brokenLink;
+}
+
+/*
+ * tail of a transfer whose data went through sender threads, sends
+ * "complete" if all of them succeeded and updates replic stats.
+ * ssdb_slave_link is deleted here.
+ */
+int ReplicationByIterator2::finishTransfer(Link *ssdb_slave_link, bool brokenLink, bool transFailed,
+                                           uint64_t *sendBytes) {
+    SSDBServer *serv = (SSDBServer *) ctx.net->data;
+
+    if (brokenLink) {
+        send_error_to_redis(client_link);
+        delete client_link;
+        client_link = nullptr;
+        delete ssdb_slave_link;
+
+        Locking<Mutex> l(&serv->replicState.rMutex);
+        serv->replicState.finishReplic(false);
+        return -1;
+    }
+
+    if (!transFailed) {
+        // everything sent has been acked by the slave, let it finish the transfer
+        transFailed = sendCompleteToSlave(ssdb_slave_link, sendBytes);
+    }
+    delete ssdb_slave_link;
+
+    if (transFailed) {
+        reportError();
+        log_info("[ReplicationByIterator2] send snapshot to %s failed!!!!", hnp.String().c_str());
+        return -1;
+    }
+
+    {
+        Locking<Mutex> l(&serv->replicState.rMutex);
+        serv->replicState.finishReplic(true);
+    }
+    return 0;
+}
+
+int ReplicationByIterator2::sendRange(const leveldb::Snapshot *snapshot, int index, std::string start, std::string end) {
+    SSDBServer *serv = (SSDBServer *) ctx.net->data;
+
+    auto setState = [&](uint64_t keys, uint64_t bytes, int state) {
+        Locking<Mutex> l(&serv->replicState.rMutex);
+        serv->replicState.updateRange(index, keys, bytes, state);
+    };
+
+    std::unique_ptr<Link> link(Link::connect((hnp.ip).c_str(), hnp.port));
+    if (!link) {
+        log_error("[ReplicationByIterator2] range %d fail to connect to slave node %s!", index, hnp.String().c_str());
+        setState(0, 0, ReplicRange::FAILED);
+        return -1;
+    }
+
+    link->noblock(false);
+    link->send(std::vector<std::string>({"ssdb_sync2_range", "replts", str(replTs), "range", str(index)}));
+    link->write();
+    const std::vector<Bytes> *res = link->response();
+    if (res == nullptr || res->empty() || (*res)[0] != "ok") {
+        log_error("[ReplicationByIterator2] slave node %s refused range %d", hnp.String().c_str(), index);
+        setState(0, 0, ReplicRange::FAILED);
+        return -1;
+    }
+
+    leveldb::ReadOptions iterate_options;
+    iterate_options.fill_cache = false;
+    iterate_options.snapshot = snapshot;
+    iterate_options.readahead_size = 4 * 1024 * 1024;
+    leveldb::Slice upper_bound(end);
+    if (!end.empty()) {
+        iterate_options.iterate_upper_bound = &upper_bound;
+    }
+
+    std::unique_ptr<leveldb::Iterator> it(serv->ssdb->newDataIterator(iterate_options));
+
+    // every range owns its buffer and compresses it on its own thread
+    Buffer buffer(MAX_PACKAGE_SIZE);
+    uint64_t packageSize = compress ? MAX_PACKAGE_SIZE : MIN_PACKAGE_SIZE;
+    uint64_t keys = 0;
+    uint64_t rawBytes = 0;
+    uint64_t sendBytes = 0;
+
+    setState(keys, rawBytes, ReplicRange::TRANS);
+
+    for (it->Seek(start); it->Valid() && !quit; it->Next()) {
+        saveStrToBufferQuick(&buffer, it->key());
+        saveStrToBufferQuick(&buffer, it->value());
+        keys++;
+
+        if (buffer.size() > packageSize) {
+            rawBytes += buffer.size();
+            moveBufferSync(link->output, &buffer, compress);
+            int len = link->flush();
+            if (len < 0) {
+                log_error("[ReplicationByIterator2] range %d link to slave node broken", index);
+                setState(keys, rawBytes, ReplicRange::FAILED);
+                return -1;
+            }
+            sendBytes += len;
+            setState(keys, rawBytes, ReplicRange::TRANS);
+        }
+    }
+
+    if (quit || !it->status().ok()) {
+        log_error("[ReplicationByIterator2] range %d stopped: %s", index, it->status().ToString().c_str());
+        setState(keys, rawBytes, ReplicRange::FAILED);
+        return -1;
+    }
+
+    if (!buffer.empty()) {
+        rawBytes += buffer.size();
+        moveBufferSync(link->output, &buffer, compress);
+        int len = link->flush();
+        if (len < 0) {
+            setState(keys, rawBytes, ReplicRange::FAILED);
+            return -1;
+        }
+        sendBytes += len;
+    }
+
+    if (sendCompleteToSlave(link.get(), &sendBytes)) {
+        setState(keys, rawBytes, ReplicRange::FAILED);
+        return -1;
+    }
+
+    setState(keys, rawBytes, ReplicRange::DONE);
+    log_info("[ReplicationByIterator2] range %d done : keys %llu, dataSize %s, sendBytes %s",
+             index, keys, bytesToHuman(rawBytes).c_str(), bytesToHuman(sendBytes).c_str());
+    return 0;
+}
+
+void ReplicationByIterator2::sendHeartbeat(Link *master_link, Fdevents *fdes) {
+    if (!master_link->output->empty()) {
+        log_debug("[ReplicationByIterator2] master_link->output not empty , redis may blocked ?");
+    }
+
+    RedisResponse r("rr_transfer_snapshot continue");
+    r.toRedis(master_link->output);
+    if (master_link->append_reply) {
+        master_link->send_append_res(std::vector<std::string>({"check 0"}));
+    }
+    if (!master_link->output->empty()) {
+        fdes->set(master_link->fd(), FDEVENT_OUT, 1, master_link);
+    }
+}
+
+bool sendCompleteToSlave(Link *ssdb_slave_link, uint64_t *sendBytes) {
+    bool transFailed = false;
+
+    //write "complete" to slave_ssdb
+    ssdb_slave_link->noblock(false);
+    saveStrToBuffer(ssdb_slave_link->output, "complete");
+    int len = ssdb_slave_link->flush();
+    if (len > 0) { *sendBytes = *sendBytes + len; }
+
+    const std::vector<Bytes> *res = ssdb_slave_link->response();
+    if (res != nullptr && !res->empty()) {
+        std::string result = (*res)[0].String();
+
+        if (result == "failed" || result == "error") {
+            transFailed = true;
+        }
+
+        std::string ret;
+        for_each(res->begin(), res->end(), [&ret](const Bytes &h) {
+            ret.append(" ");
+            ret.append(hexstr(h));
+        });
+
+        log_info("[ReplicationByIterator2] %s~", ret.c_str());
+
+    } else {
+        transFailed = true;
+    }
+
+    return transFailed;
+}
+
 void ReplicationByIterator2::saveStrToBufferQuick(Buffer *buffer, const Bytes &fit) {
     auto fit_size = fit.size();
     if (fit_size < quickmap_size) {
@@ -6,6 +6,7 @@ found in the LICENSE file.
 
 #include "replication.h"
 #include "serv.h"
+#include <functional>
 #ifdef USE_SNAPPY
 
 #include <snappy.h>
@@ -17,44 +18,44 @@ extern "C" {
 #endif
 
 
-void *ssdb_sync2(void *arg) {
-
-    ReplicationByIterator2 *job = (ReplicationByIterator2 *) arg;
-    Context ctx = job->ctx;
-    SSDBServer *serv = (SSDBServer *) ctx.net->data;
-    HostAndPort hnp = job->hnp;
-    std::unique_ptr<Link> master_link(job->client_link); //upstream cannot be null !
-    bool heartbeat = job->heartbeat;
-    bool quit = job->quit;
-    int64_t replTs = job->replTs;
-
-    delete job;
-    job = nullptr;
-
-    std::string upstream_ip = serv->opt.upstream_ip;
-    int upstream_port = serv->opt.upstream_port;
-    RedisUpstream redisUpstream(upstream_ip, upstream_port, 500);
+/*
+ * append a "file" package to file_dir/name, files arrive one after another
+ * so only the current one is kept open
+ */
+static int recv_file_chunk(const std::string &file_dir, const std::string &name, const char *data, size_t size,
+                           FILE **fp, std::string *current) {
+    if (file_dir.empty() || name.empty() || name.find('/') != std::string::npos) {
+        log_error("unexpected file package %s", name.c_str());
+        return -1;
+    }
 
-    if (heartbeat) {
-        log_info("[ssdb_sync2] sending heartbeat to upstream");
-        redisUpstream.setMaxRetry(1);
-        redisUpstream.reset();
-        if (!redisUpstream.isConnected()) {
-            log_warn("cannot connect to redis");
-        } else {
-            std::unique_ptr<RedisResponse> t_res(
-                    redisUpstream.sendCommand({"ssdb-notify-redis", "transfer", "continue", str(replTs)}));
-            if (!t_res) {
-                log_warn("send transfer continue to redis<%s:%d> failed", upstream_ip.c_str(), upstream_port);
-            }
+    if (*fp == nullptr || *current != name) {
+        if (*fp != nullptr) {
+            fclose(*fp);
         }
-
-    } else {
-        log_warn("[ssdb_sync2] heartbeat disabled");
+        std::string path = file_dir + name;
+        *fp = fopen(path.c_str(), "ab");
+        if (*fp == nullptr) {
+            log_error("open %s error: %s", path.c_str(), strerror(errno));
+            return -1;
+        }
+        *current = name;
     }
 
-    log_info("[ssdb_sync2] current snapshot transfer timestamp id : %d", replTs);
+    if (size > 0 && fwrite(data, 1, size, *fp) != size) {
+        log_error("write %s error: %s", name.c_str(), strerror(errno));
+        return -1;
+    }
+    return 0;
+}
 
+/*
+ * receive "mset" packages from snapshot_link and write them with a few parse_replic
+ * workers until "complete" arrives, range >= 0 reports progress of that range.
+ * "file" packages are written into file_dir.
+ */
+static int recv_snapshot(Context &ctx, SSDBServer *serv, Link *snapshot_link, const std::function<void()> &tick, int range,
+                         const std::string &file_dir) {
     size_t total_threads = 5;
     size_t current_thread = 0;
 
@@ -67,40 +68,11 @@ void *ssdb_sync2(void *arg) {
     std::vector<std::future<int>> bgs(total_threads);
 //    std::future<int> bg;
 
-    log_warn("[ssdb_sync2] update transfer state");
-    {
-        Locking<Mutex> l(&serv->replicState.rMutex);
-
-        if (serv->replicState.inTransState()) {
-            log_fatal("i am in transferring state, should not into this step!!!!!!");
-        }
-
-        serv->replicState.startReplic();
-    }
-
-    log_info("[ssdb_sync2] expiration stop");
-    if (serv->ssdb->expiration) {
-        serv->ssdb->expiration->stop();
-    }
-
-    log_info("[ssdb_sync2] ssdb stop");
-    serv->ssdb->stop();
-
-    log_info("[ssdb_sync2] do flushdb");
-    serv->ssdb->flushdb(ctx);
-    serv->ssdb->resetRepopid(ctx);
-
-
-    log_info("[ssdb_sync2] ready to receive snapshot %d", replTs);
-    master_link->quick_send({"ok", "ready to receive"});
-
-
-    log_info("[ssdb_sync2] prepare for event loop");
 
     unique_ptr<Fdevents> fdes = unique_ptr<Fdevents>(new Fdevents());
 
-    fdes->set(master_link->fd(), FDEVENT_IN, 1, master_link.get()); //open evin
-    master_link->noblock(true);
+    fdes->set(snapshot_link->fd(), FDEVENT_IN, 1, snapshot_link); //open evin
+    snapshot_link->noblock(true);
 
 
     const Fdevents::events_t *events;
@@ -111,27 +83,20 @@ void *ssdb_sync2(void *arg) {
     int errorCode = 0;
 
 
-    int64_t lastHeartBeat = time_ms();
+    bool quit = false;
+    uint64_t keys = 0;
+    uint64_t bytes = 0;
+    FILE *fp = nullptr;
+    std::string current_file;
     while (!quit) {
         ready_list.swap(ready_list_2);
         ready_list_2.clear();
 
 
-        if (heartbeat) {
-            if ((time_ms() - lastHeartBeat) > 3000) {
-
-                std::unique_ptr<RedisResponse> t_res(
-                        redisUpstream.sendCommand({"ssdb-notify-redis", "transfer", "continue", str(replTs)}));
-                if (!t_res) {
-                    log_warn("send transfer continue to redis<%s:%d> failed", upstream_ip.c_str(), upstream_port);
-                }
-
-                lastHeartBeat = time_ms();
-
-            }
+        if (tick) {
+            tick();
         }
 
-
         if (!ready_list.empty()) {
             events = fdes->wait(0);
         } else {
@@ -324,6 +289,13 @@ void *ssdb_sync2(void *arg) {
                     decoder.skip(compressed_len);
                     link->input->decr(link->input->size() - decoder.size());
 
+                    if (range >= 0) {
+                        keys += kvs.size() / 2;
+                        bytes += raw_len;
+                        Locking<Mutex> l(&serv->replicState.rMutex);
+                        serv->replicState.updateRange(range, keys, bytes, ReplicRange::TRANS);
+                    }
+
                     if (!kvs.empty()) {
 
                         int tid = get_thread_id();
@@ -351,6 +323,45 @@ void *ssdb_sync2(void *arg) {
 
                     }
 
+                } else if (oper == "file") {
+                    int name_offset = 0, data_offset = 0;
+                    uint64_t name_len = 0, data_len = 0;
+
+                    if (decoder.size() < 1) {
+                        link->input->grow();
+                        break;
+                    }
+                    if (replic_decode_len(decoder.data(), &name_offset, &name_len) == -1) {
+                        errorCode = -3;
+                        break;
+                    }
+                    if (decoder.size() < (int) (name_offset + name_len + 1)) {
+                        link->input->grow();
+                        break;
+                    }
+                    decoder.skip(name_offset);
+                    std::string name(decoder.data(), name_len);
+                    decoder.skip((int) name_len);
+
+                    if (replic_decode_len(decoder.data(), &data_offset, &data_len) == -1) {
+                        errorCode = -3;
+                        break;
+                    }
+                    if (decoder.size() < (int) (data_offset + data_len)) {
+                        link->input->grow();
+                        break;
+                    }
+                    decoder.skip(data_offset);
+
+                    if (recv_file_chunk(file_dir, name, decoder.data(), data_len, &fp, &current_file) != 0) {
+                        errorCode = -7;
+                        break;
+                    }
+                    decoder.skip((int) data_len);
+                    link->input->decr(link->input->size() - decoder.size());
+
+                    bytes += data_len;
+
                 } else if (oper == "complete") {
                     link->input->decr(link->input->size() - decoder.size());
                     quit = true;
@@ -375,7 +386,138 @@ void *ssdb_sync2(void *arg) {
 
     for (int tid = 0; tid < bgs.size(); ++tid) {
         if (bgs[tid].valid()) {
-            errorCode = bgs[tid].get();
+            int ret = bgs[tid].get();
+            if (errorCode == 0) {
+                errorCode = ret;
+            }
+        }
+    }
+
+    if (fp != nullptr && fclose(fp) != 0 && errorCode == 0) {
+        log_error("close %s error: %s", current_file.c_str(), strerror(errno));
+        errorCode = -7;
+    }
+
+    return errorCode;
+}
+
+void *ssdb_sync2(void *arg) {
+
+    ReplicationByIterator2 *job = (ReplicationByIterator2 *) arg;
+    Context ctx = job->ctx;
+    SSDBServer *serv = (SSDBServer *) ctx.net->data;
+    HostAndPort hnp = job->hnp;
+    std::unique_ptr<Link> master_link(job->client_link); //upstream cannot be null !
+    bool heartbeat = job->heartbeat;
+    int parallel = job->parallel;
+    bool checkpoint = job->checkpoint;
+    int64_t replTs = job->replTs;
+
+    delete job;
+    job = nullptr;
+
+    std::string upstream_ip = serv->opt.upstream_ip;
+    int upstream_port = serv->opt.upstream_port;
+    RedisUpstream redisUpstream(upstream_ip, upstream_port, 500);
+
+    if (heartbeat) {
+        log_info("[ssdb_sync2] sending heartbeat to upstream");
+        redisUpstream.setMaxRetry(1);
+        redisUpstream.reset();
+        if (!redisUpstream.isConnected()) {
+            log_warn("cannot connect to redis");
+        } else {
+            std::unique_ptr<RedisResponse> t_res(
+                    redisUpstream.sendCommand({"ssdb-notify-redis", "transfer", "continue", str(replTs)}));
+            if (!t_res) {
+                log_warn("send transfer continue to redis<%s:%d> failed", upstream_ip.c_str(), upstream_port);
+            }
+        }
+
+    } else {
+        log_warn("[ssdb_sync2] heartbeat disabled");
+    }
+
+    log_info("[ssdb_sync2] current snapshot transfer timestamp id : %d", replTs);
+
+    log_warn("[ssdb_sync2] update transfer state");
+    {
+        Locking<Mutex> l(&serv->replicState.rMutex);
+
+        if (serv->replicState.inTransState()) {
+            log_fatal("i am in transferring state, should not into this step!!!!!!");
+        }
+
+        serv->replicState.startReplic();
+        serv->replicState.resetRanges(replTs, (size_t) (parallel > 1 ? parallel : 0));
+    }
+
+    log_info("[ssdb_sync2] expiration stop");
+    if (serv->ssdb->expiration) {
+        serv->ssdb->expiration->stop();
+    }
+
+    log_info("[ssdb_sync2] ssdb stop");
+    serv->ssdb->stop();
+
+    std::string sync_dir;
+    if (checkpoint) {
+        // the data dir is replaced once all files arrived, keep serving the old one until then
+        sync_dir = serv->ssdb->getSyncPath();
+        log_info("[ssdb_sync2] receive checkpoint into %s", sync_dir.c_str());
+        serv->ssdb->removeDir(sync_dir);
+        if (mkdir(sync_dir.c_str(), 0755) != 0) {
+            log_error("[ssdb_sync2] mkdir %s error: %s", sync_dir.c_str(), strerror(errno));
+        }
+    } else {
+        log_info("[ssdb_sync2] do flushdb");
+        serv->ssdb->flushdb(ctx);
+        serv->ssdb->resetRepopid(ctx);
+    }
+
+
+    log_info("[ssdb_sync2] ready to receive snapshot %d", replTs);
+    master_link->quick_send({"ok", "ready to receive"});
+
+    int64_t lastHeartBeat = time_ms();
+    auto heartbeatFn = [&]() {
+        if (heartbeat) {
+            if ((time_ms() - lastHeartBeat) > 3000) {
+
+                std::unique_ptr<RedisResponse> t_res(
+                        redisUpstream.sendCommand({"ssdb-notify-redis", "transfer", "continue", str(replTs)}));
+                if (!t_res) {
+                    log_warn("send transfer continue to redis<%s:%d> failed", upstream_ip.c_str(), upstream_port);
+                }
+
+                lastHeartBeat = time_ms();
+
+            }
+        }
+    };
+
+    log_info("[ssdb_sync2] prepare for event loop, ranges %d", parallel);
+    // with ranges the data arrives on ssdb_sync2_range links, master_link only carries "complete"
+    int errorCode = recv_snapshot(ctx, serv, master_link.get(), heartbeatFn, -1, sync_dir);
+
+    if (checkpoint) {
+        if (errorCode == 0) {
+            log_info("[ssdb_sync2] open received checkpoint");
+            errorCode = serv->ssdb->reopen(ctx, sync_dir);
+            serv->ssdb->resetRepopid(ctx);
+        } else {
+            serv->ssdb->removeDir(sync_dir);
+        }
+    }
+
+    if (errorCode == 0 && parallel > 1) {
+        // master sends complete only after all ranges were acked, any range not done means a broken transfer
+        Locking<Mutex> l(&serv->replicState.rMutex);
+        for (const auto &range : serv->replicState.ranges) {
+            if (range.state != ReplicRange::DONE) {
+                errorCode = -6;
+                break;
+            }
         }
     }
 
@@ -432,3 +574,41 @@ void *ssdb_sync2(void *arg) {
     return (void *) NULL;
 }
 
+void *ssdb_sync2_range(void *arg) {
+
+    ReplicRangeJob *job = (ReplicRangeJob *) arg;
+    Context ctx = job->ctx;
+    SSDBServer *serv = (SSDBServer *) ctx.net->data;
+    std::unique_ptr<Link> range_link(job->link);
+    int64_t replTs = job->replTs;
+    int index = job->index;
+
+    delete job;
+    job = nullptr;
+
+    log_info("[ssdb_sync2_range] ready to receive range %d of snapshot %d", index, replTs);
+    {
+        Locking<Mutex> l(&serv->replicState.rMutex);
+        serv->replicState.updateRange(index, 0, 0, ReplicRange::TRANS);
+    }
+    range_link->quick_send({"ok", "ready to receive range"});
+
+    int errorCode = recv_snapshot(ctx, serv, range_link.get(), nullptr, index, "");
+
+    {
+        Locking<Mutex> l(&serv->replicState.rMutex);
+        if (index < (int) serv->replicState.ranges.size()) {
+            serv->replicState.ranges[index].state = (errorCode == 0 ? ReplicRange::DONE : ReplicRange::FAILED);
+        }
+    }
+
+    if (errorCode != 0) {
+        range_link->quick_send({"error", "recieve range failed!"});
+        log_error("[ssdb_sync2_range] recieve range %d failed!, err: %d", index, errorCode);
+    } else {
+        range_link->quick_send({"ok", "recieve range finished"});
+        log_info("[ssdb_sync2_range] recieve range %d finished!", index);
+    }
+
+    return (void *) NULL;
+}
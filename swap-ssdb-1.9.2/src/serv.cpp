@@ -12,6 +12,7 @@ found in the LICENSE file.
 #include "net/server.h"
 #include "replication.h"
 #include <sys/utsname.h>
+#include <rocksdb/env.h>
 
 extern "C" {
 #include "redis/zmalloc.h"
@@ -237,8 +238,21 @@ DEF_PROC(ssdb_scan);
 
 DEF_PROC(ssdb_dbsize);
 
+DEF_PROC(ssdb_slot_count);
+
+DEF_PROC(ssdb_slot_keys);
+
+DEF_PROC(ssdb_slot_del);
+
+DEF_PROC(ssdb_migrate_slots);
+
+DEF_PROC(ssdb_sst_recv);
+
+DEF_PROC(ssdb_sst_ingest);
+
 
 DEF_PROC(ssdb_sync2);
+DEF_PROC(ssdb_sync2_range);
 
 DEF_PROC(redis_req_dump);
 
@@ -263,9 +277,14 @@ DEF_BPROC(COMMAND_DATA_SAVE);
 
 DEF_BPROC(COMMAND_DATA_DUMP);
 
+DEF_BPROC_BATCH(COMMAND_DATA_SAVE);
+
+DEF_BPROC_BATCH(COMMAND_DATA_DUMP);
+
 #define REG_PROC(c, f)     net->proc_map.set_proc(#c, f, proc_##c)
 
 #define BPROC(c)  bproc_##c
+#define BPROC_BATCH(c)  bproc_batch_##c
 
 void SSDBServer::reg_procs(NetworkServer *net) {
     REG_PROC(type, "rt");
@@ -399,7 +418,14 @@ void SSDBServer::reg_procs(NetworkServer *net) {
 
     REG_PROC(ssdb_scan, "wt");
     REG_PROC(ssdb_dbsize, "wt");
+    REG_PROC(ssdb_slot_count, "rt");
+    REG_PROC(ssdb_slot_keys, "rt");
+    REG_PROC(ssdb_slot_del, "wt");
+    REG_PROC(ssdb_migrate_slots, "rt");
+    REG_PROC(ssdb_sst_recv, "wt");
+    REG_PROC(ssdb_sst_ingest, "wt");
     REG_PROC(ssdb_sync2, "b");
+    REG_PROC(ssdb_sync2_range, "b");
 
     REG_PROC(rr_do_flushall, "wt");
     REG_PROC(rr_flushall_check, "wt");
@@ -487,6 +513,7 @@ int proc_slowlog(Context &ctx, Link *link, const Request &req, Response *resp) {
     std::string action = req[1].String();
     strtolower(&action);
 
+    Locking<Mutex> l(&ctx.net->stats_mutex);
     if (action == "reset") {
         ctx.net->slowlog.reset();
         resp->reply_ok();
@@ -704,6 +731,7 @@ int proc_redis_req_restore(Context &ctx, Link *link, const Request &req, Respons
     TransferJob *job = new TransferJob(ctx, COMMAND_DATA_SAVE, req[1].String(), trans_id,
                                        new DumpData(req[1].String(), req[3].String(), ttl, true));
     job->proc = BPROC(COMMAND_DATA_SAVE);
+    job->batch_proc = BPROC_BATCH(COMMAND_DATA_SAVE);
 
     ctx.net->redis->push(job);
 
@@ -720,6 +748,7 @@ int proc_redis_req_dump(Context &ctx, Link *link, const Request &req, Response *
 
     TransferJob *job = new TransferJob(ctx, COMMAND_DATA_DUMP, req[1].String(), trans_id);
     job->proc = BPROC(COMMAND_DATA_DUMP);
+    job->batch_proc = BPROC_BATCH(COMMAND_DATA_DUMP);
 
     //TODO push1st
     ctx.net->redis->push(job);
@@ -904,6 +933,30 @@ int proc_info(Context &ctx, Link *link, const Request &req, Response *resp) {
         int queued_background_job = ctx.net->background->queued();
         ReplyWtihSize(queued_background_job);
 
+        uint64_t transfer_batches = serv->transfer_stats.batches;
+        uint64_t transfer_batch_keys = serv->transfer_stats.batch_keys;
+        uint64_t transfer_batch_time = serv->transfer_stats.batch_time;
+        ReplyWtihSize(transfer_batches);
+        ReplyWtihSize(transfer_batch_keys);
+
+        double transfer_batch_avg_keys = transfer_batch_keys * 1.0 / (transfer_batches > 0 ? transfer_batches : 1);
+        double transfer_batch_avg_latency_ms = transfer_batch_time * 1.0 / (transfer_batches > 0 ? transfer_batches : 1);
+        uint64_t transfer_batch_max_latency_ms = serv->transfer_stats.batch_max_time;
+        ReplyWtihSize(transfer_batch_avg_keys);
+        ReplyWtihSize(transfer_batch_avg_latency_ms);
+        ReplyWtihSize(transfer_batch_max_latency_ms);
+
+        uint64_t queued_delete_keys = serv->ssdb->delete_stats.queued;
+        uint64_t running_delete_keys = serv->ssdb->delete_stats.running;
+        uint64_t deleted_keys = serv->ssdb->delete_stats.keys;
+        uint64_t deleted_items = serv->ssdb->delete_stats.items;
+        uint64_t deleted_ranges = serv->ssdb->delete_stats.ranges;
+        ReplyWtihSize(queued_delete_keys);
+        ReplyWtihSize(running_delete_keys);
+        ReplyWtihSize(deleted_keys);
+        ReplyWtihSize(deleted_items);
+        ReplyWtihSize(deleted_ranges);
+
         resp->emplace_back("");
     }
 
@@ -926,6 +979,28 @@ int proc_info(Context &ctx, Link *link, const Request &req, Response *resp) {
         FastGetProperty(leveldb::DB::Properties::kCompactionPending, "num_compaction_pending");
         FastGetProperty(leveldb::DB::Properties::kNumRunningCompactions, "num_running_compactions");
 
+        uint64_t commit_groups = serv->ssdb->commit_stats.groups;
+        uint64_t commit_batches = serv->ssdb->commit_stats.batches;
+        uint64_t commit_time = serv->ssdb->commit_stats.time;
+        ReplyWtihSize(commit_groups);
+        ReplyWtihSize(commit_batches);
+
+        double commit_avg_group_size = commit_batches * 1.0 / (commit_groups > 0 ? commit_groups : 1);
+        uint64_t commit_max_group_size = serv->ssdb->commit_stats.max_group;
+        double commit_avg_latency_us = commit_time * 1.0 / (commit_groups > 0 ? commit_groups : 1);
+        uint64_t commit_max_latency_us = serv->ssdb->commit_stats.max_time;
+        ReplyWtihSize(commit_avg_group_size);
+        ReplyWtihSize(commit_max_group_size);
+        ReplyWtihSize(commit_avg_latency_us);
+        ReplyWtihSize(commit_max_latency_us);
+
+        if (serv->ssdb->staleFilter) {
+            uint64_t compaction_dropped_items = serv->ssdb->staleFilter->dropped_items;
+            uint64_t compaction_dropped_expire = serv->ssdb->staleFilter->dropped_expire;
+            ReplyWtihSize(compaction_dropped_items);
+            ReplyWtihSize(compaction_dropped_expire);
+        }
+
 
         resp->emplace_back("bgsave_in_progress:0"); //Todo Fake
         resp->emplace_back("aof_rewrite_in_progress:0"); //Todo Fake
@@ -999,6 +1074,33 @@ int proc_info(Context &ctx, Link *link, const Request &req, Response *resp) {
 }
 
 
+// caller holds replicState.rMutex
+static void release_replic_snapshot(SSDBServer *serv) {
+    if (serv->replicState.rSnapshot != nullptr) {
+        serv->ssdb->ReleaseSnapshot(serv->replicState.rSnapshot);
+        serv->replicState.rSnapshot = nullptr;
+    }
+    if (!serv->replicState.rCheckpoint.empty()) {
+        serv->ssdb->removeDir(serv->replicState.rCheckpoint);
+        serv->replicState.rCheckpoint.clear();
+    }
+}
+
+// caller holds replicState.rMutex
+static void make_replic_snapshot(SSDBServer *serv, bool with_lock) {
+    if (serv->opt.sync_checkpoint) {
+        std::string dir = serv->ssdb->getCheckpointPath();
+        if (serv->ssdb->checkpoint(dir, &serv->replicState.rSnapshot) == 0) {
+            serv->replicState.rCheckpoint = dir;
+            return;
+        }
+        log_error("create checkpoint failed, full sync falls back to iterating the snapshot");
+    }
+
+    serv->replicState.rSnapshot = with_lock ? serv->ssdb->GetSnapshotWithLock() : serv->ssdb->GetSnapshot();
+}
+
+
 int proc_replic_info(Context &ctx, Link *link, const Request &req, Response *resp) {
     SSDBServer *serv = (SSDBServer *) ctx.net->data;
 
@@ -1015,6 +1117,19 @@ int proc_replic_info(Context &ctx, Link *link, const Request &req, Response *res
         resp->add(serv->replicState.numFinished);
         resp->push_back("replicState");
         resp->push_back(serv->replicState.States[serv->replicState.rState]);
+
+        const auto &ranges = serv->replicState.ranges;
+        if (!ranges.empty()) {
+            resp->push_back("replicRanges");
+            resp->add((int64_t) ranges.size());
+            for (int i = 0; i < (int) ranges.size(); ++i) {
+                resp->push_back("replicRange" + str(i));
+                resp->push_back("state:" + serv->replicState.RangeStates[ranges[i].state]
+                                + " keys:" + str(ranges[i].keys)
+                                + " bytes:" + str(ranges[i].bytes)
+                                + " start:" + hexstr(ranges[i].start));
+            }
+        }
     }
 
     return 0;
@@ -1037,17 +1152,15 @@ int proc_replic(Context &ctx, Link *link, const Request &req, Response *resp) {
             return 0;
         }
 
-        if (serv->replicState.rSnapshot != nullptr) {
-            serv->ssdb->ReleaseSnapshot(serv->replicState.rSnapshot);
-            serv->replicState.rSnapshot = nullptr;
-        }
+        release_replic_snapshot(serv);
 
-        serv->replicState.rSnapshot = serv->ssdb->GetSnapshot();
+        make_replic_snapshot(serv, false);
         serv->replicState.startReplic();
     }
 
-    BackgroundThreadJob *job = new ReplicationByIterator2(ctx, HostAndPort{ip, port},
-                                                          link, serv->opt.transfer_compression, false, replts);
+    ReplicationByIterator2 *job = new ReplicationByIterator2(ctx, HostAndPort{ip, port},
+                                                             link, serv->opt.transfer_compression, false, replts);
+    job->parallel = serv->opt.sync_parallel;
 
     ctx.net->background->push(job);
 
@@ -1124,15 +1237,10 @@ int proc_rr_make_snapshot(Context &ctx, Link *link, const Request &req, Response
             return 0;
         }
 
-        if (serv->replicState.rSnapshot != nullptr) {
-            serv->ssdb->ReleaseSnapshot(serv->replicState.rSnapshot);
-            serv->replicState.rSnapshot = nullptr;
-        }
+        release_replic_snapshot(serv);
 
 
-        {
-            serv->replicState.rSnapshot = serv->ssdb->GetSnapshotWithLock();
-        }
+        make_replic_snapshot(serv, true);
 
         serv->replicState.resetReplic();
     }
@@ -1159,8 +1267,9 @@ int proc_rr_transfer_snapshot(Context &ctx, Link *link, const Request &req, Resp
 
     link->quick_send({"ok", "rr_transfer_snapshot ok"});
 
-    BackgroundThreadJob *job = new ReplicationByIterator2(ctx, HostAndPort{ip, port},
-                                                          link, serv->opt.transfer_compression, true, replts);
+    ReplicationByIterator2 *job = new ReplicationByIterator2(ctx, HostAndPort{ip, port},
+                                                             link, serv->opt.transfer_compression, true, replts);
+    job->parallel = serv->opt.sync_parallel;
     ctx.net->background->push(job);
 
     resp->resp.clear(); //prevent send resp
@@ -1180,10 +1289,7 @@ int proc_rr_del_snapshot(Context &ctx, Link *link, const Request &req, Response
             return 0;
         }
 
-        if (serv->replicState.rSnapshot != nullptr) {
-            serv->ssdb->ReleaseSnapshot(serv->replicState.rSnapshot);
-            serv->replicState.rSnapshot = nullptr;
-        }
+        release_replic_snapshot(serv);
 
         serv->replicState.resetReplic();
     }
@@ -1284,6 +1390,8 @@ int proc_ssdb_sync2(Context &ctx, Link *link, const Request &req, Response *resp
     log_info("ssdb_sync2 , link address:%lld", link);
     bool heartbeat = false;
     int64_t replts = 0;
+    int ranges = 1;
+    bool checkpoint = false;
 
     if (req.size() > 2) {
         for (int i = 1; i < req.size(); ++i) {
@@ -1301,12 +1409,26 @@ int proc_ssdb_sync2(Context &ctx, Link *link, const Request &req, Response *resp
                     reply_err_return(SYNTAX_ERR);
                 }
                 replts = req[i].Int64();
+            } else if (key == "ranges") {
+                i++;
+                if (i >= req.size()) {
+                    reply_err_return(SYNTAX_ERR);
+                }
+                ranges = req[i].Int();
+            } else if (key == "checkpoint") {
+                i++;
+                if (i >= req.size()) {
+                    reply_err_return(SYNTAX_ERR);
+                }
+                checkpoint = (req[i].String() == "1");
             }
         }
     }
 
     ReplicationByIterator2 *job = new ReplicationByIterator2(ctx, HostAndPort{link->remote_ip, link->remote_port}, link,
                                                              true, heartbeat, replts);
+    job->parallel = ranges;
+    job->checkpoint = checkpoint;
 //	net->replication->push(job);
 
     pthread_t tid;
@@ -1321,6 +1443,52 @@ int proc_ssdb_sync2(Context &ctx, Link *link, const Request &req, Response *resp
 }
 
 
+int proc_ssdb_sync2_range(Context &ctx, Link *link, const Request &req, Response *resp) {
+    SSDBServer *serv = (SSDBServer *) ctx.net->data;
+    CHECK_NUM_PARAMS(5);
+    log_info("ssdb_sync2_range , link address:%lld", link);
+
+    int64_t replts = 0;
+    int index = -1;
+    for (int i = 1; i + 1 < req.size(); i += 2) {
+        std::string key = req[i].String();
+        strtolower(&key);
+        if (key == "replts") {
+            replts = req[i + 1].Int64();
+        } else if (key == "range") {
+            index = req[i + 1].Int();
+        } else {
+            reply_err_return(SYNTAX_ERR);
+        }
+    }
+
+    {
+        Locking<Mutex> l(&serv->replicState.rMutex);
+        if (replts != serv->replicState.rangeReplTs || index < 0 || index >= (int) serv->replicState.ranges.size()
+            || serv->replicState.ranges[index].state != ReplicRange::WAIT) {
+            log_error("unexpected range %d of snapshot %d", index, replts);
+            reply_errinfo_return("ERR no such snapshot range waiting");
+        }
+    }
+
+    ReplicRangeJob *job = new ReplicRangeJob();
+    job->ctx = ctx;
+    job->link = link;
+    job->replTs = replts;
+    job->index = index;
+
+    pthread_t tid;
+    int err = pthread_create(&tid, NULL, &ssdb_sync2_range, job);
+    if (err != 0) {
+        log_fatal("can't create thread: %s", strerror(err));
+        exit(0);
+    }
+
+    resp->resp.clear(); //prevent send resp
+    return PROC_BACKEND;
+}
+
+
 int proc_migrate(Context &ctx, Link *link, const Request &req, Response *resp) {
     SSDBServer *serv = (SSDBServer *) ctx.net->data;
     CHECK_NUM_PARAMS(6);
@@ -1526,3 +1694,254 @@ int proc_migrate(Context &ctx, Link *link, const Request &req, Response *resp) {
     return 0;
 }
 
+
+#define MIGRATE_SST_FILE_SIZE (256 * 1024 * 1024)
+#define MIGRATE_SST_CHUNK_SIZE (4 * 1024 * 1024)
+
+static void remove_sst_dir(const std::string &dir, const std::vector<std::string> &files) {
+    leveldb::Env *env = leveldb::Env::Default();
+    for (const auto &file : files) {
+        env->DeleteFile(file);
+    }
+    env->DeleteDir(dir);
+}
+
+static int send_sst_file(RedisClient &r, const std::string &trans_id, size_t file_no, const std::string &path,
+                         std::string *err) {
+    FILE *fp = fopen(path.c_str(), "rb");
+    if (fp == nullptr) {
+        *err = "ERR open " + path + " failed";
+        return -1;
+    }
+
+    std::string chunk(MIGRATE_SST_CHUNK_SIZE, '\0');
+    int64_t offset = 0;
+    int ret = 0;
+    while (true) {
+        size_t n = fread(&chunk[0], 1, chunk.size(), fp);
+        if (n == 0) {
+            if (ferror(fp)) {
+                *err = "ERR read " + path + " failed";
+                ret = -1;
+            }
+            break;
+        }
+
+        std::unique_ptr<RedisResponse> res(r.redisRequest({"ssdb_sst_recv", trans_id, str((int64_t) file_no),
+                                                           str(offset), chunk.substr(0, n)}));
+        if (!res) {
+            *err = "IOERR error or timeout to target instance";
+            ret = -1;
+            break;
+        }
+        if (res->type == REDIS_REPLY_ERROR) {
+            *err = "ERR Target instance replied with error: " + res->str;
+            ret = -1;
+            break;
+        }
+        offset += n;
+    }
+
+    fclose(fp);
+    return ret;
+}
+
+/*
+ * ssdb_migrate_slots host port timeout slot [slot ...] [copy]
+ *
+ * bulk move of whole slots to another swap-ssdb: the slots are written into
+ * sst files under one snapshot, streamed to the target, ingested there and
+ * range deleted here. writes to the slots must be stopped by the caller.
+ */
+int proc_ssdb_migrate_slots(Context &ctx, Link *link, const Request &req, Response *resp) {
+    SSDBServer *serv = (SSDBServer *) ctx.net->data;
+    CHECK_NUM_PARAMS(5);
+
+    std::string host = req[1].String();
+    int port = req[2].Int();
+    long timeout = req[3].Int();
+    if (errno == EINVAL) {
+        reply_err_return(INVALID_INT);
+    }
+    if (timeout <= 0) timeout = 1000;
+
+    bool copy = false;
+    std::vector<uint16_t> slots;
+    for (int j = 4; j < req.size(); j++) {
+        std::string q = req[j].String();
+        strtolower(&q);
+        if (q == "copy") {
+            copy = true;
+            continue;
+        }
+        uint64_t slot = req[j].Uint64();
+        if (errno == EINVAL || slot >= 16384) {
+            reply_err_return(INVALID_INT);
+        }
+        slots.push_back((uint16_t) slot);
+    }
+    if (slots.empty()) {
+        reply_err_return(INVALID_ARGS);
+    }
+
+    std::string trans_id = str(time_ms());
+    std::string dir = serv->ssdb->getPath() + "/migrate/" + trans_id + "/";
+    leveldb::Env::Default()->CreateDirIfMissing(serv->ssdb->getPath() + "/migrate/");
+    leveldb::Status s = leveldb::Env::Default()->CreateDirIfMissing(dir);
+    if (!s.ok()) {
+        log_error("create %s error: %s", dir.c_str(), s.ToString().c_str());
+        reply_err_return(STORAGE_ERR);
+    }
+
+    std::vector<std::string> files;
+    std::string types;
+    uint64_t count = 0;
+    int64_t start = time_ms();
+    int ret = serv->ssdb->slotexport(ctx, slots, dir, MIGRATE_SST_FILE_SIZE, &files, &types, &count);
+    if (ret < 0) {
+        remove_sst_dir(dir, files);
+        reply_err_return(ret);
+    }
+    log_info("[migrate_slots] %d slots, %" PRIu64 " keys exported into %d files in %" PRId64 " ms",
+             (int) slots.size(), count, (int) files.size(), time_ms() - start);
+
+    if (!files.empty()) {
+        Link *cs = Link::connect(host.c_str(), port, timeout);
+        if (cs == nullptr) {
+            remove_sst_dir(dir, files);
+            reply_errinfo_return("IOERR error or timeout connecting to the client");
+        }
+        cs->sendtimeout(timeout);
+        cs->readtimeout(timeout);
+
+        //managed link
+        std::unique_ptr<RedisClient> r(new RedisClient(cs));
+
+        std::string err;
+        for (size_t i = 0; i < files.size() && err.empty(); i++) {
+            send_sst_file(*r, trans_id, i, files[i], &err);
+        }
+        if (err.empty()) {
+            std::unique_ptr<RedisResponse> res(r->redisRequest({"ssdb_sst_ingest", trans_id, str((int64_t) files.size()), types}));
+            if (!res) {
+                err = "IOERR error or timeout to target instance";
+            } else if (res->type == REDIS_REPLY_ERROR) {
+                err = "ERR Target instance replied with error: " + res->str;
+            }
+        }
+
+        remove_sst_dir(dir, files);
+        if (!err.empty()) {
+            reply_errinfo_return(err);
+        }
+    } else {
+        remove_sst_dir(dir, files);
+    }
+
+    if (!copy) {
+        for (uint16_t slot : slots) {
+            uint64_t deleted = 0;
+            ret = serv->ssdb->slotdel(ctx, slot, &deleted);
+            if (ret < 0) {
+                reply_err_return(ret);
+            }
+        }
+    }
+
+    log_info("[migrate_slots] %" PRIu64 " keys migrated to %s:%d in %" PRId64 " ms",
+             count, host.c_str(), port, time_ms() - start);
+
+    resp->reply_int(0, count);
+    return 0;
+}
+
+static std::string ingest_dir(SSDBServer *serv, uint64_t trans_id) {
+    return serv->ssdb->getPath() + "/ingest/" + str(trans_id) + "/";
+}
+
+/*
+ * ssdb_sst_recv trans_id file_no offset data, appends one chunk of an sst
+ * file sent by ssdb_migrate_slots
+ */
+int proc_ssdb_sst_recv(Context &ctx, Link *link, const Request &req, Response *resp) {
+    SSDBServer *serv = (SSDBServer *) ctx.net->data;
+    CHECK_NUM_PARAMS(5);
+
+    uint64_t trans_id = req[1].Uint64();
+    if (errno == EINVAL) {
+        reply_err_return(INVALID_INT);
+    }
+    uint64_t file_no = req[2].Uint64();
+    if (errno == EINVAL) {
+        reply_err_return(INVALID_INT);
+    }
+    uint64_t offset = req[3].Uint64();
+    if (errno == EINVAL) {
+        reply_err_return(INVALID_INT);
+    }
+
+    std::string dir = ingest_dir(serv, trans_id);
+    if (offset == 0) {
+        leveldb::Env::Default()->CreateDirIfMissing(serv->ssdb->getPath() + "/ingest/");
+        leveldb::Env::Default()->CreateDirIfMissing(dir);
+    }
+
+    std::string path = dir + str(file_no) + ".sst";
+    uint64_t size = 0;
+    leveldb::Env::Default()->GetFileSize(path, &size);
+    if (size != offset) {
+        reply_errinfo_return("ERR sst chunk out of order");
+    }
+
+    FILE *fp = fopen(path.c_str(), "ab");
+    if (fp == nullptr) {
+        log_error("open %s error: %s", path.c_str(), strerror(errno));
+        reply_err_return(STORAGE_ERR);
+    }
+    size_t n = fwrite(req[4].data(), 1, (size_t) req[4].size(), fp);
+    fclose(fp);
+    if (n != (size_t) req[4].size()) {
+        log_error("write %s error: %s", path.c_str(), strerror(errno));
+        reply_err_return(STORAGE_ERR);
+    }
+
+    resp->reply_ok();
+    return 0;
+}
+
+/*
+ * ssdb_sst_ingest trans_id file_count [types], types holds the key type of each file
+ */
+int proc_ssdb_sst_ingest(Context &ctx, Link *link, const Request &req, Response *resp) {
+    SSDBServer *serv = (SSDBServer *) ctx.net->data;
+    CHECK_NUM_PARAMS(3);
+
+    uint64_t trans_id = req[1].Uint64();
+    if (errno == EINVAL) {
+        reply_err_return(INVALID_INT);
+    }
+    uint64_t file_count = req[2].Uint64();
+    if (errno == EINVAL) {
+        reply_err_return(INVALID_INT);
+    }
+
+    std::string dir = ingest_dir(serv, trans_id);
+    std::vector<std::string> files;
+    for (uint64_t i = 0; i < file_count; i++) {
+        files.push_back(dir + str(i) + ".sst");
+    }
+
+    std::string types = req.size() > 3 ? req[3].String() : "";
+
+    int ret = serv->ssdb->slotingest(ctx, files, types);
+    remove_sst_dir(dir, files);
+    if (ret < 0) {
+        reply_err_return(ret);
+    }
+
+    log_info("[sst_ingest] %" PRIu64 " files of %" PRIu64 " ingested", file_count, trans_id);
+
+    resp->reply_ok();
+    return 0;
+}
+
@@ -20,6 +20,20 @@ found in the LICENSE file.
 #include "util/internal_error.h"
 
 
+class ReplicRange {
+public:
+    const static int WAIT = 0;
+    const static int TRANS = 1;
+    const static int DONE = 2;
+    const static int FAILED = 3;
+
+    std::string start;
+    std::string end;
+    uint64_t keys = 0;
+    uint64_t bytes = 0;
+    int state = ReplicRange::WAIT;
+};
+
 class ReplicationState {
 public:
     const static int START = 0;
@@ -30,6 +44,7 @@ public:
 public:
 
     const leveldb::Snapshot *rSnapshot = nullptr;
+    std::string rCheckpoint;
     Mutex rMutex;
 
     int rState = ReplicationState::START;
@@ -37,6 +52,11 @@ public:
     uint64_t numFinished = 0;
     uint64_t numFailed = 0;
 
+    // per range progress of a parallel snapshot transfer, kept until the next one starts
+    std::vector<std::string> RangeStates = {"WAIT", "TRANS", "DONE", "FAILED"};
+    int64_t rangeReplTs = 0;
+    std::vector<ReplicRange> ranges;
+
     void startReplic() {
         rState = ReplicationState::START;
         numStarted++;
@@ -60,6 +80,20 @@ public:
         numFailed = 0;
     }
 
+    void resetRanges(int64_t replTs, size_t count) {
+        rangeReplTs = replTs;
+        ranges.assign(count, ReplicRange());
+    }
+
+    void updateRange(int index, uint64_t keys, uint64_t bytes, int state) {
+        if (index < 0 || index >= (int) ranges.size()) {
+            return;
+        }
+        ranges[index].keys = keys;
+        ranges[index].bytes = bytes;
+        ranges[index].state = state;
+    }
+
     bool inTransState() {
         return rState == ReplicationState::TRANS;
     }
@@ -80,6 +114,7 @@ public:
 
 	SSDBImpl *ssdb;
     RecordMutex<Mutex> transfer_mutex_record_;
+    TransferStats transfer_stats;
 
     const Options &opt;
 
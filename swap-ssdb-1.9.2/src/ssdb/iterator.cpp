@@ -11,16 +11,33 @@ found in the LICENSE file.
 #include "leveldb/iterator.h"
 #else
 #include "rocksdb/iterator.h"
+#include "rocksdb/options.h"
 #endif
 
 
+IteratorBounds::IteratorBounds(const std::string &lower, const std::string &upper) :
+		lower(lower), upper(upper), lower_slice(this->lower), upper_slice(this->upper){
+}
+
+void IteratorBounds::apply(leveldb::ReadOptions *options){
+	if(!lower.empty()){
+		options->iterate_lower_bound = &lower_slice;
+	}
+	if(!upper.empty()){
+		options->iterate_upper_bound = &upper_slice;
+	}
+}
+
+
 Iterator::Iterator(leveldb::Iterator *it,
 		const std::string &end,
 		uint64_t limit,
 		Direction direction,
-		const leveldb::Snapshot *snapshot)
+		const leveldb::Snapshot *snapshot,
+		IteratorBounds *bounds)
 {
 	this->it = it;
+	this->bounds = bounds;
 	this->end = end;
 	this->limit = limit;
 	this->is_first = true;
@@ -30,6 +47,7 @@ Iterator::Iterator(leveldb::Iterator *it,
 
 Iterator::~Iterator(){
 	delete it;
+	delete bounds;
 }
 
 Bytes Iterator::key(){
@@ -287,6 +305,7 @@ bool LIterator::next() {
 			return false;
 		}
 		this->seq = sk.seq;
+		this->val = it->val();
 
 		return true;
 	}
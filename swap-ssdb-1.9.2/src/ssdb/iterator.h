@@ -14,14 +14,32 @@ found in the LICENSE file.
 
 namespace leveldb{
 #else
+#include <rocksdb/slice.h>
 
 #define leveldb rocksdb
 namespace rocksdb {
 #endif
 	class Iterator;
 	class Snapshot;
+	struct ReadOptions;
 }
 
+/*
+ * storage level bounds of a scan, empty means unbounded. the wrapped iterator
+ * reads them through its ReadOptions, so they are owned by the Iterator.
+ */
+class IteratorBounds{
+public:
+	IteratorBounds(const std::string &lower, const std::string &upper);
+	void apply(leveldb::ReadOptions *options);
+
+private:
+	std::string lower;
+	std::string upper;
+	leveldb::Slice lower_slice;
+	leveldb::Slice upper_slice;
+};
+
 class Iterator{
 public:
 	enum Direction{
@@ -31,7 +49,8 @@ public:
 			const std::string &end,
 			uint64_t limit,
 			Direction direction=Iterator::FORWARD,
-			const leveldb::Snapshot *snapshot=nullptr
+			const leveldb::Snapshot *snapshot=nullptr,
+			IteratorBounds *bounds=nullptr
 	);
 	~Iterator();
 	bool skip(uint64_t offset);
@@ -42,6 +61,7 @@ public:
 	const leveldb::Snapshot *snapshot;
 private:
 	leveldb::Iterator *it;
+	IteratorBounds *bounds;
 	std::string end;
 	uint64_t limit;
 	bool is_first;
@@ -129,6 +149,7 @@ class LIterator{
 public:
 	std::string name;
 	uint64_t    seq;
+	Bytes		val;
 	uint16_t 	version;
 
 	LIterator(Iterator *it, const Bytes &name, uint16_t version = 0);
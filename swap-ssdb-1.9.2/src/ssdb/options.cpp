@@ -69,6 +69,20 @@ void Options::load(Config *conf) {
     use_direct_reads = conf->get_bool("rocksdb.use_direct_reads", false);
     optimize_filters_for_hits = conf->get_bool("rocksdb.optimize_filters_for_hits", false);
     cache_index_and_filter_blocks = conf->get_bool("rocksdb.cache_index_and_filter_blocks", false);
+    key_slot_prefix = conf->get_bool("rocksdb.key_slot_prefix", false);
+    cf_per_class = conf->get_bool("rocksdb.cf_per_class", false);
+    meta_merge = conf->get_bool("rocksdb.meta_merge", false);
+    group_commit = conf->get_bool("rocksdb.group_commit", false);
+    commit_sync = conf->get_bool("rocksdb.commit_sync", false);
+
+    delete_threads = conf->get_num("rocksdb.delete_threads", 2);
+    if (delete_threads < 1) {
+        delete_threads = 1;
+    } else if (delete_threads > 16) {
+        delete_threads = 16;
+    }
+    delete_rate = conf->get_num("rocksdb.delete_rate", 0);
+    compaction_filter = conf->get_bool("rocksdb.compaction_filter", false);
 
     compaction_readahead_size = (size_t) conf->get_num("rocksdb.compaction_readahead_size", 4);
     max_bytes_for_level_base = (size_t) conf->get_num("rocksdb.max_bytes_for_level_base", 256);
@@ -89,6 +103,14 @@ void Options::load(Config *conf) {
     upstream_ip = conf->get_str("upstream.ip");
     upstream_port = conf->get_num("upstream.port", 0);
 
+    sync_parallel = conf->get_num("replication.sync_parallel", 1);
+    if (sync_parallel < 1) {
+        sync_parallel = 1;
+    } else if (sync_parallel > 16) {
+        sync_parallel = 16;
+    }
+    sync_checkpoint = conf->get_bool("replication.sync_checkpoint", false);
+
 #endif
 
 
@@ -111,6 +133,14 @@ std::ostream &operator<<(std::ostream &os, const Options &options) {
             << "\n use_direct_reads: " << options.use_direct_reads
             << "\n optimize_filters_for_hits: " << options.optimize_filters_for_hits
             << "\n expire_enable: " << options.expire_enable
+            << "\n key_slot_prefix: " << options.key_slot_prefix
+            << "\n cf_per_class: " << options.cf_per_class
+            << "\n meta_merge: " << options.meta_merge
+            << "\n group_commit: " << options.group_commit
+            << "\n commit_sync: " << options.commit_sync
+            << "\n delete_threads: " << options.delete_threads
+            << "\n delete_rate: " << options.delete_rate
+            << "\n compaction_filter: " << options.compaction_filter
 
             << "\n max_write_buffer_number: " << options.max_write_buffer_number
             << "\n max_background_flushes: " << options.max_background_flushes
@@ -132,6 +162,8 @@ std::ostream &operator<<(std::ostream &os, const Options &options) {
             << "\n level0_stop_writes_trigger: " << options.level0_stop_writes_trigger
             << "\n upstream_ip: " << options.upstream_ip
             << "\n upstream_port: " << options.upstream_port
+            << "\n sync_parallel: " << options.sync_parallel
+            << "\n sync_checkpoint: " << options.sync_checkpoint
             << "\n c: " << options.c;
     return os;
 }
@@ -54,6 +54,15 @@ struct Options {
     bool optimize_filters_for_hits = false;
     bool cache_index_and_filter_blocks = false;
     bool expire_enable = false;
+    bool key_slot_prefix = false;
+    bool cf_per_class = false;
+    bool meta_merge = false;
+    bool group_commit = false;
+    bool commit_sync = false;
+
+    int delete_threads = 1;
+    int delete_rate = 0;
+    bool compaction_filter = false;
 
     int min_write_buffer_number_to_merge = 2;
     int max_write_buffer_number = 3;
@@ -76,6 +85,9 @@ struct Options {
     std::string upstream_ip;
     int upstream_port = 0;
 
+    int sync_parallel = 1;
+    bool sync_checkpoint = false;
+
     void load(Config *conf);
 
     Options() {
@@ -77,6 +77,7 @@ public:
 	virtual int getbit(Context &ctx, const Bytes &key,int64_t bitoffset, int *res) = 0;
 	
 	virtual int get(Context &ctx, const Bytes &key,std::string *val) = 0;
+	virtual int multi_get(Context &ctx, const std::vector<Bytes> &keys, int offset, std::vector<std::string> *vals, std::vector<int> *rets) = 0;
 	virtual int getset(Context &ctx, const Bytes &key,std::pair<std::string, bool> &val, const Bytes &newval) = 0;
 	virtual int getrange(Context &ctx, const Bytes &key,int64_t start, int64_t end, std::pair<std::string, bool> &res) = 0;
 	virtual int setrange(Context &ctx, const Bytes &key,int64_t start, const Bytes &value, uint64_t *new_len) = 0;
@@ -3,6 +3,7 @@ Copyright (c) 2012-2014 The SSDB Authors. All rights reserved.
 Use of this source code is governed by a BSD-style license that can be
 found in the LICENSE file.
 */
+#include <algorithm>
 #include <util/file.h>
 #include "ssdb_impl.h"
 
@@ -20,6 +21,7 @@ found in the LICENSE file.
 #include "rocksdb/convenience.h"
 #include "rocksdb/slice_transform.h"
 #include <rocksdb/utilities/sim_cache.h>
+#include <rocksdb/utilities/checkpoint.h>
 
 extern "C" {
 #include <redis/zmalloc.h>
@@ -27,12 +29,13 @@ extern "C" {
 
 
 #include "t_listener.h"
+#include "t_merge.h"
 
 #define leveldb rocksdb
 #endif
 
 
-SSDBImpl::SSDBImpl() {
+SSDBImpl::SSDBImpl() : bgtask_cv_(&mutex_bgtask_) {
     ldb = NULL;
     this->bgtask_quit = true;
     expiration = NULL;
@@ -45,16 +48,7 @@ SSDBImpl::~SSDBImpl() {
         delete expiration;
     }
 
-
-    for (auto handle : handles) {
-        log_info("ColumnFamilyHandle %s finalized", handle->GetName().c_str());
-        delete handle;
-    }
-
-    if (ldb) {
-        log_info("DB %s finalized", ldb->GetName().c_str());
-        delete ldb;
-    }
+    closeLdb();
 
     log_info("SSDBImpl finalized");
 
@@ -69,6 +63,40 @@ SSDBImpl::~SSDBImpl() {
 #endif
 }
 
+#ifndef USE_LEVELDB
+/*
+ * item, zscore and zrank keys of one collection version share the prefix
+ * type + [slot] + len + key + version, the bloom filters and memtables index
+ * it so seeks into small or absent collections skip most files.
+ * the key format is part of the name, files written under the other format
+ * do not use their prefix filters.
+ */
+class CollectionPrefixTransform : public leveldb::SliceTransform {
+public:
+    explicit CollectionPrefixTransform(int format) : format(format) {}
+
+    const char *Name() const override {
+        return format == KEY_FORMAT_SLOT ? "swapdb.CollectionPrefix.slot" : "swapdb.CollectionPrefix";
+    }
+
+    leveldb::Slice Transform(const leveldb::Slice &key) const override {
+        return leveldb::Slice(key.data(), (size_t) collection_prefix_size(key.data(), key.size(), format));
+    }
+
+    bool InDomain(const leveldb::Slice &key) const override {
+        return collection_prefix_size(key.data(), key.size(), format) > 0;
+    }
+
+    bool InRange(const leveldb::Slice &dst) const override {
+        return InDomain(dst) && collection_prefix_size(dst.data(), dst.size(), format) == (int) dst.size();
+    }
+
+private:
+    int format;
+};
+
+#endif
+
 SSDB *SSDB::open(const Options &opt, const std::string &dir) {
     SSDBImpl *ssdb = new SSDBImpl();
 
@@ -106,6 +134,18 @@ SSDB *SSDB::open(const Options &opt, const std::string &dir) {
         op.pin_l0_filter_and_index_blocks_in_cache = true;
 
         ssdb->options.table_factory = std::shared_ptr<leveldb::TableFactory>(rocksdb::NewBlockBasedTableFactory(op));
+
+        // class column families share the block cache, only the table layout differs
+        leveldb::BlockBasedTableOptions meta_op = op;
+        meta_op.block_size = 4 * UNIT_KB; // point lookups
+        meta_op.cache_index_and_filter_blocks = true;
+        ssdb->metaCfOptions.table_factory = std::shared_ptr<leveldb::TableFactory>(
+                rocksdb::NewBlockBasedTableFactory(meta_op));
+
+        leveldb::BlockBasedTableOptions zset_op = op;
+        zset_op.block_size = op.block_size * 4; // range scans by score and rank
+        ssdb->zsetCfOptions.table_factory = std::shared_ptr<leveldb::TableFactory>(
+                rocksdb::NewBlockBasedTableFactory(zset_op));
     }
 
 //    {
@@ -156,28 +196,443 @@ SSDB *SSDB::open(const Options &opt, const std::string &dir) {
     }
 
 
-    leveldb::Status status;
+#ifndef USE_LEVELDB
+    // checkKeyFormat refuses to go on if the data dir was written in the other format
+    ssdb->options.prefix_extractor = std::make_shared<CollectionPrefixTransform>(
+            opt.key_slot_prefix ? KEY_FORMAT_SLOT : KEY_FORMAT_PLAIN);
+    ssdb->options.memtable_prefix_bloom_size_ratio = 0.1;
 
-    // open DB with two column families
-    std::vector<leveldb::ColumnFamilyDescriptor> column_families;
+    ssdb->cf_per_class = opt.cf_per_class;
 
-    column_families.emplace_back(leveldb::ColumnFamilyDescriptor(leveldb::kDefaultColumnFamilyName, ssdb->options));
+    // always registered, operands written before meta_merge was turned off still need it
+    ssdb->options.merge_operator = std::make_shared<MetaDeltaMergeOperator>();
+    ssdb->meta_merge = opt.meta_merge;
 
-    column_families.emplace_back(leveldb::ColumnFamilyDescriptor(REPOPID_CF, leveldb::ColumnFamilyOptions()));
+    ssdb->group_commit = opt.group_commit;
+    ssdb->commit_sync = opt.commit_sync;
+
+    ssdb->delete_threads = opt.delete_threads;
+    ssdb->delete_rate = opt.delete_rate;
+
+    if (opt.compaction_filter) {
+        ssdb->staleFilter = std::make_shared<StaleDataFilterFactory>(ssdb);
+        ssdb->options.compaction_filter_factory = ssdb->staleFilter;
+    }
 
-    status = leveldb::DB::Open(ssdb->options, ssdb->getDataPath(), column_families, &ssdb->handles, &ssdb->ldb);
+    auto meta_table = ssdb->metaCfOptions.table_factory;
+    auto zset_table = ssdb->zsetCfOptions.table_factory;
+    ssdb->metaCfOptions = leveldb::ColumnFamilyOptions(ssdb->options);
+    ssdb->metaCfOptions.table_factory = meta_table;
+    ssdb->metaCfOptions.prefix_extractor = nullptr;
+    ssdb->metaCfOptions.memtable_prefix_bloom_size_ratio = 0;
+    ssdb->metaCfOptions.compaction_filter_factory = nullptr;
+    ssdb->zsetCfOptions = leveldb::ColumnFamilyOptions(ssdb->options);
+    ssdb->zsetCfOptions.table_factory = zset_table;
+
+    // expire and delete queues are small, written once and consumed from the head
+    ssdb->queueCfOptions = leveldb::ColumnFamilyOptions(ssdb->options);
+    ssdb->queueCfOptions.write_buffer_size = std::max(ssdb->options.write_buffer_size / 4, (size_t) UNIT_MB);
+    ssdb->queueCfOptions.compaction_pri = leveldb::kOldestSmallestSeqFirst;
+    ssdb->queueCfOptions.prefix_extractor = nullptr;
+    ssdb->queueCfOptions.memtable_prefix_bloom_size_ratio = 0;
+#endif
+
+    leveldb::Status status = ssdb->openLdb();
     if (!status.ok()) {
         log_error("open db failed: %s", status.ToString().c_str());
         delete ssdb;
         return nullptr;
     }
 
+    if (ssdb->checkKeyFormat(opt.key_slot_prefix ? KEY_FORMAT_SLOT : KEY_FORMAT_PLAIN) != 0) {
+        delete ssdb;
+        return nullptr;
+    }
+
     ssdb->expiration = new ExpirationHandler(ssdb, opt.expire_enable); //todo 后续如果支持set命令中设置过期时间，添加此行，同时删除serv.cpp中相应代码
     ssdb->start();
 
     return ssdb;
 }
 
+leveldb::Status SSDBImpl::openLdb() {
+    // open DB with two column families, plus the class ones when split
+    std::vector<leveldb::ColumnFamilyDescriptor> column_families;
+
+    column_families.emplace_back(leveldb::ColumnFamilyDescriptor(leveldb::kDefaultColumnFamilyName, options));
+
+    column_families.emplace_back(leveldb::ColumnFamilyDescriptor(REPOPID_CF, leveldb::ColumnFamilyOptions()));
+
+    std::vector<std::string> existing;
+    leveldb::DB::ListColumnFamilies(options, getDataPath(), &existing); // fails on a new dir
+    bool has_class = std::find(existing.begin(), existing.end(), META_CF) != existing.end();
+
+    if (cf_per_class || has_class) {
+        column_families.emplace_back(leveldb::ColumnFamilyDescriptor(META_CF, metaCfOptions));
+        column_families.emplace_back(leveldb::ColumnFamilyDescriptor(ZSET_CF, zsetCfOptions));
+        column_families.emplace_back(leveldb::ColumnFamilyDescriptor(EXPIRE_CF, queueCfOptions));
+        column_families.emplace_back(leveldb::ColumnFamilyDescriptor(DELETE_CF, queueCfOptions));
+    }
+
+    leveldb::Status s = leveldb::DB::Open(options, getDataPath(), column_families, &handles, &ldb);
+    if (!s.ok()) {
+        return s;
+    }
+
+    s = migrateClasses();
+    if (s.ok() && staleFilter) {
+        staleFilter->enabled = true;
+    }
+    return s;
+}
+
+void SSDBImpl::closeLdb() {
+    if (ldb && staleFilter) {
+        // filters look meta keys up through handles, let running compactions finish first
+        staleFilter->enabled = false;
+        leveldb::CancelAllBackgroundWork(ldb, true);
+    }
+
+    for (auto handle : handles) {
+        log_info("ColumnFamilyHandle %s finalized", handle->GetName().c_str());
+        delete handle;
+    }
+    handles.clear();
+
+    if (ldb) {
+        log_info("DB %s finalized", ldb->GetName().c_str());
+        delete ldb;
+        ldb = nullptr;
+    }
+}
+
+/*
+ * moves every key under prefix from one column family to another, batch by
+ * batch so an interrupted move picks up where it stopped on the next start.
+ */
+static leveldb::Status move_keys(leveldb::DB *ldb, leveldb::ColumnFamilyHandle *from, leveldb::ColumnFamilyHandle *to,
+                                 const std::string &prefix, uint64_t *moved) {
+    leveldb::ReadOptions iterate_options(false, false);
+    iterate_options.total_order_seek = true;
+    std::unique_ptr<leveldb::Iterator> it(ldb->NewIterator(iterate_options, from));
+
+    leveldb::WriteBatch batch;
+    leveldb::Status s;
+    for (it->Seek(prefix); it->Valid() && it->key().starts_with(prefix); it->Next()) {
+        batch.Put(to, it->key(), it->value());
+        batch.Delete(from, it->key());
+        (*moved)++;
+
+        if (batch.Count() >= 20000) {
+            s = ldb->Write(leveldb::WriteOptions(), &batch);
+            if (!s.ok()) {
+                return s;
+            }
+            batch.Clear();
+        }
+    }
+    if (!it->status().ok()) {
+        return it->status();
+    }
+
+    return ldb->Write(leveldb::WriteOptions(), &batch);
+}
+
+/*
+ * rocksdb.cf_per_class was turned on: move class keys out of the default
+ * column family. turned off: move them back and drop the class column families.
+ */
+leveldb::Status SSDBImpl::migrateClasses() {
+    if (handles.size() <= CF_META) {
+        return leveldb::Status::OK();
+    }
+
+    leveldb::Status s;
+    uint64_t moved = 0;
+
+    if (cf_per_class) {
+        for (char type : {DataType::DELETE, DataType::EKEY, DataType::META, DataType::ESCORE,
+                          DataType::ZRANK, DataType::ZSCORE}) {
+            s = move_keys(ldb, handles[CF_DEFAULT], cfOf(type), std::string(1, type), &moved);
+            if (!s.ok()) {
+                return s;
+            }
+        }
+        if (moved > 0) {
+            log_info("%" PRIu64 " keys moved into class column families", moved);
+            ldb->CompactRange(leveldb::CompactRangeOptions(), handles[CF_DEFAULT], nullptr, nullptr);
+        }
+        return s;
+    }
+
+    for (int i = CF_META; i < (int) handles.size(); i++) {
+        s = move_keys(ldb, handles[i], handles[CF_DEFAULT], "", &moved);
+        if (!s.ok()) {
+            return s;
+        }
+    }
+    log_info("%" PRIu64 " keys moved back into the default column family", moved);
+
+    for (int i = CF_META; i < (int) handles.size(); i++) {
+        s = ldb->DropColumnFamily(handles[i]);
+        if (!s.ok()) {
+            return s;
+        }
+        delete handles[i];
+    }
+    handles.resize(CF_META);
+
+    return s;
+}
+
+std::vector<leveldb::ColumnFamilyHandle *> SSDBImpl::dataHandles() const {
+    std::vector<leveldb::ColumnFamilyHandle *> cfs;
+    for (int i = 0; i < (int) handles.size(); i++) {
+        if (i != CF_REPOPID) {
+            cfs.push_back(handles[i]);
+        }
+    }
+    return cfs;
+}
+
+/*
+ * keys of different column families never collide, so the smallest current
+ * key of the children is the next one. forward only.
+ */
+class DataMergingIterator : public leveldb::Iterator {
+public:
+    explicit DataMergingIterator(std::vector<leveldb::Iterator *> children) : children(std::move(children)) {}
+
+    ~DataMergingIterator() override {
+        for (auto it : children) {
+            delete it;
+        }
+    }
+
+    bool Valid() const override { return current != nullptr; }
+
+    void SeekToFirst() override {
+        for (auto it : children) {
+            it->SeekToFirst();
+        }
+        pick();
+    }
+
+    void Seek(const leveldb::Slice &target) override {
+        for (auto it : children) {
+            it->Seek(target);
+        }
+        pick();
+    }
+
+    void Next() override {
+        current->Next();
+        pick();
+    }
+
+    void SeekToLast() override { unsupported(); }
+
+    void SeekForPrev(const leveldb::Slice &target) override { unsupported(); }
+
+    void Prev() override { unsupported(); }
+
+    leveldb::Slice key() const override { return current->key(); }
+
+    leveldb::Slice value() const override { return current->value(); }
+
+    leveldb::Status status() const override {
+        if (!s.ok()) {
+            return s;
+        }
+        for (auto it : children) {
+            if (!it->status().ok()) {
+                return it->status();
+            }
+        }
+        return leveldb::Status::OK();
+    }
+
+private:
+    std::vector<leveldb::Iterator *> children;
+    leveldb::Iterator *current = nullptr;
+    leveldb::Status s;
+
+    void pick() {
+        current = nullptr;
+        for (auto it : children) {
+            if (it->Valid() && (current == nullptr || it->key().compare(current->key()) < 0)) {
+                current = it;
+            }
+        }
+    }
+
+    void unsupported() {
+        current = nullptr;
+        s = leveldb::Status::NotSupported("reverse iteration over data column families");
+    }
+};
+
+leveldb::Iterator *SSDBImpl::newDataIterator(const leveldb::ReadOptions &read_options) {
+    leveldb::ReadOptions options = read_options;
+    options.total_order_seek = true;
+
+    if (handles.size() <= CF_META) {
+        return ldb->NewIterator(options, handles[CF_DEFAULT]);
+    }
+
+    std::vector<leveldb::Iterator *> children;
+    leveldb::Status s = ldb->NewIterators(options, dataHandles(), &children);
+    if (!s.ok()) {
+        log_error("new iterators error: %s", s.ToString().c_str());
+        return leveldb::NewErrorIterator(s);
+    }
+    return new DataMergingIterator(std::move(children));
+}
+
+/*
+ * callers build batches against the default column family, split them by key
+ * class. entries of other column families (repopid) are kept where they are.
+ */
+class ClassBatchRouter : public leveldb::WriteBatch::Handler {
+public:
+    ClassBatchRouter(const SSDBImpl *db, leveldb::WriteBatch *out) : db(db), out(out) {}
+
+    leveldb::Status PutCF(uint32_t id, const leveldb::Slice &key, const leveldb::Slice &value) override {
+        return out->Put(route(id, key), key, value);
+    }
+
+    leveldb::Status DeleteCF(uint32_t id, const leveldb::Slice &key) override {
+        return out->Delete(route(id, key), key);
+    }
+
+    leveldb::Status SingleDeleteCF(uint32_t id, const leveldb::Slice &key) override {
+        return out->SingleDelete(route(id, key), key);
+    }
+
+    // ranges built by callers never cross a key class
+    leveldb::Status DeleteRangeCF(uint32_t id, const leveldb::Slice &begin, const leveldb::Slice &end) override {
+        return out->DeleteRange(route(id, begin), begin, end);
+    }
+
+    leveldb::Status MergeCF(uint32_t id, const leveldb::Slice &key, const leveldb::Slice &value) override {
+        return out->Merge(route(id, key), key, value);
+    }
+
+    void LogData(const leveldb::Slice &blob) override {
+        out->PutLogData(blob);
+    }
+
+private:
+    const SSDBImpl *db;
+    leveldb::WriteBatch *out;
+
+    leveldb::ColumnFamilyHandle *route(uint32_t id, const leveldb::Slice &key) {
+        if (id == 0) {
+            return db->cfOf(key);
+        }
+        for (auto handle : db->handles) {
+            if (handle->GetID() == id) {
+                return handle;
+            }
+        }
+        return db->handles[CF_DEFAULT];
+    }
+};
+
+leveldb::Status SSDBImpl::ldbWrite(const leveldb::WriteOptions &options, leveldb::WriteBatch *updates) {
+    if (!cf_per_class) {
+        return ldb->Write(options, updates);
+    }
+
+    leveldb::WriteBatch routed(updates->GetDataSize());
+    ClassBatchRouter router(this, &routed);
+    leveldb::Status s = updates->Iterate(&router);
+    if (!s.ok()) {
+        return s;
+    }
+    return ldb->Write(options, &routed);
+}
+
+int SSDBImpl::ldbMultiGet(const leveldb::ReadOptions &options, const std::vector<std::string> &keys,
+                          std::vector<std::string> *values, std::vector<int> *found) {
+    values->assign(keys.size(), std::string());
+    found->assign(keys.size(), 0);
+    if (keys.empty()) {
+        return 0;
+    }
+
+    // sorted probes walk the same data blocks once
+    std::vector<size_t> order(keys.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&keys](size_t a, size_t b) {
+        return keys[a] < keys[b];
+    });
+
+    std::vector<leveldb::ColumnFamilyHandle *> cfs;
+    std::vector<leveldb::Slice> slices;
+    cfs.reserve(keys.size());
+    slices.reserve(keys.size());
+    for (size_t i : order) {
+        slices.emplace_back(keys[i]);
+        cfs.push_back(cfOf(slices.back()));
+    }
+
+    std::vector<std::string> vals;
+    std::vector<leveldb::Status> ss = ldb->MultiGet(options, cfs, slices, &vals);
+    for (size_t j = 0; j < order.size(); j++) {
+        if (ss[j].IsNotFound()) {
+            continue;
+        }
+        if (!ss[j].ok()) {
+            log_error("ldbMultiGet error: %s", ss[j].ToString().c_str());
+            return STORAGE_ERR;
+        }
+        (*found)[order[j]] = 1;
+        (*values)[order[j]].swap(vals[j]);
+    }
+    return 0;
+}
+
+/*
+ * the key format is fixed when the data dir is created and kept in the repo
+ * column family; a dir without the marker but with data predates it and is plain.
+ */
+int SSDBImpl::checkKeyFormat(int format) {
+    std::string val;
+    int stored = KEY_FORMAT_PLAIN;
+
+    leveldb::Status s = ldb->Get(leveldb::ReadOptions(), handles[1], encode_key_format_key(), &val);
+    if (s.ok()) {
+        stored = str_to_int(val);
+    } else if (s.IsNotFound()) {
+        std::unique_ptr<leveldb::Iterator> it(newDataIterator(leveldb::ReadOptions()));
+        it->SeekToFirst();
+        stored = it->Valid() ? KEY_FORMAT_PLAIN : format;
+
+        s = ldb->Put(leveldb::WriteOptions(), handles[1], encode_key_format_key(), str(stored));
+        if (!s.ok()) {
+            log_error("save key format error: %s", s.ToString().c_str());
+            return -1;
+        }
+    } else {
+        log_error("get key format error: %s", s.ToString().c_str());
+        return -1;
+    }
+
+    if (stored != format) {
+        log_error("data dir uses key format %d but key_slot_prefix asks for %d, convert it with ssdb-keyformat first",
+                  stored, format);
+        return -1;
+    }
+
+    set_key_format(stored);
+    log_info("key format: %s", stored == KEY_FORMAT_SLOT ? "slot prefixed" : "plain");
+
+    return 0;
+}
+
 int SSDBImpl::filesize(Context &ctx, uint64_t *total_file_size) {
     if (!is_dir(getDataPath())) {
         return -1;
@@ -210,6 +665,116 @@ int SSDBImpl::filesize(Context &ctx, uint64_t *total_file_size) {
     return (int) result.size();
 }
 
+int SSDBImpl::removeDir(const std::string &dir) {
+    if (!is_dir(dir)) {
+        return 0;
+    }
+
+    // data dirs and checkpoints are flat
+    leveldb::Env *env = leveldb::Env::Default();
+    std::vector<std::string> children;
+    leveldb::Status s = env->GetChildren(dir, &children);
+    if (!s.ok()) {
+        log_error("list %s error: %s", dir.c_str(), s.ToString().c_str());
+        return -1;
+    }
+    for (const auto &child : children) {
+        if (child == "." || child == "..") {
+            continue;
+        }
+        env->DeleteFile(dir + "/" + child);
+    }
+    s = env->DeleteDir(dir);
+    if (!s.ok()) {
+        log_error("remove %s error: %s", dir.c_str(), s.ToString().c_str());
+        return -1;
+    }
+    return 0;
+}
+
+int SSDBImpl::checkpoint(const std::string &dir, const leveldb::Snapshot **snapshot) {
+    if (removeDir(dir) != 0) {
+        return STORAGE_ERR;
+    }
+
+    leveldb::Checkpoint *cp = nullptr;
+    leveldb::Status s = leveldb::Checkpoint::Create(ldb, &cp);
+    if (!s.ok()) {
+        log_error("create checkpoint error: %s", s.ToString().c_str());
+        return STORAGE_ERR;
+    }
+    std::unique_ptr<leveldb::Checkpoint> cp_guard(cp);
+
+    Locking<RecordKeyMutex> gl(&mutex_record_);
+
+    // log_size_for_flush 0 : always flush memtable, the checkpoint needs no wal replay
+    s = cp->CreateCheckpoint(dir, 0);
+    if (!s.ok()) {
+        log_error("create checkpoint %s error: %s", dir.c_str(), s.ToString().c_str());
+        removeDir(dir);
+        return STORAGE_ERR;
+    }
+    if (snapshot != nullptr) {
+        *snapshot = ldb->GetSnapshot();
+    }
+
+    log_info("checkpoint created at %s", dir.c_str());
+    return 0;
+}
+
+/*
+ * data dir is swapped under the global lock, caller should have stopped the
+ * bg tasks and expiration like a full sync does.
+ */
+int SSDBImpl::reopen(Context &ctx, const std::string &dir) {
+    Locking<RecordKeyMutex> gl(&mutex_record_);
+
+    redisCursorService.ClearAllCursor();
+
+    closeLdb();
+
+    std::string data_dir = path + "/data";
+    std::string old_dir = path + "/data.old";
+    std::string new_dir = dir;
+    if (!new_dir.empty() && new_dir.back() == '/') {
+        new_dir.pop_back();
+    }
+
+    int ret = 0;
+    removeDir(old_dir);
+    if (rename(data_dir.c_str(), old_dir.c_str()) != 0) {
+        log_error("rename %s to %s error: %s", data_dir.c_str(), old_dir.c_str(), strerror(errno));
+        ret = STORAGE_ERR;
+    } else if (rename(new_dir.c_str(), data_dir.c_str()) != 0) {
+        log_error("rename %s to %s error: %s", new_dir.c_str(), data_dir.c_str(), strerror(errno));
+        rename(old_dir.c_str(), data_dir.c_str());
+        ret = STORAGE_ERR;
+    }
+
+    leveldb::Status s = openLdb();
+    if (!s.ok() && ret == 0) {
+        log_error("open received data dir failed: %s, restore the old one", s.ToString().c_str());
+        removeDir(data_dir);
+        rename(old_dir.c_str(), data_dir.c_str());
+        ret = STORAGE_ERR;
+        s = openLdb();
+    }
+    if (!s.ok()) {
+        log_fatal("reopen db failed: %s", s.ToString().c_str());
+        exit(1);
+    }
+
+    if (ret == 0) {
+        removeDir(old_dir);
+        if (checkKeyFormat(get_key_format()) != 0) {
+            return KEY_FORMAT_ERR;
+        }
+        log_info("reopened db with %s", dir.c_str());
+    }
+
+    return ret;
+}
+
 int SSDBImpl::resetRepopid(Context &ctx) {
 
     leveldb::WriteBatch updates;
@@ -251,14 +816,17 @@ int SSDBImpl::flushdb(Context &ctx) {
     log_info("[flushdb] using DeleteFilesInRange");
     leveldb::Slice begin("0");
     leveldb::Slice end("~");
-    leveldb::DeleteFilesInRange(ldb, ldb->DefaultColumnFamily(), &begin, &end);
+    for (auto cf : dataHandles()) {
+        leveldb::DeleteFilesInRange(ldb, cf, &begin, &end);
+    }
     PTE(flushdb, "DeleteFilesInRange")
 
     if (ROCKSDB_MAJOR >= 5) {
         log_info("[flushdb] using DeleteRange");
-
-        ldb->DeleteRange(leveldb::WriteOptions(), ldb->DefaultColumnFamily(), begin, end);
-        ldb->Flush(leveldb::FlushOptions(), ldb->DefaultColumnFamily());
+        for (auto cf : dataHandles()) {
+            ldb->DeleteRange(leveldb::WriteOptions(), cf, begin, end);
+            ldb->Flush(leveldb::FlushOptions(), cf);
+        }
         PTE(flushdb, "DeleteRange")
 
     }
@@ -278,8 +846,7 @@ int SSDBImpl::flushdb(Context &ctx) {
     write_opts.disableWAL = true;
 #endif
 
-    unique_ptr<leveldb::Iterator> it = unique_ptr<leveldb::Iterator>(
-            ldb->NewIterator(iterate_options, ldb->DefaultColumnFamily()));
+    unique_ptr<leveldb::Iterator> it = unique_ptr<leveldb::Iterator>(newDataIterator(iterate_options));
 
     it->SeekToFirst();
 
@@ -298,7 +865,7 @@ int SSDBImpl::flushdb(Context &ctx) {
             it->Next();
         }
 
-        leveldb::Status s = ldb->Write(write_opts, &writeBatch);
+        leveldb::Status s = ldbWrite(write_opts, &writeBatch);
         if (!s.ok()) {
             log_error("del error: %s", s.ToString().c_str());
             stop = true;
@@ -311,7 +878,9 @@ int SSDBImpl::flushdb(Context &ctx) {
 
 #ifdef USE_LEVELDB
 #else
-    ldb->Flush(leveldb::FlushOptions());
+    for (auto cf : dataHandles()) {
+        ldb->Flush(leveldb::FlushOptions(), cf);
+    }
     write_opts.disableWAL = false;
     PTE(flushdb, "Iteration Flush")
 #endif
@@ -329,28 +898,66 @@ int SSDBImpl::flushdb(Context &ctx) {
     return ret;
 }
 
+/*
+ * a scan starting inside one collection stays inside it and can use the
+ * prefix bloom filters, anything else needs a total order seek.
+ */
+static void set_seek_mode(const std::string &start, leveldb::ReadOptions *options) {
+    if (collection_prefix_size(start.data(), start.size(), get_key_format()) > 0) {
+        options->prefix_same_as_start = true;
+    } else {
+        options->total_order_seek = true;
+    }
+}
+
+/*
+ * the keys a scan from start can reach: its collection, or its key type for
+ * keys outside any collection. scans stop there at the storage layer instead
+ * of stepping over tombstones of deleted collections.
+ */
+static std::string scan_scope(const std::string &start) {
+    int size = collection_prefix_size(start.data(), start.size(), get_key_format());
+    return start.substr(0, size > 0 ? (size_t) size : std::min(start.size(), (size_t) 1));
+}
+
+// smallest key after all keys starting with prefix, empty if there is none
+static std::string prefix_end(std::string prefix) {
+    while (!prefix.empty()) {
+        if ((unsigned char) prefix.back() != 0xff) {
+            prefix.back()++;
+            return prefix;
+        }
+        prefix.pop_back();
+    }
+    return prefix;
+}
+
 Iterator *SSDBImpl::iterator(const std::string &start, const std::string &end, uint64_t limit,
                              const leveldb::Snapshot *snapshot) {
-    leveldb::Iterator *it;
     leveldb::ReadOptions iterate_options;
     iterate_options.fill_cache = false;
     if (snapshot) {
         iterate_options.snapshot = snapshot;
     }
-    it = ldb->NewIterator(iterate_options);
-    it->Seek(start);
-//	if(it->Valid() && it->key() == start){
-//		it->Next();
-//	}
-    return new Iterator(it, end, limit, Iterator::FORWARD, iterate_options.snapshot);
+    return iterator(start, end, limit, iterate_options);
 }
 
 Iterator *SSDBImpl::iterator(const std::string &start, const std::string &end, uint64_t limit,
-                             const leveldb::ReadOptions &iterate_options) {
+                             const leveldb::ReadOptions &read_options) {
     leveldb::Iterator *it;
-    it = ldb->NewIterator(iterate_options);
+    leveldb::ReadOptions iterate_options = read_options;
+    set_seek_mode(start, &iterate_options);
+
+    // Iterator stops after end, the first key past it is end + '\0'
+    auto *bounds = new IteratorBounds("", end.empty() ? prefix_end(scan_scope(start)) : end + '\0');
+    bounds->apply(&iterate_options);
+
+    it = start.empty() ? newDataIterator(iterate_options) : ldb->NewIterator(iterate_options, cfOf(start));
     it->Seek(start);
-    return new Iterator(it, end, limit, Iterator::FORWARD, iterate_options.snapshot);
+//	if(it->Valid() && it->key() == start){
+//		it->Next();
+//	}
+    return new Iterator(it, end, limit, Iterator::FORWARD, iterate_options.snapshot, bounds);
 }
 
 Iterator *SSDBImpl::rev_iterator(const std::string &start, const std::string &end, uint64_t limit,
@@ -361,7 +968,13 @@ Iterator *SSDBImpl::rev_iterator(const std::string &start, const std::string &en
     if (snapshot) {
         iterate_options.snapshot = snapshot;
     }
-    it = ldb->NewIterator(iterate_options);
+    iterate_options.total_order_seek = true; // SeekToLast and Prev need the total order
+
+    std::string scope = scan_scope(start);
+    auto *bounds = new IteratorBounds(end.empty() ? scope : end, prefix_end(scope));
+    bounds->apply(&iterate_options);
+
+    it = ldb->NewIterator(iterate_options, cfOf(start));
     it->Seek(start);
     if (!it->Valid()) {
         it->SeekToLast();
@@ -370,7 +983,7 @@ Iterator *SSDBImpl::rev_iterator(const std::string &start, const std::string &en
             it->Prev();
         }
     }
-    return new Iterator(it, end, limit, Iterator::BACKWARD, iterate_options.snapshot);
+    return new Iterator(it, end, limit, Iterator::BACKWARD, iterate_options.snapshot, bounds);
 }
 
 const leveldb::Snapshot *SSDBImpl::GetSnapshotWithLock() {
@@ -398,7 +1011,7 @@ void SSDBImpl::ReleaseSnapshot(const leveldb::Snapshot *snapshot = nullptr) {
 
 int SSDBImpl::raw_set(Context &ctx, const Bytes &key, const Bytes &val) {
     leveldb::WriteOptions write_opts;
-    leveldb::Status s = ldb->Put(write_opts, slice(key), slice(val));
+    leveldb::Status s = ldb->Put(write_opts, cfOf(slice(key)), slice(key), slice(val));
     if (!s.ok()) {
         log_error("set error: %s", s.ToString().c_str());
         return -1;
@@ -408,7 +1021,7 @@ int SSDBImpl::raw_set(Context &ctx, const Bytes &key, const Bytes &val) {
 
 int SSDBImpl::raw_del(Context &ctx, const Bytes &key) {
     leveldb::WriteOptions write_opts;
-    leveldb::Status s = ldb->Delete(write_opts, slice(key));
+    leveldb::Status s = ldb->Delete(write_opts, cfOf(slice(key)), slice(key));
     if (!s.ok()) {
         log_error("del error: %s", s.ToString().c_str());
         return -1;
@@ -417,7 +1030,7 @@ int SSDBImpl::raw_del(Context &ctx, const Bytes &key) {
 }
 
 int SSDBImpl::raw_get(Context &ctx, const Bytes &key, std::string *val) {
-    return raw_get(ctx, key, handles[0], val);
+    return raw_get(ctx, key, cfOf(slice(key)), val);
 }
 
 int SSDBImpl::raw_get(Context &ctx, const Bytes &key, leveldb::ColumnFamilyHandle *column_family, std::string *val) {
@@ -445,10 +1058,14 @@ uint64_t SSDBImpl::size() {
         ldb->GetApproximateSizes(ranges, 1, sizes);
         return (sizes[0] / 18);
 #else
-    std::string num = "0";
-    ldb->GetProperty("rocksdb.estimate-num-keys", &num);
+    uint64_t total = 0;
+    for (auto cf : dataHandles()) {
+        std::string num = "0";
+        ldb->GetProperty(cf, "rocksdb.estimate-num-keys", &num);
+        total += Bytes(num).Uint64();
+    }
 
-    return Bytes(num).Uint64();
+    return total;
 #endif
 
 }
@@ -513,6 +1130,23 @@ std::vector<std::string> SSDBImpl::info() {
         }
     }
 
+#ifndef USE_LEVELDB
+    if (handles.size() > CF_META) {
+        for (auto cf : dataHandles()) {
+            for (const std::string &key : {leveldb::DB::Properties::kEstimateNumKeys,
+                                           leveldb::DB::Properties::kTotalSstFilesSize,
+                                           leveldb::DB::Properties::kCurSizeAllMemTables,
+                                           leveldb::DB::Properties::kEstimateTableReadersMem}) {
+                std::string val;
+                if (ldb->GetProperty(cf, key, &val)) {
+                    info.push_back(cf->GetName() + "." + key);
+                    info.push_back(val);
+                }
+            }
+        }
+    }
+#endif
+
     info.push_back("");
 
 
@@ -524,7 +1158,9 @@ void SSDBImpl::compact() {
     ldb->CompactRange(NULL, NULL);
 #else
     leveldb::CompactRangeOptions compactRangeOptions = rocksdb::CompactRangeOptions();
-    ldb->CompactRange(compactRangeOptions, NULL, NULL);
+    for (auto cf : dataHandles()) {
+        ldb->CompactRange(compactRangeOptions, cf, NULL, NULL);
+    }
 #endif
 }
 
@@ -545,7 +1181,16 @@ SSDBImpl::CommitBatch(Context &ctx, const leveldb::WriteOptions &options, leveld
                      encode_repo_item(ctx.currentSeqCnx.timestamp, ctx.currentSeqCnx.id));
 
     }
-    leveldb::Status s = ldb->Write(options, updates);
+    leveldb::Status s;
+    if (group_commit) {
+        s = groupCommit(options, updates);
+    } else {
+        double start = millitime();
+        leveldb::WriteOptions write_opts = options;
+        write_opts.sync = options.sync || commit_sync;
+        s = ldbWrite(write_opts, updates);
+        commit_stats.add(1, (uint64_t) ((millitime() - start) * 1000 * 1000));
+    }
 
     if (ctx.replLink) {
         ctx.setFirstbatch(false);
@@ -554,6 +1199,111 @@ SSDBImpl::CommitBatch(Context &ctx, const leveldb::WriteOptions &options, leveld
     return s;
 }
 
+struct SSDBImpl::CommitWriter {
+    leveldb::WriteBatch *batch;
+    bool sync;
+    bool disableWAL;
+    bool done = false;
+    leveldb::Status status;
+    CondVar cv;
+
+    explicit CommitWriter(Mutex *mu) : cv(mu) {}
+};
+
+// a leader stops merging followers beyond this many bytes
+static const size_t MAX_COMMIT_GROUP_SIZE = 1024 * 1024;
+
+// WriteBatch rep: fixed64 sequence, fixed32 count, records
+static const size_t WRITE_BATCH_HEADER = 12;
+
+static void appendBatchRep(std::string *rep, const leveldb::WriteBatch &batch) {
+    const std::string &data = batch.Data();
+    if (data.size() <= WRITE_BATCH_HEADER) {
+        return;
+    }
+    uint32_t count = 0;
+    for (int i = 3; i >= 0; i--) {
+        count = (count << 8) | (uint8_t) (*rep)[8 + i];
+    }
+    count += batch.Count();
+    for (int i = 0; i < 4; i++) {
+        (*rep)[8 + i] = (char) ((count >> (8 * i)) & 0xff);
+    }
+    rep->append(data.data() + WRITE_BATCH_HEADER, data.size() - WRITE_BATCH_HEADER);
+}
+
+/*
+ * commits are queued in arrival order. the writer at the head of the queue
+ * writes its batch together with the ones queued behind it, so a link's
+ * batches, repopid included, still reach the db in the order they came.
+ */
+leveldb::Status SSDBImpl::groupCommit(const leveldb::WriteOptions &options, leveldb::WriteBatch *updates) {
+    double start = millitime();
+
+    CommitWriter w(&mutex_commit_);
+    w.batch = updates;
+    w.sync = options.sync || commit_sync;
+    w.disableWAL = options.disableWAL;
+
+    mutex_commit_.lock();
+    commit_queue_.push_back(&w);
+    while (!w.done && &w != commit_queue_.front()) {
+        w.cv.wait();
+    }
+    if (w.done) {
+        mutex_commit_.unlock();
+        return w.status;
+    }
+
+    // a follower joins if it needs no more durability than the leader gives
+    std::string rep;
+    size_t size = 1;
+    size_t bytes = updates->GetDataSize();
+    for (auto it = commit_queue_.begin() + 1; it != commit_queue_.end(); ++it) {
+        CommitWriter *f = *it;
+        if (f->disableWAL != w.disableWAL || (f->sync && !w.sync)) {
+            break;
+        }
+        bytes += f->batch->GetDataSize();
+        if (bytes > MAX_COMMIT_GROUP_SIZE) {
+            break;
+        }
+        if (size == 1) {
+            rep = updates->Data();
+        }
+        appendBatchRep(&rep, *f->batch);
+        size++;
+    }
+    mutex_commit_.unlock();
+
+    leveldb::WriteOptions write_opts = options;
+    write_opts.sync = w.sync;
+    leveldb::Status s;
+    if (size == 1) {
+        s = ldbWrite(write_opts, updates);
+    } else {
+        leveldb::WriteBatch group(rep);
+        s = ldbWrite(write_opts, &group);
+    }
+
+    mutex_commit_.lock();
+    commit_queue_.pop_front();
+    for (size_t i = 1; i < size; i++) {
+        CommitWriter *f = commit_queue_.front();
+        commit_queue_.pop_front();
+        f->status = s;
+        f->done = true;
+        f->cv.signal();
+    }
+    if (!commit_queue_.empty()) {
+        commit_queue_.front()->cv.signal();
+    }
+    mutex_commit_.unlock();
+
+    commit_stats.add(size, (uint64_t) ((millitime() - start) * 1000 * 1000));
+    return s;
+}
+
 leveldb::Status SSDBImpl::CommitBatch(Context &ctx, leveldb::WriteBatch *updates) {
 
     return CommitBatch(ctx, leveldb::WriteOptions(), updates);
@@ -562,29 +1312,42 @@ leveldb::Status SSDBImpl::CommitBatch(Context &ctx, leveldb::WriteBatch *updates
 
 
 void SSDBImpl::start() {
+    if (!bg_tids_.empty()) {
+        return;
+    }
     this->bgtask_quit = false;
-    int err = pthread_create(&bg_tid_, NULL, &thread_func, this);
-    if (err != 0) {
-        log_fatal("can't create thread: %s", strerror(err));
-        exit(0);
+    for (int i = 0; i < delete_threads; i++) {
+        pthread_t tid;
+        int err = pthread_create(&tid, NULL, &thread_func, this);
+        if (err != 0) {
+            log_fatal("can't create thread: %s", strerror(err));
+            exit(0);
+        }
+        bg_tids_.push_back(tid);
     }
 }
 
 void SSDBImpl::stop() {
     log_info("del thread stopping");
 
-    if (this->bgtask_quit) {
+    if (bg_tids_.empty()) {
         return;
     }
 
-    this->bgtask_quit = true;
-    for (int i = 0; i < 500; i++) {
-        if (!bgtask_quit) {
-            break;
-        }
-        log_info("waiting for del thread stop");
-        usleep(1000 * 1000);
+    {
+        Locking<Mutex> l(&this->mutex_bgtask_);
+        this->bgtask_quit = true;
+        bgtask_cv_.signalAll();
+    }
+    for (pthread_t tid : bg_tids_) {
+        pthread_join(tid, NULL);
     }
+    bg_tids_.clear();
+
+    Locking<Mutex> l(&this->mutex_bgtask_);
+    std::queue<std::string> tmp_tasks_;
+    tasks_.swap(tmp_tasks_);
+    delete_stats.queued = 0;
 
     log_info("del thread stopped");
 }
@@ -597,6 +1360,10 @@ void SSDBImpl::load_delete_keys_from_db(int num) {
         if (it->key().String()[0] != DataType::DELETE) {
             break;
         }
+        // still being deleted by another thread
+        if (deleting_.count(it->key().String()) > 0) {
+            continue;
+        }
         tasks_.push(it->key().String());
     }
 }
@@ -604,7 +1371,7 @@ void SSDBImpl::load_delete_keys_from_db(int num) {
 int SSDBImpl::delete_meta_key(const DeleteKey &dk, leveldb::WriteBatch &batch) {
     std::string meta_key = encode_meta_key(dk.key);
     std::string meta_val;
-    leveldb::Status s = ldb->Get(leveldb::ReadOptions(), meta_key, &meta_val);
+    leveldb::Status s = ldbGet(leveldb::ReadOptions(), meta_key, &meta_val);
     if (!s.ok() && !s.IsNotFound()) {
         return -1;
     } else if (s.ok()) {
@@ -629,6 +1396,52 @@ int SSDBImpl::delete_meta_key(const DeleteKey &dk, leveldb::WriteBatch &batch) {
     return 0;
 }
 
+// collections with more items than this lose them with one DeleteRange
+static const size_t DELETE_RANGE_MIN_ITEMS = 1000;
+
+void SSDBImpl::throttle_delete(uint64_t items) {
+    if (delete_rate <= 0 || items == 0) {
+        return;
+    }
+    // every thread takes its share of the budget
+    usleep((useconds_t) (items * 1000 * 1000 * delete_threads / delete_rate));
+}
+
+/*
+ * items of one collection version share a key prefix. small collections are
+ * deleted key by key, the rest with a single range tombstone instead of one
+ * point tombstone per item, compaction drops the covered files as a whole.
+ * @return number of items, or -1 on error
+ */
+int SSDBImpl::delete_prefix(const std::string &prefix, leveldb::WriteBatch &batch) {
+    std::string end = prefix_end(prefix);
+    leveldb::Slice upper(end);
+    leveldb::ReadOptions read_opts;
+    read_opts.fill_cache = false;
+    read_opts.iterate_upper_bound = &upper;
+
+    std::unique_ptr<leveldb::Iterator> it(ldb->NewIterator(read_opts, cfOf(prefix)));
+    std::vector<std::string> keys;
+    for (it->Seek(prefix); it->Valid() && keys.size() <= DELETE_RANGE_MIN_ITEMS; it->Next()) {
+        keys.push_back(it->key().ToString());
+    }
+    if (!it->status().ok()) {
+        log_error("iterate %s error: %s", hexstr(prefix).c_str(), it->status().ToString().c_str());
+        return -1;
+    }
+
+    if (keys.size() > DELETE_RANGE_MIN_ITEMS) {
+        batch.DeleteRange(prefix, end);
+        delete_stats.ranges++;
+    } else {
+        for (const auto &key : keys) {
+            batch.Delete(key);
+        }
+        delete_stats.items += keys.size();
+    }
+    return (int) keys.size();
+}
+
 void SSDBImpl::delete_key_loop(const std::string &del_key) {
     DeleteKey dk;
     if (dk.DecodeDeleteKey(del_key) == -1) {
@@ -637,96 +1450,77 @@ void SSDBImpl::delete_key_loop(const std::string &del_key) {
     }
 
     log_debug("deleting key %s , version %d ", hexstr(dk.key).c_str(), dk.version);
-//    char log_type=BinlogType::SYNC;
-    std::string start = encode_hash_key(dk.key, "", dk.version);
-    std::string z_start = encode_zscore_prefix(dk.key, dk.version);
 
+    // items, zset scores and zset rank index
+    const std::string prefixes[] = {
+            encode_hash_key(dk.key, "", dk.version),
+            encode_zscore_prefix(dk.key, dk.version),
+            encode_zrank_prefix(dk.key, dk.version),
+    };
 
-    auto it = std::unique_ptr<Iterator>(this->iterator(start, "", -1));
     leveldb::WriteBatch batch;
-    while (it->next()) {
-        if (it->key().empty() || it->key().data()[0] != DataType::ITEM) {
-            break;
-        }
-
-        ItemKey ik;
-        Bytes item_key = it->key();
-        if (ik.DecodeItemKey(item_key) == -1) {
-            log_fatal("decode delete key error! %s", hexstr(item_key).c_str());
-            break;
-        }
-        if (ik.key == dk.key && ik.version == dk.version) {
-            batch.Delete(slice(item_key));
-        } else {
-            break;
+    uint64_t items = 0;
+    for (const auto &prefix : prefixes) {
+        int n = delete_prefix(prefix, batch);
+        if (n == -1) {
+            log_fatal("delete items error! %s", hexstr(del_key).c_str());
+            return;
         }
+        items += n;
     }
 
-    //clean z*
-    auto zit = std::unique_ptr<Iterator>(this->iterator(z_start, "", -1));
-    while (zit->next()) {
-        if (zit->key().empty() || zit->key().data()[0] != DataType::ZSCORE) {
-            break;
+    batch.Delete(del_key);
+    {
+        RecordKeyLock l(&mutex_record_, dk.key);
+        if (delete_meta_key(dk, batch) == -1) {
+            log_fatal("delete meta key error! %s", hexstr(del_key).c_str());
+            return;
         }
 
-        ZScoreItemKey zk;
-        Bytes item_key = zit->key();
-        if (zk.DecodeItemKey(item_key) == -1) {
-            log_fatal("decode delete key error! %s", hexstr(item_key).c_str());
-            break;
-        }
-        if (zk.key == dk.key && zk.version == dk.version) {
-            batch.Delete(slice(item_key));
-        } else {
-            break;
+        leveldb::WriteOptions write_opts;
+        leveldb::Status s = ldbWrite(write_opts, &batch);
+        if (!s.ok()) {
+            log_fatal("SSDBImpl::delKey Backend Task error! %s", hexstr(del_key).c_str());
+            return;
         }
     }
+    delete_stats.keys++;
 
-    batch.Delete(del_key);
-    RecordKeyLock l(&mutex_record_, dk.key);
-    if (delete_meta_key(dk, batch) == -1) {
-        log_fatal("delete meta key error! %s", hexstr(del_key).c_str());
-        return;
-    }
-
-    leveldb::WriteOptions write_opts;
-//    write_opts.disableWAL = true;
-    leveldb::Status s = ldb->Write(write_opts, &batch);
-    if (!s.ok()) {
-        log_fatal("SSDBImpl::delKey Backend Task error! %s", hexstr(del_key).c_str());
-        return;
-    }
+    throttle_delete(items);
 }
 
 void SSDBImpl::runBGTask() {
     while (!bgtask_quit) {
-        mutex_bgtask_.lock();
-        if (tasks_.empty()) {
-            load_delete_keys_from_db(1000);
+        std::string del_key;
+        {
+            Locking<Mutex> l(&this->mutex_bgtask_);
             if (tasks_.empty()) {
-                mutex_bgtask_.unlock();
-                usleep(1000 * 1000);
+                load_delete_keys_from_db(1000);
+            }
+            if (tasks_.empty()) {
+                delete_stats.queued = 0;
+                if (!bgtask_quit) {
+                    bgtask_cv_.waitFor(1, 0);
+                }
                 continue;
             }
-        }
 
-        std::string del_key;
-        if (!tasks_.empty()) {
             del_key = tasks_.front();
             tasks_.pop();
+            deleting_.insert(del_key);
+            delete_stats.queued = tasks_.size();
+            delete_stats.running = deleting_.size();
         }
-        mutex_bgtask_.unlock();
 
-        if (!del_key.empty()) {
-            delete_key_loop(del_key);
-            sched_yield();
+        delete_key_loop(del_key);
+
+        {
+            Locking<Mutex> l(&this->mutex_bgtask_);
+            deleting_.erase(del_key);
+            delete_stats.running = deleting_.size();
         }
+        sched_yield();
     }
-
-    Locking<Mutex> l(&this->mutex_bgtask_);
-    std::queue<std::string> tmp_tasks_;
-    tasks_.swap(tmp_tasks_);
-    bgtask_quit = false;
 }
 
 void *SSDBImpl::thread_func(void *arg) {
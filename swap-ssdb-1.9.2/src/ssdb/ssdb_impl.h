@@ -7,6 +7,8 @@ found in the LICENSE file.
 #define SSDB_IMPL_H_
 
 #include <queue>
+#include <deque>
+#include <set>
 #include <atomic>
 #include "include.h"
 #include "common/context.hpp"
@@ -46,6 +48,7 @@ found in the LICENSE file.
 #include "ttl.h"
 #include "t_cursor.h"
 #include "t_scan.h"
+#include "t_compaction.h"
 
 
 inline
@@ -64,6 +67,21 @@ static leveldb::Slice slice(){
 
 const static std::string REPOPID_CF = "repopid";
 
+// column families of the data classes, only used with rocksdb.cf_per_class.
+// items and anything unlisted stay in the default column family
+const static std::string META_CF = "meta";
+const static std::string ZSET_CF = "zset";     // zscore and zrank
+const static std::string EXPIRE_CF = "expire"; // escore and ekey
+const static std::string DELETE_CF = "delete";
+
+// index in SSDBImpl::handles
+const static int CF_DEFAULT = 0;
+const static int CF_REPOPID = 1;
+const static int CF_META = 2;
+const static int CF_ZSET = 3;
+const static int CF_EXPIRE = 4;
+const static int CF_DELETE = 5;
+
 enum LIST_POSITION{
 	HEAD,
 	TAIL,
@@ -77,6 +95,44 @@ enum DIRECTION{
 typedef RecordLock<Mutex> RecordKeyLock;
 typedef RecordMutex<Mutex> RecordKeyMutex;
 
+// pending count changes of zset rank index nodes, keyed by encoded node key
+typedef std::map<std::string, int64_t> ZRankDelta;
+
+// rank index levels, one per byte of the encoded score
+const static uint8_t ZRANK_INDEX_LEVELS = 8;
+
+// write groups of CommitBatch, one ldb write each
+class CommitStats {
+public:
+	std::atomic<uint64_t> groups{0};
+	std::atomic<uint64_t> batches{0};
+	std::atomic<uint64_t> max_group{0};
+	std::atomic<uint64_t> time{0}; //us, from commit until written
+	std::atomic<uint64_t> max_time{0}; //us
+
+	void add(uint64_t size, uint64_t latency) {
+		groups++;
+		batches += size;
+		time += latency;
+
+		uint64_t max = max_group.load();
+		while (size > max && !max_group.compare_exchange_weak(max, size)) {
+		}
+		max = max_time.load();
+		while (latency > max && !max_time.compare_exchange_weak(max, latency)) {
+		}
+	}
+};
+
+// progress of the background deletion of collections
+class DeleteStats {
+public:
+	std::atomic<uint64_t> queued{0};   //delete keys loaded and waiting
+	std::atomic<uint64_t> running{0};  //collections being deleted
+	std::atomic<uint64_t> keys{0};     //collections deleted
+	std::atomic<uint64_t> items{0};    //items deleted one by one
+	std::atomic<uint64_t> ranges{0};   //item prefixes dropped with DeleteRange
+};
 
 class SSDBImpl : public SSDB
 {
@@ -99,6 +155,70 @@ public:
 
 	std::vector<leveldb::ColumnFamilyHandle*> handles;
 
+	bool cf_per_class = false;
+
+	// emit meta deltas as merge operands, see MetaDeltaMergeOperator
+	bool meta_merge = false;
+
+	// queue concurrent commits and write them as one batch, see rocksdb.group_commit
+	bool group_commit = false;
+	// fsync the wal once per write group
+	bool commit_sync = false;
+	CommitStats commit_stats;
+
+	// threads deleting collections, and their item budget per second, 0 for no limit
+	int delete_threads = 1;
+	int delete_rate = 0;
+	DeleteStats delete_stats;
+
+	// drops items of stale collection versions in compaction, see rocksdb.compaction_filter
+	std::shared_ptr<StaleDataFilterFactory> staleFilter;
+
+	leveldb::ColumnFamilyHandle *cfOf(char type) const {
+		if (!cf_per_class) {
+			return handles[CF_DEFAULT];
+		}
+		switch (type) {
+			case DataType::META:
+				return handles[CF_META];
+			case DataType::ZSCORE:
+			case DataType::ZRANK:
+				return handles[CF_ZSET];
+			case DataType::ESCORE:
+			case DataType::EKEY:
+				return handles[CF_EXPIRE];
+			case DataType::DELETE:
+				return handles[CF_DELETE];
+			default:
+				return handles[CF_DEFAULT];
+		}
+	}
+
+	leveldb::ColumnFamilyHandle *cfOf(const leveldb::Slice &key) const {
+		return key.empty() ? handles[CF_DEFAULT] : cfOf(key[0]);
+	}
+
+	// column families holding user data, everything except repopid
+	std::vector<leveldb::ColumnFamilyHandle*> dataHandles() const;
+
+	// forward only iterator over all data column families in key order
+	leveldb::Iterator *newDataIterator(const leveldb::ReadOptions &options);
+
+	leveldb::Status ldbGet(const leveldb::ReadOptions &options, const leveldb::Slice &key, std::string *value) {
+		return ldb->Get(options, cfOf(key), key, value);
+	}
+
+	/*
+	 * point lookups of many keys with one MultiGet, probed in key order against one
+	 * consistent view. found[i] is 1 and values[i] is set if keys[i] exists.
+	 * @return 0 or STORAGE_ERR
+	 */
+	int ldbMultiGet(const leveldb::ReadOptions &options, const std::vector<std::string> &keys,
+					std::vector<std::string> *values, std::vector<int> *found);
+
+	// writes entries of the default column family into the column family of their class
+	leveldb::Status ldbWrite(const leveldb::WriteOptions &options, leveldb::WriteBatch *updates);
+
 	rocksdb::DB *getLdb() const {
 		return ldb;
 	}
@@ -111,6 +231,14 @@ public:
 		return path + "/data/";
 	}
 
+	string getCheckpointPath() const {
+		return path + "/checkpoint/";
+	}
+
+	string getSyncPath() const {
+		return path + "/data.sync/";
+	}
+
 	int save(Context &ctx);
 
 	ExpirationHandler *expiration;
@@ -123,6 +251,12 @@ public:
 	virtual int flush(Context &ctx, bool wait = false);
 	virtual int filesize(Context &ctx, uint64_t *total_file_size);
 
+	// hard linked copy of the data dir, snapshot (if not null) is taken under the same lock
+	virtual int checkpoint(const std::string &dir, const leveldb::Snapshot **snapshot);
+	// replace the data dir with dir (e.g. a checkpoint received from master) and reopen it
+	virtual int reopen(Context &ctx, const std::string &dir);
+	virtual int removeDir(const std::string &dir);
+
 	// return (start, end], not include start
 	virtual Iterator* iterator(const std::string &start, const std::string &end, uint64_t limit,
 							   const leveldb::Snapshot *snapshot=nullptr);
@@ -162,6 +296,15 @@ public:
 	virtual int parse_replic(Context &ctx, const std::vector<Bytes> &kvs);
 	virtual int parse_replic(Context &ctx, const std::vector<std::string> &kvs);
 
+	/* cluster slot, only with KEY_FORMAT_SLOT */
+	virtual int slotcount(Context &ctx, uint16_t slot, uint64_t *count);
+	virtual int slotkeys(Context &ctx, uint16_t slot, uint64_t limit, std::vector<std::string> &keys);
+	virtual int slotdel(Context &ctx, uint16_t slot, uint64_t *count);
+	virtual int slotexport(Context &ctx, const std::vector<uint16_t> &slots, const std::string &dir,
+						   uint64_t max_file_size, std::vector<std::string> *files, std::string *classes,
+						   uint64_t *count);
+	virtual int slotingest(Context &ctx, const std::vector<std::string> &files, const std::string &classes);
+
 	/* key value */
 
 	virtual int set(Context &ctx, const Bytes &key,const Bytes &val, int flags, int64_t expire_ms, int *added);
@@ -177,6 +320,7 @@ public:
 	virtual int getbit(Context &ctx, const Bytes &key,int64_t bitoffset, int *res);
 	
 	virtual int get(Context &ctx, const Bytes &key,std::string *val);
+	virtual int multi_get(Context &ctx, const std::vector<Bytes> &keys, int offset, std::vector<std::string> *vals, std::vector<int> *rets);
 	virtual int getset(Context &ctx, const Bytes &key,std::pair<std::string, bool> &val, const Bytes &newval);
 	virtual int getrange(Context &ctx, const Bytes &key,int64_t start, int64_t end, std::pair<std::string, bool> &res);
 	// return (start, end]
@@ -277,6 +421,15 @@ public:
 
 private:
 
+	int checkKeyFormat(int format);
+	leveldb::Status openLdb();
+	void closeLdb();
+	leveldb::Status migrateClasses();
+
+	// options of the class column families, filled by SSDB::open
+	leveldb::ColumnFamilyOptions metaCfOptions;
+	leveldb::ColumnFamilyOptions zsetCfOptions;
+	leveldb::ColumnFamilyOptions queueCfOptions;
 	int SetGeneric(Context &ctx, const Bytes &key, leveldb::WriteBatch &batch, const Bytes &val, int flags, int64_t expire_ms, int *added);
     int GetKvMetaVal(const std::string &meta_key, KvMetaVal &kv);
 
@@ -296,6 +449,7 @@ private:
     int incr_ssize(Context &ctx, const Bytes &key, leveldb::WriteBatch &batch, const SetMetaVal &sv, const std::string &meta_key,int64_t incr);
 
 	int GetListItemValInternal(const std::string &item_key, std::string *val, const leveldb::ReadOptions &options = leveldb::ReadOptions());
+    LIterator* lscan_internal(Context &ctx, const Bytes &name, uint16_t version, uint64_t begin_seq, uint64_t limit, const leveldb::Snapshot *snapshot=nullptr);
     int GetListMetaVal(const std::string &meta_key, ListMetaVal &lv);
     int doListPop(Context &ctx, const Bytes &key, leveldb::WriteBatch &batch, ListMetaVal &lv, std::string &meta_key, LIST_POSITION lp, std::pair<std::string, bool> &val);
 
@@ -311,10 +465,21 @@ private:
     ZIteratorByLex* zscanbylex_internal(Context &ctx, const Bytes &name,const Bytes &key_start, const Bytes &key_end,
 							  uint64_t limit, Iterator::Direction direction, uint16_t version,
 							  const leveldb::Snapshot *snapshot=nullptr);
-	int	zset_one(leveldb::WriteBatch &batch, bool needCheck, const Bytes &name, const Bytes &key, double score, uint16_t cur_version, int *flags, double *newscore);
-	int zdel_one(leveldb::WriteBatch &batch, const Bytes &name, const Bytes &key, uint16_t version);
+	int	zset_one(leveldb::WriteBatch &batch, ZRankDelta &rank_delta, bool needCheck, const Bytes &name, const Bytes &key, double score, uint16_t cur_version, int *flags, double *newscore);
+	// same as above with the member already probed, found tells if it exists with old_score
+	int	zset_one(leveldb::WriteBatch &batch, ZRankDelta &rank_delta, bool found, double old_score, const Bytes &name, const Bytes &key, double score, uint16_t cur_version, int *flags, double *newscore);
+	int zdel_one(leveldb::WriteBatch &batch, ZRankDelta &rank_delta, const Bytes &name, const Bytes &key, uint16_t version);
+	void zdel_one(leveldb::WriteBatch &batch, ZRankDelta &rank_delta, const Bytes &name, const Bytes &key, double old_score, uint16_t version);
 	int incr_zsize(Context &ctx, const Bytes &name, leveldb::WriteBatch &batch, const ZSetMetaVal &zv,int64_t incr);
 
+	void zrank_index_incr(ZRankDelta &rank_delta, const Bytes &name, double score, uint16_t version, int64_t incr);
+	int zrank_index_commit(leveldb::WriteBatch &batch, const ZRankDelta &rank_delta);
+	int zrank_index_valid(const Bytes &name, const ZSetMetaVal &zv, const leveldb::Snapshot *snapshot);
+	int zrank_index_rank(const Bytes &name, const Bytes &key, double score, uint16_t version,
+						 const leveldb::Snapshot *snapshot, uint64_t *rank);
+	int zrank_index_seek(const Bytes &name, uint16_t version, uint64_t rank, const leveldb::Snapshot *snapshot,
+						 std::string *score_bits, uint64_t *offset, uint64_t *ties);
+
 	int setNoLock(Context &ctx, const Bytes &key,const Bytes &val, int flags, int64_t expire_ms, int *added);
 
     template <typename T>
@@ -363,18 +528,28 @@ private:
 	Mutex mutex_bgtask_;
 	Mutex mutex_backup_;
 	std::atomic<bool> bgtask_quit;
-	pthread_t bg_tid_;
+	CondVar bgtask_cv_;
+	std::vector<pthread_t> bg_tids_;
     std::queue<std::string> tasks_;
+    std::set<std::string> deleting_;
 
 
 	void load_delete_keys_from_db(int num);
     void delete_key_loop(const std::string& del_key);
     int  delete_meta_key(const DeleteKey& dk, leveldb::WriteBatch& batch);
+    int  delete_prefix(const std::string& prefix, leveldb::WriteBatch& batch);
+    void throttle_delete(uint64_t items);
 	void runBGTask();
 	static void* thread_func(void *arg);
 
 	RecordKeyMutex mutex_record_;
 
+	struct CommitWriter;
+	Mutex mutex_commit_;
+	std::deque<CommitWriter *> commit_queue_;
+
+	leveldb::Status groupCommit(const leveldb::WriteOptions &options, leveldb::WriteBatch *updates);
+
 public:
 
 	void start();
@@ -0,0 +1,111 @@
+/*
+Copyright (c) 2017, Timothy. All rights reserved.
+Use of this source code is governed by a BSD-style license that can be
+found in the LICENSE file.
+*/
+
+#include "t_compaction.h"
+#include "ssdb_impl.h"
+
+#define leveldb rocksdb
+
+// what the meta key of a name says about its items
+enum MetaState {
+    META_UNKNOWN = -1,
+    META_MISSING = 0,
+    META_DELETED = 1,
+    META_LIVE = 2,
+};
+
+class StaleDataFilter : public rocksdb::CompactionFilter {
+public:
+    StaleDataFilter(SSDBImpl *ssdb, StaleDataFilterFactory *factory) : ssdb(ssdb), factory(factory) {}
+
+    bool Filter(int level, const rocksdb::Slice &key, const rocksdb::Slice &existing_value,
+                std::string *new_value, bool *value_changed) const override {
+        if (!factory->enabled || key.empty()) {
+            return false;
+        }
+
+        switch (key[0]) {
+            case DataType::ITEM:
+            case DataType::ZSCORE:
+            case DataType::ZRANK: {
+                int size = collection_prefix_size(key.data(), key.size(), get_key_format());
+                if (size < 0) {
+                    return false;
+                }
+                size_t pos = 1 + (get_key_format() == KEY_FORMAT_SLOT ? sizeof(uint16_t) : 0);
+                uint16_t len = be16toh(*(uint16_t *) (key.data() + pos));
+                uint16_t version = be16toh(*(uint16_t *) (key.data() + size - sizeof(uint16_t)));
+
+                uint16_t meta_version = 0;
+                int state = metaState(std::string(key.data() + pos + sizeof(uint16_t), len), &meta_version);
+                if (state == META_UNKNOWN || (state == META_LIVE && meta_version == version)) {
+                    return false;
+                }
+                factory->dropped_items++;
+                return true;
+            }
+            case DataType::EKEY:
+            case DataType::ESCORE: {
+                size_t pos = key[0] == DataType::EKEY ? 1 : 1 + sizeof(uint64_t);
+                if (key.size() < pos) {
+                    return false;
+                }
+
+                uint16_t meta_version = 0;
+                int state = metaState(std::string(key.data() + pos, key.size() - pos), &meta_version);
+                if (state != META_MISSING && state != META_DELETED) {
+                    return false;
+                }
+                factory->dropped_expire++;
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+
+    const char *Name() const override {
+        return "swapdb.StaleDataFilter";
+    }
+
+private:
+    SSDBImpl *ssdb;
+    StaleDataFilterFactory *factory;
+
+    // items of one collection come one after another, remember the last meta
+    mutable std::string last_name;
+    mutable int last_state = META_UNKNOWN;
+    mutable uint16_t last_version = 0;
+
+    int metaState(const std::string &name, uint16_t *version) const {
+        if (last_state != META_UNKNOWN && name == last_name) {
+            *version = last_version;
+            return last_state;
+        }
+
+        std::string meta_val;
+        leveldb::Status s = ssdb->ldbGet(leveldb::ReadOptions(), encode_meta_key(name), &meta_val);
+        int state;
+        if (s.IsNotFound()) {
+            state = META_MISSING;
+        } else if (!s.ok() || meta_val.size() <= POS_DEL) {
+            state = META_UNKNOWN;
+        } else {
+            *version = be16toh(*(uint16_t *) (meta_val.data() + 1));
+            state = meta_val[POS_DEL] == KEY_DELETE_MASK ? META_DELETED : META_LIVE;
+        }
+
+        last_name = name;
+        last_state = state;
+        last_version = *version;
+        return state;
+    }
+};
+
+std::unique_ptr<rocksdb::CompactionFilter>
+StaleDataFilterFactory::CreateCompactionFilter(const rocksdb::CompactionFilter::Context &context) {
+    return std::unique_ptr<rocksdb::CompactionFilter>(new StaleDataFilter(ssdb, this));
+}
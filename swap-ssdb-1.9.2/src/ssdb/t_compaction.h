@@ -0,0 +1,49 @@
+/*
+Copyright (c) 2017, Timothy. All rights reserved.
+Use of this source code is governed by a BSD-style license that can be
+found in the LICENSE file.
+*/
+
+#ifndef SSDB_T_COMPACTION_H
+#define SSDB_T_COMPACTION_H
+
+#ifdef USE_LEVELDB
+#else
+
+#include <atomic>
+#include <memory>
+#include "rocksdb/compaction_filter.h"
+
+class SSDBImpl;
+
+/*
+ * drops entries nothing can reach any more while they are compacted: items,
+ * zset scores and rank nodes of a collection version its meta key no longer
+ * points at, and expire index entries of deleted keys. the delete queue then
+ * finds little left to do. keys past their expire time are still deleted by
+ * ExpirationHandler, so the delete goes through the normal write path.
+ */
+class StaleDataFilterFactory : public rocksdb::CompactionFilterFactory {
+public:
+    explicit StaleDataFilterFactory(SSDBImpl *ssdb) : ssdb(ssdb) {}
+
+    std::unique_ptr<rocksdb::CompactionFilter>
+    CreateCompactionFilter(const rocksdb::CompactionFilter::Context &context) override;
+
+    const char *Name() const override {
+        return "swapdb.StaleDataFilterFactory";
+    }
+
+    // set once the db and all its column families are open, cleared before closing it
+    std::atomic<bool> enabled{false};
+
+    std::atomic<uint64_t> dropped_items{0};
+    std::atomic<uint64_t> dropped_expire{0};
+
+private:
+    SSDBImpl *ssdb;
+};
+
+#endif
+
+#endif //SSDB_T_COMPACTION_H
@@ -38,7 +38,7 @@ int SSDBImpl::eget(Context &ctx, const Bytes &key, int64_t *ts) {
 
 
 #ifdef USE_LEVELDB
-    s = ldb->Get(commonRdOpt, dbkey, &str_score);
+    s = ldbGet(commonRdOpt, dbkey, &str_score);
 #else
 //    if (ldb->KeyMayExist(commonRdOpt, dbkey, &str_score, &found)) {
 //        if (!found) {
@@ -48,7 +48,7 @@ int SSDBImpl::eget(Context &ctx, const Bytes &key, int64_t *ts) {
 //        return 0;
 //    }
 
-    s = ldb->Get(commonRdOpt, dbkey, &str_score);
+    s = ldbGet(commonRdOpt, dbkey, &str_score);
 #endif
 
     if (s.IsNotFound()) {
@@ -105,7 +105,7 @@ int SSDBImpl::eset_one(Context &ctx, const Bytes &key, leveldb::WriteBatch &batc
 int SSDBImpl::check_meta_key(Context &ctx, const Bytes &key) {
     std::string meta_key = encode_meta_key(key);
     std::string meta_val;
-    leveldb::Status s = ldb->Get(leveldb::ReadOptions(), meta_key, &meta_val);
+    leveldb::Status s = ldbGet(leveldb::ReadOptions(), meta_key, &meta_val);
     if (s.IsNotFound()) {
         return 0;
     } else if (!s.ok()) {
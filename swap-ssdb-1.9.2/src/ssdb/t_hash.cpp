@@ -34,16 +34,22 @@ int SSDBImpl::hdel(Context &ctx, const Bytes &name, const std::set<Bytes> &field
 		return ret;
 	}
 
+	std::vector<std::string> hkeys;
+	hkeys.reserve(fields.size());
 	for (auto const &key : fields) {
+		hkeys.push_back(encode_hash_key(name, key, hv.version));
+	}
 
-		std::string dbval;
-		std::string hkey = encode_hash_key(name, key, hv.version);
+	std::vector<std::string> dbvals;
+	std::vector<int> found;
+	ret = ldbMultiGet(leveldb::ReadOptions(), hkeys, &dbvals, &found);
+	if (ret < 0){
+		return ret;
+	}
 
-		ret = GetHashItemValInternal(hkey, &dbval);
-		if (ret < 0){
-			return ret;
-		} else if (ret == 1){
-			batch.Delete(hkey);
+	for (size_t i = 0; i < hkeys.size(); i++) {
+		if (found[i]){
+			batch.Delete(hkeys[i]);
             (*deleted) = (*deleted)+1;
 		}
 	}
@@ -156,19 +162,26 @@ int SSDBImpl::hmget(Context &ctx, const Bytes &name, const std::vector<std::stri
 
 	SnapshotPtr spl(ldb, snapshot);
 
+	std::vector<std::string> hkeys;
+	hkeys.reserve(reqKeys.size());
 	for (const std::string &reqKey : reqKeys) {
-		std::string val;
-		std::string hkey = encode_hash_key(name, reqKey, hv.version);
-
-		int ret = GetHashItemValInternal(hkey, &val);
-		if (ret == 1) {
-			resMap[reqKey] = val;
-		} else if (ret == 0) {
-			continue;
-		} else {
-			return ret;
-		}
+		hkeys.push_back(encode_hash_key(name, reqKey, hv.version));
+	}
+
+	leveldb::ReadOptions options;
+	options.snapshot = snapshot;
 
+	std::vector<std::string> vals;
+	std::vector<int> found;
+	int ret = ldbMultiGet(options, hkeys, &vals, &found);
+	if (ret < 0) {
+		return ret;
+	}
+
+	for (size_t i = 0; i < reqKeys.size(); i++) {
+		if (found[i]) {
+			resMap[reqKeys[i]].swap(vals[i]);
+		}
 	}
 
     return 1;
@@ -236,7 +249,7 @@ HIterator* SSDBImpl::hscan_internal(Context &ctx, const Bytes &name, uint16_t ve
 
 int SSDBImpl::GetHashMetaVal(const std::string &meta_key, HashMetaVal &hv){
 	std::string meta_val;
-	leveldb::Status s = ldb->Get(leveldb::ReadOptions(), meta_key, &meta_val);
+	leveldb::Status s = ldbGet(leveldb::ReadOptions(), meta_key, &meta_val);
 	if (s.IsNotFound()){
         //not found
 		hv.length = 0;
@@ -272,7 +285,7 @@ int SSDBImpl::GetHashMetaVal(const std::string &meta_key, HashMetaVal &hv){
 }
 
 int SSDBImpl::GetHashItemValInternal(const std::string &item_key, std::string *val){
-	leveldb::Status s = ldb->Get(leveldb::ReadOptions(), item_key, val);
+	leveldb::Status s = ldbGet(leveldb::ReadOptions(), item_key, val);
 	if (s.IsNotFound()){
 		return 0;
 	} else if (!s.ok() && !s.IsNotFound()){
@@ -372,6 +385,8 @@ int SSDBImpl::incr_hsize(Context &ctx, const Bytes &name, leveldb::WriteBatch &b
 			expiration->cancelExpiration(ctx, name, batch); //del expire ET key
 
 			ret = 0;
+		} else if (meta_merge){
+			batch.Merge(size_key, encode_meta_delta(DataType::HSIZE, incr));
 		} else{
 			std::string meta_val = encode_hash_meta_val(len, hv.version);
 			batch.Put(size_key, meta_val);
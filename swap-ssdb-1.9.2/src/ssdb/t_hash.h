@@ -87,22 +87,39 @@ int SSDBImpl::hmsetNoLock(Context &ctx, const Bytes &name, const std::map<T ,T>
         return ret;
     }
 
-    int sum = 0;
-
+    std::vector<std::string> hkeys;
+    hkeys.reserve(kvs.size());
     for(auto const &it : kvs)
     {
-        const T &key = it.first;
-        const T &val = it.second;
+        hkeys.push_back(encode_hash_key(name, it.first, hv.version));
+    }
 
-        int added = hset_one(batch, hv, check_exists, name, key, val);
-        if(added < 0){
-            return added;
+    // one batched probe instead of a Get per field
+    std::vector<std::string> dbvals;
+    std::vector<int> found;
+    if (check_exists) {
+        int mret = ldbMultiGet(leveldb::ReadOptions(), hkeys, &dbvals, &found);
+        if (mret < 0){
+            return mret;
         }
+    }
 
-        if(added > 0){
-            sum = sum + added;
-        }
+    int sum = 0;
+    size_t i = 0;
 
+    for(auto const &it : kvs)
+    {
+        const Bytes &val = it.second;
+
+        if (check_exists && found[i]) {
+            if(dbvals[i] != val){
+                batch.Put(hkeys[i], slice(val));
+            }
+        } else {
+            batch.Put(hkeys[i], slice(val));
+            sum++;
+        }
+        i++;
     }
 
     int iret = incr_hsize(ctx, name, batch, meta_key, hv, sum);
@@ -15,6 +15,8 @@ found in the LICENSE file.
 #include "t_zset.h"
 #include "t_list.h"
 
+#include "rocksdb/sst_file_writer.h"
+
 extern "C" {
 #include "redis/ziplist.h"
 #include "redis/intset.h"
@@ -49,7 +51,7 @@ int SSDBImpl::dump(Context &ctx, const Bytes &key, std::string *res, int64_t *pt
         RecordKeyLock l(&mutex_record_, key.String());
 
         std::string meta_key = encode_meta_key(key);
-        leveldb::Status s = ldb->Get(leveldb::ReadOptions(), meta_key, &meta_val);
+        leveldb::Status s = ldbGet(leveldb::ReadOptions(), meta_key, &meta_val);
         if (s.IsNotFound()) {
             return 0;
         }
@@ -224,29 +226,22 @@ int SSDBImpl::rdbSaveObject(Context &ctx, const Bytes &key, char dtype, const st
 
             if (encoder.rdbSaveLen(lv.length) == -1) return -1;
 
-            //readOptions using snapshot
-            leveldb::ReadOptions readOptions(false, true);
-            readOptions.snapshot = snapshot;
-
             uint64_t rangelen = lv.length;
             uint64_t begin_seq = getSeqByIndex(0, lv);
             uint64_t cur_seq = begin_seq;
 
-            std::string item_key = encode_list_key(key, cur_seq, lv.version);
+            auto it = std::unique_ptr<LIterator>(this->lscan_internal(ctx, key, lv.version, cur_seq, rangelen, snapshot));
 
             while (rangelen--) {
-
-                update_list_key(item_key, cur_seq); //do not use encode_list_key , just update the seq
-
-                std::string item_val;
-                ret = GetListItemValInternal(item_key, &item_val, readOptions);
-                if (1 != ret) {
+                if (!it->next() || it->seq != cur_seq) {
+                    log_error("list item missing, key %s, seq %" PRIu64, hexstr(key).c_str(), cur_seq);
                     return -1;
                 }
-                if (encoder.rdbSaveRawString(item_val) == -1) return -1;
+                if (encoder.rdbSaveRawString(it->val.String()) == -1) return -1;
 
                 if (UINT64_MAX == cur_seq) {
                     cur_seq = 0;
+                    it.reset(this->lscan_internal(ctx, key, lv.version, cur_seq, rangelen, snapshot));
                 } else {
                     cur_seq++;
                 }
@@ -276,7 +271,7 @@ int SSDBImpl::restore(Context &ctx, const Bytes &key, int64_t expire, const Byte
     std::string meta_key = encode_meta_key(key);
     leveldb::Status s;
 
-    s = ldb->Get(commonRdOpt, meta_key, &meta_val);
+    s = ldbGet(commonRdOpt, meta_key, &meta_val);
     if (!s.ok() && !s.IsNotFound()) {
         return STORAGE_ERR;
     }
@@ -296,7 +291,7 @@ int SSDBImpl::restore(Context &ctx, const Bytes &key, int64_t expire, const Byte
             leveldb::WriteBatch batch;
             mark_key_deleted(ctx, key, batch, meta_key, meta_val);
 
-            s = ldb->Write(leveldb::WriteOptions(), &(batch));
+            s = ldbWrite(leveldb::WriteOptions(), &(batch));
             if(!s.ok()){
                 return STORAGE_ERR;
             }
@@ -655,7 +650,7 @@ int SSDBImpl::parse_replic(Context &ctx, const std::vector<Bytes> &kvs) {
         batch.Put(slice(key), slice(val));
     }
 
-    leveldb::Status s = ldb->Write(writeOptions , &(batch));
+    leveldb::Status s = ldbWrite(writeOptions , &(batch));
     if(!s.ok()){
         log_error("write leveldb error: %s", s.ToString().c_str());
         return -1;
@@ -680,7 +675,7 @@ int SSDBImpl::parse_replic(Context &ctx, const std::vector<std::string> &kvs) {
         batch.Put(slice(key), slice(val));
     }
 
-    leveldb::Status s = ldb->Write(writeOptions , &(batch));
+    leveldb::Status s = ldbWrite(writeOptions , &(batch));
     if(!s.ok()){
         log_error("write leveldb error: %s", s.ToString().c_str());
         return -1;
@@ -775,7 +770,7 @@ int SSDBImpl::type(Context &ctx, const Bytes &key, std::string *type) {
 
     std::string meta_val;
     std::string meta_key = encode_meta_key(key);
-    leveldb::Status s = ldb->Get(leveldb::ReadOptions(), meta_key, &meta_val);
+    leveldb::Status s = ldbGet(leveldb::ReadOptions(), meta_key, &meta_val);
 
     if (s.IsNotFound()) {
         return 0;
@@ -819,7 +814,7 @@ int SSDBImpl::type(Context &ctx, const Bytes &key, std::string *type) {
 int SSDBImpl::exists(Context &ctx, const Bytes &key) {
     std::string meta_val;
     std::string meta_key = encode_meta_key(key);
-    leveldb::Status s = ldb->Get(leveldb::ReadOptions(), meta_key, &meta_val);
+    leveldb::Status s = ldbGet(leveldb::ReadOptions(), meta_key, &meta_val);
     if (s.IsNotFound()) {
         return 0;
     }
@@ -836,3 +831,323 @@ int SSDBImpl::exists(Context &ctx, const Bytes &key) {
     }
 }
 
+
+/*
+ * with KEY_FORMAT_SLOT every meta/item/zscore/zrank key of a slot lives in
+ * [type + slot, type + slot + 1), so a slot can be walked or dropped as ranges.
+ */
+static const char slot_key_types[] = {DataType::META, DataType::ITEM, DataType::ZSCORE, DataType::ZRANK};
+
+int SSDBImpl::slotcount(Context &ctx, uint16_t slot, uint64_t *count) {
+    if (get_key_format() != KEY_FORMAT_SLOT) {
+        return KEY_FORMAT_ERR;
+    }
+
+    leveldb::ReadOptions iterate_options(false, false);
+    iterate_options.total_order_seek = true;
+    std::unique_ptr<leveldb::Iterator> it(ldb->NewIterator(iterate_options, cfOf(DataType::META)));
+
+    std::string prefix = encode_slot_prefix(DataType::META, slot);
+    for (it->Seek(prefix); it->Valid() && it->key().starts_with(prefix); it->Next()) {
+        if (it->value().size() > POS_DEL && it->value()[POS_DEL] == KEY_ENABLED_MASK) {
+            (*count)++;
+        }
+    }
+
+    if (!it->status().ok()) {
+        log_error("slotcount error: %s", it->status().ToString().c_str());
+        return STORAGE_ERR;
+    }
+
+    return 1;
+}
+
+int SSDBImpl::slotkeys(Context &ctx, uint16_t slot, uint64_t limit, std::vector<std::string> &keys) {
+    if (get_key_format() != KEY_FORMAT_SLOT) {
+        return KEY_FORMAT_ERR;
+    }
+
+    leveldb::ReadOptions iterate_options(false, false);
+    iterate_options.total_order_seek = true;
+    std::unique_ptr<leveldb::Iterator> it(ldb->NewIterator(iterate_options, cfOf(DataType::META)));
+
+    std::string prefix = encode_slot_prefix(DataType::META, slot);
+    for (it->Seek(prefix); it->Valid() && it->key().starts_with(prefix) && keys.size() < limit; it->Next()) {
+        if (it->value().size() > POS_DEL && it->value()[POS_DEL] == KEY_ENABLED_MASK) {
+            keys.emplace_back(it->key().data() + prefix.size(), it->key().size() - prefix.size());
+        }
+    }
+
+    if (!it->status().ok()) {
+        log_error("slotkeys error: %s", it->status().ToString().c_str());
+        return STORAGE_ERR;
+    }
+
+    return 1;
+}
+
+int SSDBImpl::slotdel(Context &ctx, uint16_t slot, uint64_t *count) {
+    if (get_key_format() != KEY_FORMAT_SLOT) {
+        return KEY_FORMAT_ERR;
+    }
+
+    Locking<RecordKeyMutex> gl(&mutex_record_);
+
+    leveldb::WriteBatch batch;
+
+    // expire entries are not slot prefixed, drop them key by key
+    leveldb::ReadOptions iterate_options(false, false);
+    iterate_options.total_order_seek = true;
+    std::unique_ptr<leveldb::Iterator> it(ldb->NewIterator(iterate_options, cfOf(DataType::META)));
+
+    std::string prefix = encode_slot_prefix(DataType::META, slot);
+    for (it->Seek(prefix); it->Valid() && it->key().starts_with(prefix); it->Next()) {
+        if (it->value().size() > POS_DEL && it->value()[POS_DEL] == KEY_ENABLED_MASK) {
+            Bytes key(it->key().data() + prefix.size(), (int) (it->key().size() - prefix.size()));
+            int ret = expiration->cancelExpiration(ctx, key, batch);
+            if (ret < 0) {
+                return ret;
+            }
+            (*count)++;
+        }
+    }
+
+    if (!it->status().ok()) {
+        log_error("slotdel error: %s", it->status().ToString().c_str());
+        return STORAGE_ERR;
+    }
+
+    for (char type : slot_key_types) {
+        batch.DeleteRange(encode_slot_prefix(type, slot), encode_slot_prefix(type, (uint16_t) (slot + 1)));
+    }
+
+    leveldb::Status s = CommitBatch(ctx, &(batch));
+    if (!s.ok()) {
+        log_error("error: %s", s.ToString().c_str());
+        return STORAGE_ERR;
+    }
+
+    return 1;
+}
+
+/*
+ * rolls sst files of at most max_file_size under dir, keys must be added in order.
+ * a file holds one key type only, its type is appended to types so the
+ * receiver can ingest it into the matching column family.
+ */
+class SlotSstWriter {
+public:
+    SlotSstWriter(const leveldb::Options &options, const std::string &dir, uint64_t max_file_size,
+                  std::vector<std::string> *files, std::string *types) :
+            options(options), dir(dir), max_file_size(max_file_size), files(files), types(types) {}
+
+    leveldb::Status add(const leveldb::Slice &key, const leveldb::Slice &val) {
+        leveldb::Status s;
+        if (writer && key[0] != types->back()) {
+            s = finish();
+            if (!s.ok()) {
+                return s;
+            }
+        }
+        if (!writer) {
+            std::string path = dir + str((int64_t) files->size()) + ".sst";
+            writer.reset(new leveldb::SstFileWriter(leveldb::EnvOptions(), options));
+            s = writer->Open(path);
+            if (!s.ok()) {
+                return s;
+            }
+            files->push_back(path);
+            types->push_back(key[0]);
+        }
+
+        s = writer->Add(key, val);
+        if (s.ok() && writer->FileSize() >= max_file_size) {
+            s = finish();
+        }
+        return s;
+    }
+
+    leveldb::Status finish() {
+        leveldb::Status s;
+        if (writer) {
+            s = writer->Finish();
+            writer.reset();
+        }
+        return s;
+    }
+
+private:
+    const leveldb::Options &options;
+    std::string dir;
+    uint64_t max_file_size;
+    std::vector<std::string> *files;
+    std::string *types;
+    std::unique_ptr<leveldb::SstFileWriter> writer;
+};
+
+static int decode_slot_item_version(const leveldb::Slice &raw, std::string *key, uint16_t *version) {
+    Decoder decoder(raw.data(), (int) raw.size());
+    if (decoder.skip(1 + sizeof(uint16_t)) == -1) {
+        return -1;
+    }
+    if (decoder.read_16_data(key) == -1) {
+        return -1;
+    }
+    if (decoder.read_uint16(version) == -1) {
+        return -1;
+    }
+    *version = be16toh(*version);
+    return 0;
+}
+
+/*
+ * write every live key of @slots with its expire entries into sst files under
+ * @dir, in the order SstFileWriter needs: E < M < S < T < r < z. items of
+ * deleted or stale versions stay behind for the local background deleter.
+ */
+int SSDBImpl::slotexport(Context &ctx, const std::vector<uint16_t> &slots, const std::string &dir,
+                         uint64_t max_file_size, std::vector<std::string> *files, std::string *types,
+                         uint64_t *count) {
+    if (get_key_format() != KEY_FORMAT_SLOT) {
+        return KEY_FORMAT_ERR;
+    }
+
+    std::set<uint16_t> slot_set(slots.begin(), slots.end());
+
+    const leveldb::Snapshot *snapshot = GetSnapshot();
+    SnapshotPtr spl(ldb, snapshot); //auto release
+
+    leveldb::ReadOptions iterate_options(false, false);
+    iterate_options.snapshot = snapshot;
+    iterate_options.total_order_seek = true; // slot prefixes are shorter than collection prefixes
+    std::unique_ptr<leveldb::Iterator> it(ldb->NewIterator(iterate_options, cfOf(DataType::META)));
+
+    std::unordered_map<std::string, uint16_t> versions;
+    std::map<std::string, std::string> ekeys;
+    std::set<std::string> escores;
+
+    for (uint16_t slot : slot_set) {
+        std::string prefix = encode_slot_prefix(DataType::META, slot);
+        for (it->Seek(prefix); it->Valid() && it->key().starts_with(prefix); it->Next()) {
+            leveldb::Slice val = it->value();
+            if (val.size() <= POS_DEL || val[POS_DEL] != KEY_ENABLED_MASK) {
+                continue;
+            }
+            std::string key(it->key().data() + prefix.size(), it->key().size() - prefix.size());
+            versions[key] = be16toh(*(uint16_t *) (val.data() + 1));
+
+            std::string ts_val;
+            leveldb::Status s = ldbGet(iterate_options, encode_eset_key(key), &ts_val);
+            if (s.ok() && ts_val.size() == sizeof(int64_t)) {
+                int64_t ts = *(int64_t *) ts_val.data();
+                escores.insert(encode_escore_key(key, static_cast<uint64_t>(ts)));
+                ekeys[encode_eset_key(key)] = ts_val;
+            } else if (!s.ok() && !s.IsNotFound()) {
+                log_error("slotexport get error: %s", s.ToString().c_str());
+                return STORAGE_ERR;
+            }
+        }
+        if (!it->status().ok()) {
+            log_error("slotexport error: %s", it->status().ToString().c_str());
+            return STORAGE_ERR;
+        }
+    }
+
+    SlotSstWriter writer(options, dir, max_file_size, files, types);
+    leveldb::Status s;
+
+    for (const auto &e : ekeys) {
+        s = writer.add(e.first, e.second);
+        if (!s.ok()) goto err;
+    }
+
+    for (char type : {DataType::META, DataType::ITEM, DataType::ESCORE, DataType::ZRANK, DataType::ZSCORE}) {
+        if (type == DataType::ESCORE) {
+            for (const auto &e : escores) {
+                s = writer.add(e, "");
+                if (!s.ok()) goto err;
+            }
+            continue;
+        }
+
+        it.reset(ldb->NewIterator(iterate_options, cfOf(type)));
+        for (uint16_t slot : slot_set) {
+            std::string prefix = encode_slot_prefix(type, slot);
+            for (it->Seek(prefix); it->Valid() && it->key().starts_with(prefix); it->Next()) {
+                if (type == DataType::META) {
+                    leveldb::Slice val = it->value();
+                    if (val.size() <= POS_DEL || val[POS_DEL] != KEY_ENABLED_MASK) {
+                        continue;
+                    }
+                    (*count)++;
+                } else {
+                    std::string key;
+                    uint16_t version = 0;
+                    if (decode_slot_item_version(it->key(), &key, &version) == -1) {
+                        continue;
+                    }
+                    auto v = versions.find(key);
+                    if (v == versions.end() || v->second != version) {
+                        continue;
+                    }
+                }
+
+                s = writer.add(it->key(), it->value());
+                if (!s.ok()) goto err;
+            }
+            if (!it->status().ok()) {
+                s = it->status();
+                goto err;
+            }
+        }
+    }
+
+    s = writer.finish();
+    if (!s.ok()) goto err;
+
+    return 1;
+
+    err:
+    log_error("slotexport error: %s", s.ToString().c_str());
+    return STORAGE_ERR;
+}
+
+/*
+ * @types one key type per file as written by slotexport, empty when the
+ * sender did not tag its files, they can only go to the default column family then.
+ */
+int SSDBImpl::slotingest(Context &ctx, const std::vector<std::string> &files, const std::string &types) {
+    if (get_key_format() != KEY_FORMAT_SLOT) {
+        return KEY_FORMAT_ERR;
+    }
+    if (files.empty()) {
+        return 1;
+    }
+    if (types.empty() ? cf_per_class : types.size() != files.size()) {
+        log_error("slotingest: %d files but types '%s'", (int) files.size(), hexstr(types).c_str());
+        return INVALID_ARGS;
+    }
+
+    std::map<leveldb::ColumnFamilyHandle *, std::vector<std::string>> cf_files;
+    for (size_t i = 0; i < files.size(); i++) {
+        cf_files[types.empty() ? handles[CF_DEFAULT] : cfOf(types[i])].push_back(files[i]);
+    }
+
+    Locking<RecordKeyMutex> gl(&mutex_record_);
+
+    leveldb::IngestExternalFileOptions ingest_options;
+    ingest_options.move_files = true;
+
+    for (const auto &cf : cf_files) {
+        leveldb::Status s = ldb->IngestExternalFile(cf.first, cf.second, ingest_options);
+        if (!s.ok()) {
+            log_error("slotingest error: %s", s.ToString().c_str());
+            return STORAGE_ERR;
+        }
+    }
+
+    // ingested keys may carry expire entries older than the loaded ones
+    expiration->clear();
+
+    return 1;
+}
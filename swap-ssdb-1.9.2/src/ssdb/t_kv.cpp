@@ -17,7 +17,7 @@ int SSDBImpl::GetKvMetaVal(const std::string &meta_key, KvMetaVal &kv) {
 
 
 #ifdef USE_LEVELDB
-    s = ldb->Get(commonRdOpt, meta_key, &meta_val);
+    s = ldbGet(commonRdOpt, meta_key, &meta_val);
 #else
 //    if (ldb->KeyMayExist(commonRdOpt, meta_key, &meta_val, &found)) {
 //        if (!found) {
@@ -27,7 +27,7 @@ int SSDBImpl::GetKvMetaVal(const std::string &meta_key, KvMetaVal &kv) {
 //        s = s.NotFound();
 //    }
 
-    s = ldb->Get(commonRdOpt, meta_key, &meta_val);
+    s = ldbGet(commonRdOpt, meta_key, &meta_val);
 
 #endif
 
@@ -274,7 +274,7 @@ int SSDBImpl::del_key_internal(Context &ctx, const Bytes &key, leveldb::WriteBat
     leveldb::ReadOptions readOptions = leveldb::ReadOptions();
     readOptions.fill_cache = false;
 
-    leveldb::Status s = ldb->Get(readOptions, meta_key, &meta_val);
+    leveldb::Status s = ldbGet(readOptions, meta_key, &meta_val);
     if (s.IsNotFound()) {
         return 0;
     } else if (!s.ok()) {
@@ -365,6 +365,21 @@ int SSDBImpl::incrbyfloat(Context &ctx, const Bytes &key, long double by, long d
 
 int SSDBImpl::incr(Context &ctx, const Bytes &key, int64_t by, int64_t *new_val){
 
+    if (meta_merge && ctx.replLink) {
+        // the master already checked the command, and the replication link does not read the reply
+        RecordKeyLock l(&mutex_record_, key.String());
+        leveldb::WriteBatch batch;
+        batch.Merge(encode_meta_key(key), encode_meta_delta(DataType::KV, by));
+
+        leveldb::Status s = CommitBatch(ctx, &(batch));
+        if (!s.ok()) {
+            log_error("incr error: %s", s.ToString().c_str());
+            return STORAGE_ERR;
+        }
+        *new_val = 0;
+        return 1;
+    }
+
     auto func = [&] (leveldb::WriteBatch &batch, const KvMetaVal &kv, std::string *new_str, int ret) {
 
         if (ret == 0) {
@@ -402,6 +417,43 @@ int SSDBImpl::get(Context &ctx, const Bytes &key, std::string *val) {
     return 1;
 }
 
+/*
+ * get of keys[offset..] with one batched probe of the meta keys,
+ * rets[i] is what get() returns for that key and vals[i] is set when it is 1
+ */
+int SSDBImpl::multi_get(Context &ctx, const std::vector<Bytes> &keys, int offset, std::vector<std::string> *vals,
+                        std::vector<int> *rets) {
+    std::vector<std::string> meta_keys;
+    for (int i = offset; i < (int) keys.size(); i++) {
+        meta_keys.push_back(encode_meta_key(keys[i]));
+    }
+
+    std::vector<std::string> meta_vals;
+    std::vector<int> found;
+    int ret = ldbMultiGet(commonRdOpt, meta_keys, &meta_vals, &found);
+    if (ret < 0) {
+        return ret;
+    }
+
+    vals->assign(meta_keys.size(), std::string());
+    rets->assign(meta_keys.size(), 0);
+    for (size_t i = 0; i < meta_keys.size(); i++) {
+        if (!found[i]) {
+            continue;
+        }
+        KvMetaVal kv;
+        ret = kv.DecodeMetaVal(meta_vals[i]);
+        if (ret < 0) {
+            (*rets)[i] = ret;
+        } else if (kv.del != KEY_DELETE_MASK) {
+            (*rets)[i] = 1;
+            (*vals)[i].swap(kv.value);
+        }
+    }
+
+    return 1;
+}
+
 
 
 int SSDBImpl::append(Context &ctx, const Bytes &key, const Bytes &value, uint64_t *llen) {
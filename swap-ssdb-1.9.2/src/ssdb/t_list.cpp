@@ -7,7 +7,7 @@ found in the LICENSE file.
 
 
 int SSDBImpl::GetListItemValInternal(const std::string &item_key, std::string *val, const leveldb::ReadOptions &options) {
-    leveldb::Status s = ldb->Get(options, item_key, val);
+    leveldb::Status s = ldbGet(options, item_key, val);
     if (s.IsNotFound()){
         return 0;
     } else if (!s.ok() && !s.IsNotFound()){
@@ -18,6 +18,18 @@ int SSDBImpl::GetListItemValInternal(const std::string &item_key, std::string *v
 
 static std::string EncodeValueListMeta(const ListMetaVal &meta_val);
 
+LIterator* SSDBImpl::lscan_internal(Context &ctx, const Bytes &name, uint16_t version, uint64_t begin_seq, uint64_t limit,
+                                    const leveldb::Snapshot *snapshot) {
+    leveldb::ReadOptions iterate_options(false, true);
+    if (snapshot) {
+        iterate_options.snapshot = snapshot;
+    }
+
+    std::string key_start = encode_list_key(name, begin_seq, version);
+
+    return new LIterator(this->iterator(key_start, "", limit, iterate_options), name, version);
+}
+
 std::string EncodeValueListMeta(const ListMetaVal &meta_val) {
     return encode_list_meta_val(meta_val.length, meta_val.left_seq, meta_val.right_seq, meta_val.version, meta_val.del);
 }
@@ -334,7 +346,7 @@ int SSDBImpl::GetListMetaVal(const std::string &meta_key, ListMetaVal &lv) {
     int ret = 0;
 
     std::string meta_val;
-    leveldb::Status s = ldb->Get(leveldb::ReadOptions(), meta_key, &meta_val);
+    leveldb::Status s = ldbGet(leveldb::ReadOptions(), meta_key, &meta_val);
     if (s.IsNotFound()){
         lv.left_seq = 0;
         lv.right_seq = UINT64_MAX;
@@ -522,11 +534,6 @@ int SSDBImpl::lrange(Context &ctx, const Bytes &key, int64_t start, int64_t end,
 
     SnapshotPtr spl(ldb, snapshot); //auto release
 
-    leveldb::ReadOptions readOptions = leveldb::ReadOptions();
-    readOptions.fill_cache = true;
-    readOptions.snapshot = snapshot;
-
-
     int64_t llen = (int64_t)lv.length;
     if (start < 0) start = llen+start;
     if (end < 0) end = llen+end;
@@ -543,18 +550,22 @@ int SSDBImpl::lrange(Context &ctx, const Bytes &key, int64_t start, int64_t end,
     uint64_t begin_seq = getSeqByIndex(start, lv);
     uint64_t cur_seq = begin_seq;
 
+    //items are contiguous by seq, stream them with one iterator instead of a Get per index
+    std::unique_ptr<LIterator> it(lscan_internal(ctx, key, lv.version, cur_seq, (uint64_t) rangelen, snapshot));
+    list.reserve(list.size() + rangelen);
+
     while (rangelen--){
-        std::string val;
-        std::string item_key = encode_list_key(key, cur_seq, lv.version);
-        ret = GetListItemValInternal(item_key, &val, readOptions);
-        if (1 != ret){
+        if (!it->next() || it->seq != cur_seq) {
+            log_error("list item missing, key %s, seq %" PRIu64, hexstr(key).c_str(), cur_seq);
             list.clear();
             return -1;
         }
-        list.push_back(val);
+        list.push_back(it->val.String());
 
         if (UINT64_MAX == cur_seq) {
             cur_seq = 0;
+            //seq wrapped around, items continue at the head of the key space
+            it.reset(lscan_internal(ctx, key, lv.version, cur_seq, (uint64_t) rangelen, snapshot));
         } else {
             cur_seq++;
         }
@@ -0,0 +1,57 @@
+/*
+Copyright (c) 2017, Timothy. All rights reserved.
+Use of this source code is governed by a BSD-style license that can be
+found in the LICENSE file.
+*/
+
+#ifndef SSDB_T_MERGE_H
+#define SSDB_T_MERGE_H
+
+#ifdef USE_LEVELDB
+#else
+
+#include "rocksdb/merge_operator.h"
+#include "codec/decode.h"
+#include "util/bytes.h"
+#include "util/log.h"
+
+/*
+ * folds the meta deltas of blind writers into meta values, see encode_meta_delta.
+ * writers only emit deltas they have validated under the record lock, one that
+ * still does not apply is dropped with an error rather than failing every read.
+ */
+class MetaDeltaMergeOperator : public rocksdb::MergeOperator {
+public:
+    const char *Name() const override {
+        return "swapdb.MetaDelta";
+    }
+
+    bool FullMergeV2(const MergeOperationInput &merge_in, MergeOperationOutput *merge_out) const override {
+        bool exists = merge_in.existing_value != nullptr;
+        if (exists) {
+            merge_out->new_value.assign(merge_in.existing_value->data(), merge_in.existing_value->size());
+        }
+
+        for (const auto &operand : merge_in.operand_list) {
+            if (apply_meta_delta(&merge_out->new_value, exists, Bytes(operand.data(), (int) operand.size())) == 0) {
+                exists = true;
+            } else {
+                log_error("drop meta delta %s of %s", hexmem(operand.data(), operand.size()).c_str(),
+                          hexmem(merge_in.key.data(), merge_in.key.size()).c_str());
+            }
+        }
+        // nothing to write a value from
+        return exists;
+    }
+
+    bool PartialMerge(const rocksdb::Slice &key, const rocksdb::Slice &left_operand,
+                      const rocksdb::Slice &right_operand, std::string *new_value,
+                      rocksdb::Logger *logger) const override {
+        return combine_meta_delta(Bytes(left_operand.data(), (int) left_operand.size()),
+                                  Bytes(right_operand.data(), (int) right_operand.size()), new_value) == 0;
+    }
+};
+
+#endif
+
+#endif //SSDB_T_MERGE_H
@@ -43,6 +43,8 @@ int SSDBImpl::incr_ssize(Context &ctx, const Bytes &key, leveldb::WriteBatch &ba
             expiration->cancelExpiration(ctx, key, batch); //del expire ET key
 
             ret = 0;
+        } else if (meta_merge) {
+            batch.Merge(meta_key, encode_meta_delta(DataType::SSIZE, incr));
         } else {
             std::string meta_val = encode_set_meta_val(len, sv.version);
             batch.Put(meta_key, meta_val);
@@ -121,15 +123,24 @@ int SSDBImpl::srem(Context &ctx, const Bytes &key, const std::vector<Bytes> &mem
         return ret;
     }
 
+    std::vector<std::string> hkeys;
     for (int i = 2; i < members.size(); ++i) {
-        const Bytes &member = members[i];
-        std::string hkey = encode_set_key(key, member, sv.version);
-        int s = GetSetItemValInternal(hkey);
-        if (s == 1) {
+        hkeys.push_back(encode_set_key(key, members[i], sv.version));
+    }
+
+    std::vector<std::string> vals;
+    std::vector<int> found;
+    int mret = ldbMultiGet(leveldb::ReadOptions(), hkeys, &vals, &found);
+    if (mret < 0) {
+        return mret;
+    }
+
+    std::set<std::string> deleted;
+    for (size_t i = 0; i < hkeys.size(); ++i) {
+        // a member repeated in the request is removed once
+        if (found[i] && deleted.insert(hkeys[i]).second) {
             *num += 1;
-            batch.Delete(hkey);
-        } else if (s < 0) {
-            return s;
+            batch.Delete(hkeys[i]);
         }
     }
 
@@ -354,7 +365,7 @@ int SSDBImpl::smembers(Context &ctx, const Bytes &key, std::vector<std::string>
 
 int SSDBImpl::GetSetMetaVal(const std::string &meta_key, SetMetaVal &sv) {
     std::string meta_val;
-    leveldb::Status s = ldb->Get(leveldb::ReadOptions(), meta_key, &meta_val);
+    leveldb::Status s = ldbGet(leveldb::ReadOptions(), meta_key, &meta_val);
     if (s.IsNotFound()) {
         //not found
         sv.length = 0;
@@ -391,7 +402,7 @@ int SSDBImpl::GetSetMetaVal(const std::string &meta_key, SetMetaVal &sv) {
 
 int SSDBImpl::GetSetItemValInternal(const std::string &item_key) {
     std::string val;
-    leveldb::Status s = ldb->Get(leveldb::ReadOptions(), item_key, &val);
+    leveldb::Status s = ldbGet(leveldb::ReadOptions(), item_key, &val);
     if (s.IsNotFound()) {
         return 0;
     } else if (!s.ok() && !s.IsNotFound()) {
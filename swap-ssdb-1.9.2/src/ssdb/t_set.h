@@ -85,27 +85,27 @@ int SSDBImpl::saddNoLock(Context &ctx, const Bytes &key, const std::set<T> &mem_
     }
 
     *num = 0;
+    std::vector<std::string> item_keys;
+    item_keys.reserve(mem_set.size());
     typename std::set<T>::const_iterator it = mem_set.begin();
     for (; it != mem_set.end(); ++it) {
-        const T &member = *it;
-        int change = 0;
-
-        std::string item_key = encode_set_key(key, member, sv.version);
-        if (ret == 0) {
-            batch.Put(item_key, slice());
-            change = 1;
-        } else {
-            int s = GetSetItemValInternal(item_key);
-            if (s < 0) {
-                return s;
-            } else if (s == 1) {
-                change = 0;
-            } else {
-                batch.Put(item_key, slice());
-                change = 1;
-            }
+        item_keys.push_back(encode_set_key(key, *it, sv.version));
+    }
+
+    std::vector<std::string> vals;
+    std::vector<int> found(item_keys.size(), 0);
+    if (ret != 0) {
+        int s = ldbMultiGet(leveldb::ReadOptions(), item_keys, &vals, &found);
+        if (s < 0) {
+            return s;
+        }
+    }
+
+    for (size_t i = 0; i < item_keys.size(); i++) {
+        if (!found[i]) {
+            batch.Put(item_keys[i], slice());
+            *num += 1;
         }
-        *num += change;
     }
 
     int iret = incr_ssize(ctx, key, batch, sv, meta_key, *num);
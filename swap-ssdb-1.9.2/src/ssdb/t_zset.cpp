@@ -25,6 +25,7 @@ int SSDBImpl::multi_zdel(Context &ctx, const Bytes &name, const std::set<Bytes>
 int SSDBImpl::zdelNoLock(Context &ctx, const Bytes &name, const std::set<Bytes> &keys, int64_t *count) {
     ZSetMetaVal zv;
     leveldb::WriteBatch batch;
+    ZRankDelta rank_delta;
 
     std::string meta_key = encode_meta_key(name);
     int ret = GetZSetMetaVal(meta_key, zv);
@@ -32,13 +33,30 @@ int SSDBImpl::zdelNoLock(Context &ctx, const Bytes &name, const std::set<Bytes>
         return ret;
     }
 
+    std::vector<std::string> zkeys;
+    zkeys.reserve(keys.size());
     for (auto it = keys.begin(); it != keys.end(); ++it) {
-        const Bytes &key = *it;
-        ret = zdel_one(batch, name, key, zv.version);
-        if (ret < 0) {
-            return ret;
+        zkeys.push_back(encode_zset_key(name, *it, zv.version));
+    }
+
+    std::vector<std::string> vals;
+    std::vector<int> found;
+    ret = ldbMultiGet(leveldb::ReadOptions(), zkeys, &vals, &found);
+    if (ret < 0) {
+        return ret;
+    }
+
+    size_t i = 0;
+    for (auto it = keys.begin(); it != keys.end(); ++it, ++i) {
+        if (found[i]) {
+            zdel_one(batch, rank_delta, name, *it, *((double *) (vals[i].data())), zv.version);
+            *count += 1;
         }
-        *count += ret;
+    }
+
+    ret = zrank_index_commit(batch, rank_delta);
+    if (ret < 0) {
+        return ret;
     }
 
     int iret = incr_zsize(ctx, name, batch, zv, -(*count));
@@ -62,6 +80,7 @@ int SSDBImpl::zdelNoLock(Context &ctx, const Bytes &name, const std::set<Bytes>
 int SSDBImpl::zincr(Context &ctx, const Bytes &name, const Bytes &key, double by, int &flags, double *new_val) {
     RecordKeyLock l(&mutex_record_, name.String());
     leveldb::WriteBatch batch;
+    ZRankDelta rank_delta;
     ZSetMetaVal zv;
     bool needCheck = false;
 
@@ -76,7 +95,12 @@ int SSDBImpl::zincr(Context &ctx, const Bytes &name, const Bytes &key, double by
         needCheck = true;
     }
 
-    int retval = zset_one(batch, needCheck, name, key, by, zv.version, &flags, new_val);
+    int retval = zset_one(batch, rank_delta, needCheck, name, key, by, zv.version, &flags, new_val);
+    if (retval < 0) {
+        return retval;
+    }
+
+    retval = zrank_index_commit(batch, rank_delta);
     if (retval < 0) {
         return retval;
     }
@@ -115,7 +139,7 @@ int SSDBImpl::zsize(Context &ctx, const Bytes &name, uint64_t *size) {
 
 int SSDBImpl::GetZSetMetaVal(const std::string &meta_key, ZSetMetaVal &zv) {
     std::string meta_val;
-    leveldb::Status s = ldb->Get(leveldb::ReadOptions(), meta_key, &meta_val);
+    leveldb::Status s = ldbGet(leveldb::ReadOptions(), meta_key, &meta_val);
     if (s.IsNotFound()) {
         zv.length = 0;
         zv.del = KEY_ENABLED_MASK;
@@ -150,7 +174,7 @@ int SSDBImpl::GetZSetMetaVal(const std::string &meta_key, ZSetMetaVal &zv) {
 
 int SSDBImpl::GetZSetItemVal(const std::string &item_key, double *score) {
     std::string str_score;
-    leveldb::Status s = ldb->Get(leveldb::ReadOptions(), item_key, &str_score);
+    leveldb::Status s = ldbGet(leveldb::ReadOptions(), item_key, &str_score);
     if (s.IsNotFound()) {
         return 0;
     }
@@ -176,7 +200,7 @@ int SSDBImpl::zget(Context &ctx, const Bytes &name, const Bytes &key, double *sc
 
     std::string str_score;
     std::string dbkey = encode_zset_key(name, key, zv.version);
-    leveldb::Status s = ldb->Get(leveldb::ReadOptions(), dbkey, &str_score);
+    leveldb::Status s = ldbGet(leveldb::ReadOptions(), dbkey, &str_score);
     if (s.IsNotFound()) {
         return 0;
     }
@@ -247,6 +271,7 @@ SSDBImpl::zscanbylex_internal(Context &ctx, const Bytes &name, const Bytes &key_
 
 int SSDBImpl::zrank(Context &ctx, const Bytes &name, const Bytes &key, int64_t *rank) {
     ZSetMetaVal zv;
+    double score = 0;
     const leveldb::Snapshot *snapshot = nullptr;
 
     {
@@ -257,15 +282,37 @@ int SSDBImpl::zrank(Context &ctx, const Bytes &name, const Bytes &key, int64_t *
             return ret;
         }
 
+        ret = GetZSetItemVal(encode_zset_key(name, key, zv.version), &score);
+        if (ret < 0) {
+            return ret;
+        } else if (ret == 0) {
+            *rank = -1;
+            return 1;
+        }
+
         snapshot = GetSnapshot();
     }
 
     SnapshotPtr spl(ldb, snapshot); //auto release
 
+    int ret = zrank_index_valid(name, zv, snapshot);
+    if (ret < 0) {
+        return ret;
+    } else if (ret == 1) {
+        uint64_t index_rank = 0;
+        ret = zrank_index_rank(name, key, score, zv.version, snapshot, &index_rank);
+        if (ret < 0) {
+            return ret;
+        }
+        *rank = (int64_t) index_rank;
+        return 1;
+    }
+
+    //zset written before rank index existed, scan it
     bool found = false;
     auto it = std::unique_ptr<ZIterator>(
             this->zscan_internal(ctx, name, "", "", INT_MAX, Iterator::FORWARD, zv.version, snapshot));
-    uint64_t ret = 0;
+    uint64_t count = 0;
     while (true) {
         if (!it->next()) {
             break;
@@ -274,16 +321,17 @@ int SSDBImpl::zrank(Context &ctx, const Bytes &name, const Bytes &key, int64_t *
             found = true;
             break;
         }
-        ret++;
+        count++;
     }
 
-    *rank = found ? (int64_t) ret : -1;
+    *rank = found ? (int64_t) count : -1;
 
     return 1;
 }
 
 int SSDBImpl::zrrank(Context &ctx, const Bytes &name, const Bytes &key, int64_t *rank) {
     ZSetMetaVal zv;
+    double score = 0;
     const leveldb::Snapshot *snapshot = nullptr;
 
     {
@@ -295,14 +343,37 @@ int SSDBImpl::zrrank(Context &ctx, const Bytes &name, const Bytes &key, int64_t
             return ret;
         }
 
+        ret = GetZSetItemVal(encode_zset_key(name, key, zv.version), &score);
+        if (ret < 0) {
+            return ret;
+        } else if (ret == 0) {
+            *rank = -1;
+            return 1;
+        }
+
         snapshot = GetSnapshot();
     }
 
     SnapshotPtr spl(ldb, snapshot); //auto release
+
+    int ret = zrank_index_valid(name, zv, snapshot);
+    if (ret < 0) {
+        return ret;
+    } else if (ret == 1) {
+        uint64_t index_rank = 0;
+        ret = zrank_index_rank(name, key, score, zv.version, snapshot, &index_rank);
+        if (ret < 0) {
+            return ret;
+        }
+        *rank = (int64_t) (zv.length - 1 - index_rank);
+        return 1;
+    }
+
+    //zset written before rank index existed, scan it
     bool found = false;
     auto it = std::unique_ptr<ZIterator>(
             this->zscan_internal(ctx, name, "", "", INT_MAX, Iterator::BACKWARD, zv.version, snapshot));
-    uint64_t ret = 0;
+    uint64_t count = 0;
     while (true) {
         if (!it->next()) {
             break;
@@ -311,10 +382,10 @@ int SSDBImpl::zrrank(Context &ctx, const Bytes &name, const Bytes &key, int64_t
             found = true;
             break;
         }
-        ret++;
+        count++;
     }
 
-    *rank = found ? (int64_t) ret : -1;
+    *rank = found ? (int64_t) count : -1;
 
     return 1;
 }
@@ -366,14 +437,52 @@ int SSDBImpl::zrangeGeneric(Context &ctx, const Bytes &name, const Bytes &begin,
 
     SnapshotPtr spl(ldb, snapshot);
 
-    if (reverse) {
-        it = this->zscan_internal(ctx, name, "", "", end + 1, Iterator::BACKWARD, version, snapshot);
-    } else {
-        it = this->zscan_internal(ctx, name, "", "", end + 1, Iterator::FORWARD, version, snapshot);
+    uint64_t skip = (uint64_t) start;
+
+    int ret = zrank_index_valid(name, zv, snapshot);
+    if (ret < 0) {
+        return ret;
+    } else if (ret == 1 && start > 0) {
+        // jump to the score of the first member in range, then skip within that score
+        uint64_t forward_rank = reverse ? (uint64_t) (llen - 1 - start) : (uint64_t) start;
+        std::string score_bits;
+        uint64_t offset = 0, ties = 0;
+        ret = zrank_index_seek(name, version, forward_rank, snapshot, &score_bits, &offset, &ties);
+        if (ret < 0) {
+            return ret;
+        } else if (ret == 1) {
+            std::string score_key = encode_zscore_prefix(name, version);
+            if (reverse) {
+                // seek to the first key past this score, rev_iterator steps back from there
+                uint64_t next_bits = 0;
+                memcpy(&next_bits, score_bits.data(), sizeof(uint64_t));
+                next_bits = htobe64(be64toh(next_bits) + 1);
+                score_key.append((char *) &next_bits, sizeof(uint64_t));
+
+                skip = ties - 1 - offset;
+                std::string score_end = encode_zscore_key(name, "", -std::numeric_limits<double>::quiet_NaN(), version);
+                it = new ZIterator(this->rev_iterator(score_key, score_end, end - start + 1 + skip, snapshot), name, version);
+            } else {
+                score_key.append(score_bits);
+
+                skip = offset;
+                std::string score_end = encode_zscore_key(name, "", std::numeric_limits<double>::quiet_NaN(), version);
+                it = new ZIterator(this->iterator(score_key, score_end, end - start + 1 + skip, snapshot), name, version);
+            }
+        }
+    }
+
+    if (it == NULL) {
+        skip = (uint64_t) start;
+        if (reverse) {
+            it = this->zscan_internal(ctx, name, "", "", end + 1, Iterator::BACKWARD, version, snapshot);
+        } else {
+            it = this->zscan_internal(ctx, name, "", "", end + 1, Iterator::FORWARD, version, snapshot);
+        }
     }
 
     if (it != NULL) {
-        it->skip(start);
+        it->skip(skip);
         while (it->next()) {
             key_score.emplace_back(it->key.String());
             key_score.push_back(str(it->score));
@@ -620,6 +729,7 @@ int SSDBImpl::zremrangebyscore(Context &ctx, const Bytes &name, const Bytes &sco
     }
 
     leveldb::WriteBatch batch;
+    ZRankDelta rank_delta;
     const leveldb::Snapshot *snapshot = nullptr;
     auto it = std::unique_ptr<ZIterator>(
             this->zscan_internal(ctx, name, start_score, end_score, -1, Iterator::FORWARD, zv.version, snapshot));
@@ -635,7 +745,7 @@ int SSDBImpl::zremrangebyscore(Context &ctx, const Bytes &name, const Bytes &sco
             break;
 
         if (remove) {
-            int dret = zdel_one(batch, name, it->key, it->version);
+            int dret = zdel_one(batch, rank_delta, name, it->key, it->version);
             if (dret < 0) {
                 return dret;
             }
@@ -646,6 +756,11 @@ int SSDBImpl::zremrangebyscore(Context &ctx, const Bytes &name, const Bytes &sco
     ret = 1;
 
     if (remove) {
+        int rret = zrank_index_commit(batch, rank_delta);
+        if (rret < 0) {
+            return rret;
+        }
+
         int iret = incr_zsize(ctx, name, batch, zv, -1 * (*count));
         if (iret < 0) {
             return iret;
@@ -664,24 +779,30 @@ int SSDBImpl::zremrangebyscore(Context &ctx, const Bytes &name, const Bytes &sco
 }
 
 
-int SSDBImpl::zdel_one(leveldb::WriteBatch &batch, const Bytes &name, const Bytes &key, uint16_t version) {
+int SSDBImpl::zdel_one(leveldb::WriteBatch &batch, ZRankDelta &rank_delta, const Bytes &name, const Bytes &key,
+                       uint16_t version) {
     double old_score = 0;
     std::string item_key = encode_zset_key(name, key, version);
     int ret = GetZSetItemVal(item_key, &old_score);
     if (ret <= 0) {
         return ret;
-    } else {
-        //found
-        std::string old_score_key = encode_zscore_key(name, key, old_score, version);
-        std::string old_zset_key = encode_zset_key(name, key, version);
-
-        batch.Delete(old_score_key);
-        batch.Delete(old_zset_key);
     }
 
+    zdel_one(batch, rank_delta, name, key, old_score, version);
     return 1;
 }
 
+void SSDBImpl::zdel_one(leveldb::WriteBatch &batch, ZRankDelta &rank_delta, const Bytes &name, const Bytes &key,
+                        double old_score, uint16_t version) {
+    std::string old_score_key = encode_zscore_key(name, key, old_score, version);
+    std::string old_zset_key = encode_zset_key(name, key, version);
+
+    batch.Delete(old_score_key);
+    batch.Delete(old_zset_key);
+
+    zrank_index_incr(rank_delta, name, old_score, version, -1);
+}
+
 int
 SSDBImpl::incr_zsize(Context &ctx, const Bytes &name, leveldb::WriteBatch &batch, const ZSetMetaVal &zv, int64_t incr) {
     std::string size_key = encode_meta_key(name);
@@ -720,6 +841,8 @@ SSDBImpl::incr_zsize(Context &ctx, const Bytes &name, leveldb::WriteBatch &batch
             expiration->cancelExpiration(ctx, name, batch); //del expire ET key
 
             ret = 0;
+        } else if (meta_merge) {
+            batch.Merge(size_key, encode_meta_delta(DataType::ZSIZE, incr));
         } else {
             std::string meta_val = encode_zset_meta_val(len, zv.version);
             batch.Put(size_key, meta_val);
@@ -732,8 +855,24 @@ SSDBImpl::incr_zsize(Context &ctx, const Bytes &name, leveldb::WriteBatch &batch
 }
 
 
-int SSDBImpl::zset_one(leveldb::WriteBatch &batch, bool needCheck, const Bytes &name, const Bytes &key, double score,
-                       uint16_t cur_version, int *flags, double *newscore) {
+int SSDBImpl::zset_one(leveldb::WriteBatch &batch, ZRankDelta &rank_delta, bool needCheck, const Bytes &name,
+                       const Bytes &key, double score, uint16_t cur_version, int *flags, double *newscore) {
+    double old_score = 0;
+    int found = 0;
+
+    if (needCheck && !std::isnan(score)) {
+        found = GetZSetItemVal(encode_zset_key(name, key, cur_version), &old_score);
+        if (found < 0) {
+            return found;
+        }
+    }
+
+    return zset_one(batch, rank_delta, found == 1, old_score, name, key, score, cur_version, flags, newscore);
+}
+
+int SSDBImpl::zset_one(leveldb::WriteBatch &batch, ZRankDelta &rank_delta, bool found, double old_score,
+                       const Bytes &name, const Bytes &key, double score, uint16_t cur_version, int *flags,
+                       double *newscore) {
 
     /* Turn options into simple to check vars. */
     int incr = (*flags & ZADD_INCR) != 0;
@@ -750,84 +889,212 @@ int SSDBImpl::zset_one(leveldb::WriteBatch &batch, bool needCheck, const Bytes &
 
     std::string zkey = encode_zset_key(name, key, cur_version);
 
-    if (needCheck) {
-        double old_score = 0;
+    if (!found) {
+        if (!xx) {
+            if (newscore) *newscore = score;
 
-        int found = GetZSetItemVal(zkey, &old_score);
-        if (found < 0) {
-            return found;
+            std::string buf((char *) (&score), sizeof(double));
+            batch.Put(zkey, buf);
+            string score_key = encode_zscore_key(name, key, score, cur_version);
+            batch.Put(score_key, "");
+            zrank_index_incr(rank_delta, name, score, cur_version, 1);
+
+            *flags |= ZADD_ADDED;
+        } else {
+            *flags |= ZADD_NOP;
         }
 
-        if (found == 0) {
-            if (!xx) {
-                if (newscore) *newscore = score;
+        return 1;
+    }
 
-                std::string buf((char *) (&score), sizeof(double));
-                batch.Put(zkey, buf);
-                string score_key = encode_zscore_key(name, key, score, cur_version);
-                batch.Put(score_key, "");
+    if (nx) {
+        *flags |= ZADD_NOP;
+        return 1;
+    }
 
-                *flags |= ZADD_ADDED;
-            } else {
-                *flags |= ZADD_NOP;
-            }
+    if (incr) {
+        score += old_score;
+        if (std::isnan(score)) {
+            *flags |= ZADD_NAN;
+            return NAN_SCORE;
+        }
 
-            return 1;
+        if (newscore) *newscore = score;
+    }
 
-        } else if (found == 1) {
-            if (nx) {
-                *flags |= ZADD_NOP;
-                return 1;
-            }
+    if (old_score == score) {
+        //same
+    } else {
+        if (newscore) *newscore = score;
 
-            if (incr) {
-                score += old_score;
-                if (std::isnan(score)) {
-                    *flags |= ZADD_NAN;
-                    return NAN_SCORE;
-                }
+        string old_score_key = encode_zscore_key(name, key, old_score, cur_version);
+        batch.Delete(old_score_key);
+        zrank_index_incr(rank_delta, name, old_score, cur_version, -1);
 
-                if (newscore) *newscore = score;
-            }
+        std::string buf((char *) (&score), sizeof(double));
+        batch.Put(zkey, buf);
+        string score_key = encode_zscore_key(name, key, score, cur_version);
+        batch.Put(score_key, "");
+        zrank_index_incr(rank_delta, name, score, cur_version, 1);
 
-            if (old_score == score) {
-                //same
-            } else {
-                if (newscore) *newscore = score;
+        *flags |= ZADD_UPDATED;
+    }
+    return 1;
+}
 
-                string old_score_key = encode_zscore_key(name, key, old_score, cur_version);
-                batch.Delete(old_score_key);
+/*
+ * Rank index: a radix tree over the 8 bytes of the encoded score. The node at
+ * level l counts the members whose score starts with the node's l bytes, level
+ * 0 is the root which counts all indexed members. A rank is the sum of the
+ * smaller siblings along the path of the score, at most 255 nodes per level,
+ * plus the members sharing the same score, so it no longer depends on the size
+ * of the zset.
+ *
+ * Nodes are updated in the same batch as the zscore keys. Zsets written before
+ * the index existed have root != length, and fall back to scanning.
+ */
+void SSDBImpl::zrank_index_incr(ZRankDelta &rank_delta, const Bytes &name, double score, uint16_t version,
+                                int64_t incr) {
+    uint64_t score_bits = htobe64(encodeScore(score));
+    const char *prefix = (const char *) &score_bits;
 
-                std::string buf((char *) (&score), sizeof(double));
-                batch.Put(zkey, buf);
-                string score_key = encode_zscore_key(name, key, score, cur_version);
-                batch.Put(score_key, "");
+    for (uint8_t level = 0; level <= ZRANK_INDEX_LEVELS; level++) {
+        rank_delta[encode_zrank_key(name, version, level, Bytes(prefix, level))] += incr;
+    }
+}
 
-                *flags |= ZADD_UPDATED;
-            }
-            return 1;
+static int64_t decode_zrank_count(const leveldb::Slice &val) {
+    if (val.size() != sizeof(uint64_t)) {
+        return 0;
+    }
+    uint64_t count = 0;
+    memcpy(&count, val.data(), sizeof(uint64_t));
+    return (int64_t) be64toh(count);
+}
+
+int SSDBImpl::zrank_index_commit(leveldb::WriteBatch &batch, const ZRankDelta &rank_delta) {
+    for (const auto &it : rank_delta) {
+        if (it.second == 0) {
+            continue;
+        }
+
+        std::string val;
+        leveldb::Status s = ldbGet(leveldb::ReadOptions(), it.first, &val);
+        if (!s.ok() && !s.IsNotFound()) {
+            log_error("zrank_index_commit error: %s", s.ToString().c_str());
+            return STORAGE_ERR;
+        }
+
+        // counts of zsets older than the index may go negative, they are kept
+        // so that the root keeps telling the index is incomplete
+        int64_t count = (s.ok() ? decode_zrank_count(val) : 0) + it.second;
+        if (count == 0) {
+            batch.Delete(it.first);
         } else {
-            //error
-            return -1;
+            uint64_t buf = htobe64((uint64_t) count);
+            batch.Put(it.first, leveldb::Slice((char *) &buf, sizeof(uint64_t)));
         }
-    } else {
+    }
 
-        if (!xx) {
-            if (newscore) *newscore = score;
+    return 1;
+}
 
-            std::string buf((char *) (&score), sizeof(double));
-            batch.Put(zkey, buf);
-            string score_key = encode_zscore_key(name, key, score, cur_version);
-            batch.Put(score_key, "");
+/**
+ * @return -1: error, 0: index is not complete, 1: index can be used
+ */
+int SSDBImpl::zrank_index_valid(const Bytes &name, const ZSetMetaVal &zv, const leveldb::Snapshot *snapshot) {
+    leveldb::ReadOptions options;
+    options.snapshot = snapshot;
 
-            *flags |= ZADD_ADDED;
-        } else {
-            *flags |= ZADD_NOP;
+    std::string val;
+    leveldb::Status s = ldbGet(options, encode_zrank_key(name, zv.version, 0, ""), &val);
+    if (s.IsNotFound()) {
+        return 0;
+    } else if (!s.ok()) {
+        log_error("zrank_index_valid error: %s", s.ToString().c_str());
+        return STORAGE_ERR;
+    }
+
+    return decode_zrank_count(val) == (int64_t) zv.length ? 1 : 0;
+}
+
+int SSDBImpl::zrank_index_rank(const Bytes &name, const Bytes &key, double score, uint16_t version,
+                               const leveldb::Snapshot *snapshot, uint64_t *rank) {
+    uint64_t score_bits = htobe64(encodeScore(score));
+    const char *prefix = (const char *) &score_bits;
+
+    leveldb::ReadOptions options(false, true);
+    options.snapshot = snapshot;
+    options.total_order_seek = true; // walks zrank and then zscore keys
+    // rank index and score keys share a column family
+    std::unique_ptr<leveldb::Iterator> it(ldb->NewIterator(options, cfOf(DataType::ZSCORE)));
+
+    int64_t count = 0;
+    for (uint8_t level = 1; level <= ZRANK_INDEX_LEVELS; level++) {
+        // siblings before the node of this score
+        std::string start = encode_zrank_key(name, version, level, Bytes(prefix, level - 1));
+        std::string end = encode_zrank_key(name, version, level, Bytes(prefix, level));
+        for (it->Seek(start); it->Valid() && it->key().compare(end) < 0; it->Next()) {
+            count += decode_zrank_count(it->value());
         }
+    }
 
-        return 1;
+    // members with the same score are sorted by member
+    std::string start = encode_zscore_key(name, "", score, version);
+    std::string end = encode_zscore_key(name, key, score, version);
+    for (it->Seek(start); it->Valid() && it->key().compare(end) < 0; it->Next()) {
+        count++;
+    }
+
+    if (!it->status().ok()) {
+        log_error("zrank_index_rank error: %s", it->status().ToString().c_str());
+        return STORAGE_ERR;
+    }
+
+    *rank = (uint64_t) count;
+    return 1;
+}
+
+/**
+ * find the score of the member at rank, and its offset among the `ties` members of that score
+ * @return -1: error, 0: index is not consistent, 1: found
+ */
+int SSDBImpl::zrank_index_seek(const Bytes &name, uint16_t version, uint64_t rank, const leveldb::Snapshot *snapshot,
+                               std::string *score_bits, uint64_t *offset, uint64_t *ties) {
+    leveldb::ReadOptions options(false, true);
+    options.snapshot = snapshot;
+    options.prefix_same_as_start = true;
+    std::unique_ptr<leveldb::Iterator> it(ldb->NewIterator(options, cfOf(DataType::ZRANK)));
+
+    std::string prefix;
+    int64_t remain = (int64_t) rank;
+    for (uint8_t level = 1; level <= ZRANK_INDEX_LEVELS; level++) {
+        std::string start = encode_zrank_key(name, version, level, prefix);
+
+        bool found = false;
+        for (it->Seek(start); it->Valid() && it->key().starts_with(start); it->Next()) {
+            int64_t count = decode_zrank_count(it->value());
+            if (remain < count) {
+                prefix.append(1, it->key()[it->key().size() - 1]);
+                *ties = (uint64_t) count;
+                found = true;
+                break;
+            }
+            remain -= count;
+        }
+
+        if (!it->status().ok()) {
+            log_error("zrank_index_seek error: %s", it->status().ToString().c_str());
+            return STORAGE_ERR;
+        }
+        if (!found) {
+            return 0;
+        }
     }
 
+    *score_bits = prefix;
+    *offset = (uint64_t) remain;
+    return 1;
 }
 
 
@@ -979,6 +1246,7 @@ int SSDBImpl::zremrangebylex(Context &ctx, const Bytes &name, const Bytes &key_s
     }
 
     leveldb::WriteBatch batch;
+    ZRankDelta rank_delta;
     const leveldb::Snapshot *snapshot = nullptr;
     auto it = std::unique_ptr<ZIteratorByLex>(
             this->zscanbylex_internal(ctx, name, range.min, range.max, -1, Iterator::FORWARD, zv.version, snapshot));
@@ -987,7 +1255,7 @@ int SSDBImpl::zremrangebylex(Context &ctx, const Bytes &name, const Bytes &key_s
         if (zslLexValueGteMin(it->key.String(), &range)) {
             if (zslLexValueLteMax(it->key.String(), &range)) {
                 (*count)++;
-                ret = zdel_one(batch, name, it->key, it->version);
+                ret = zdel_one(batch, rank_delta, name, it->key, it->version);
                 if (ret < 0) {
                     return ret;
                 }
@@ -996,6 +1264,11 @@ int SSDBImpl::zremrangebylex(Context &ctx, const Bytes &name, const Bytes &key_s
         }
     }
 
+    ret = zrank_index_commit(batch, rank_delta);
+    if (ret < 0) {
+        return ret;
+    }
+
     int iret = incr_zsize(ctx, name, batch, zv, -1 * (*count));
     if (iret < 0) {
         return iret;
@@ -17,6 +17,7 @@ int SSDBImpl::quickZset(Context &ctx, const Bytes &name, const std::string &meta
 
 
     leveldb::WriteBatch batch;
+    ZRankDelta rank_delta;
 
     int ret = 0;
     ZSetMetaVal zv;
@@ -58,9 +59,15 @@ int SSDBImpl::quickZset(Context &ctx, const Bytes &name, const std::string &meta
 
         string score_key = encode_zscore_key(name, key, score, zv.version);
         batch.Put(score_key, slice());
+        zrank_index_incr(rank_delta, name, score, zv.version, 1);
         sum++;
     }
 
+    ret = zrank_index_commit(batch, rank_delta);
+    if (ret < 0) {
+        return ret;
+    }
+
     int iret = incr_zsize(ctx, name, batch, zv, sum);
     if (iret < 0) {
         log_error("incr_zsize error");
@@ -103,6 +110,7 @@ int SSDBImpl::zsetNoLock(Context &ctx, const Bytes &name, const std::map<T, T> &
 
 
     leveldb::WriteBatch batch;
+    ZRankDelta rank_delta;
 
     ZSetMetaVal zv;
     std::string meta_key = encode_meta_key(name);
@@ -118,12 +126,33 @@ int SSDBImpl::zsetNoLock(Context &ctx, const Bytes &name, const std::map<T, T> &
         needCheck = true;
     }
 
+    // one batched probe instead of a Get per member
+    std::vector<std::string> old_vals;
+    std::vector<int> found(sortedSet.size(), 0);
+    if (needCheck) {
+        std::vector<std::string> zkeys;
+        zkeys.reserve(sortedSet.size());
+        for (auto const &it : sortedSet) {
+            zkeys.push_back(encode_zset_key(name, it.first, zv.version));
+        }
+
+        int mret = ldbMultiGet(leveldb::ReadOptions(), zkeys, &old_vals, &found);
+        if (mret < 0) {
+            return mret;
+        }
+    }
+
     double newscore;
+    size_t i = 0;
 
     for (auto const &it : sortedSet) {
         const Bytes &key = it.first;
         const Bytes &val = it.second;
 
+        bool exists = found[i] == 1;
+        double old_score = exists ? *((double *) (old_vals[i].data())) : 0;
+        i++;
+
 //        log_info("%s:%s" , hexmem(key.data(),key.size()).c_str(), hexmem(val.data(),val.size()).c_str());
 
         double score = val.Double();
@@ -133,7 +162,7 @@ int SSDBImpl::zsetNoLock(Context &ctx, const Bytes &name, const std::map<T, T> &
 
         int retflags = flags;
 
-        int retval = zset_one(batch, needCheck, name, key, score, zv.version, &retflags, &newscore);
+        int retval = zset_one(batch, rank_delta, exists, old_score, name, key, score, zv.version, &retflags, &newscore);
         if (retval < 0) {
             return retval;
         }
@@ -143,6 +172,11 @@ int SSDBImpl::zsetNoLock(Context &ctx, const Bytes &name, const std::map<T, T> &
         if (!(retflags & ZADD_NOP)) processed++;
     }
 
+    int rret = zrank_index_commit(batch, rank_delta);
+    if (rret < 0) {
+        return rret;
+    }
+
     int iret = incr_zsize(ctx, name, batch, zv, added);
     if (iret < 0) {
         log_error("incr_zsize error");
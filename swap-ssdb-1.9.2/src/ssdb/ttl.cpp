@@ -336,6 +336,7 @@ int ExpirationHandler::clear() {
     CHECK_DISABLD_EXPIRE
 
     fast_keys.clear();
+    first_timeout = 0; // reload from db on the next loop
 
     return 0;
 }
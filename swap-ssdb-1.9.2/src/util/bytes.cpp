@@ -63,6 +63,21 @@ int Buffer::grow(){ // 扩大缓冲区
 	return total_;
 }
 
+int Buffer::reserve(int size){
+	if(size <= this->space()){
+		return total_;
+	}
+	int n = (int)(data_ - buf) + size_ + size;
+	char *p = (char *)realloc(buf, n);
+	if(p == NULL){
+		return -1;
+	}
+	data_ = p + (data_ - buf);
+	buf = p;
+	total_ = n;
+	return total_;
+}
+
 std::string Buffer::stats() const{
 	char str[1024 * 32];
 	str[0] = '\n';
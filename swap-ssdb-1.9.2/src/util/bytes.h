@@ -204,6 +204,8 @@ class Buffer{
 		void nice();
 		// 扩大缓冲区
 		int grow();
+		// 一次扩大到至少有 size 字节空闲
+		int reserve(int size);
 		// 缩小缓冲区, 如果指定的 total 太小超过数据范围, 或者不合理, 则不会缩小
 		void shrink(int total=0);
 
@@ -31,5 +31,6 @@ const int INVALID_DUMP_STR             = -21;
 const int INVALID_ARGS                 = -22;
 const int VALUE_OUT_OF_RANGE           = -23;
 const int INVALID_MIN_MAX_DBL          = -24;
+const int KEY_FORMAT_ERR               = -25;
 
 #endif //SSDB_REDIS_ERROR_H
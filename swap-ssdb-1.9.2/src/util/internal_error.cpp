@@ -34,6 +34,7 @@ std::map<int, std::string> SSDBErrMap = {
         {BUSY_KEY_EXISTS,             "BUSYKEY Target key name already exists."},
         {INVALID_DUMP_STR,            "ERR DUMP payload version or checksum are wrong"},
         {INVALID_ARGS,                "ERR wrong number of arguments"},
+        {KEY_FORMAT_ERR,              "ERR slot commands need rocksdb.key_slot_prefix enabled"},
 };
 
 
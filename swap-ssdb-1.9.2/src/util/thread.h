@@ -16,9 +16,13 @@ found in the LICENSE file.
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <functional>
 #include <sys/time.h>
 #include <atomic>
 #include <set>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
 
 class Mutex{
 	private:
@@ -103,6 +107,9 @@ class Locking{
 
 };
 
+template <typename T>
+class RecordMutex;
+
 template <typename T>
 class RefMutex {
 public:
@@ -123,11 +130,9 @@ public:
 		refs_++;
 	}
 
-	void Unref() {
-		--refs_;
-		if (refs_ == 0) {
-			delete this;
-		}
+	// true when the last holder is gone and the node can be reused
+	bool Unref() {
+		return --refs_ == 0;
 	}
 
 	bool IsLastRef() {
@@ -135,113 +140,163 @@ public:
 	}
 
 private:
+	friend class RecordMutex<T>;
+
 	T mu_;
 	int refs_;
 
+	// chain of a RecordMutex bucket, or of its free list
+	std::string key_;
+	RefMutex *next_ = nullptr;
+
 	// No copying
 	RefMutex(const RefMutex&);
 	void operator=(const RefMutex&);
 };
 
+/*
+ * per key locks, striped over kShards independent tables so commands on
+ * different keys rarely meet on the same mutex. nodes of released keys are
+ * kept in a per shard pool and reused, their key buffer included.
+ * lock()/unlock() take all keys at once: new key lockers wait and the
+ * holder waits until every held key is released.
+ */
 template <typename T>
 class RecordMutex {
 public:
-	RecordMutex() : charge_(0) {}
+	static const size_t kShards = 64;
+	static const size_t kBuckets = 64;
+	static const size_t kPoolSize = 64;
 
-	~RecordMutex() {
-		mutex_.lock();
+	RecordMutex() : global_(false) {}
 
-		typename std::unordered_map<std::string, RefMutex<T> *>::const_iterator it = records_.begin();
-		for (; it != records_.end(); it++) {
-			delete it->second;
+	~RecordMutex() {
+		for (size_t i = 0; i < kShards; i++) {
+			Shard &shard = shards_[i];
+			for (size_t j = 0; j < kBuckets; j++) {
+				free_chain(shard.buckets[j]);
+			}
+			free_chain(shard.pool);
 		}
-		mutex_.unlock();
 	}
 
+	// number of keys held or waited for
 	int64_t GetUsage() {
-		int64_t size = 0;
-		mutex_.lock();
-		size = charge_;
-		mutex_.unlock();
-		return size;
+		int64_t usage = 0;
+		for (size_t i = 0; i < kShards; i++) {
+			usage += shards_[i].usage.load();
+		}
+		return usage;
 	}
 
-	const int64_t kEstimatePairSize = sizeof(std::string) + sizeof(RefMutex<T> *    ) + sizeof(std::pair<std::string, void *>);
-
 	void lock() {
-        g_mutex_.lock();
+		g_mutex_.lock();
+		global_.store(true);
 
-        while (GetUsage() > 0) {
-            sched_yield();
-        }
-
-    }
+		while (GetUsage() > 0) {
+			sched_yield();
+		}
+	}
 
 	void unlock() {
-        g_mutex_.unlock();
-    }
+		global_.store(false);
+		g_mutex_.unlock();
+	}
 
 	void lockKeyInternal(const std::string &key) {
+		size_t hash = std::hash<std::string>()(key);
+		Shard &shard = shards_[hash % kShards];
+		RefMutex<T> *&head = shard.buckets[(hash / kShards) % kBuckets];
+
+		// counted before global_ is checked, lock() sets it before summing the counts
+		shard.usage.fetch_add(1);
+		while (global_.load()) {
+			shard.usage.fetch_sub(1);
+			g_mutex_.lock();
+			g_mutex_.unlock();
+			shard.usage.fetch_add(1);
+		}
 
-		mutex_.lock();
-		typename std::unordered_map<std::string, RefMutex<T> *>::const_iterator it = records_.find(key);
-
-		if (it != records_.end()) {
-			//log_info ("tid=(%u) >Lock key=(%s) exist, map_size=%u", pthread_self(), key.c_str(), records_.size());
-			RefMutex<T> *ref_mutex = it->second;
-			ref_mutex->Ref();
-			mutex_.unlock();
-
-			ref_mutex->Lock();
-			//log_info ("tid=(%u) <Lock key=(%s) exist", pthread_self(), key.c_str());
-		} else {
-			//log_info ("tid=(%u) >Lock key=(%s) new, map_size=%u ++", pthread_self(), key.c_str(), records_.size());
-			RefMutex<T> *ref_mutex = new RefMutex<T>();
-
-			records_.insert(std::make_pair(key, ref_mutex));
-			ref_mutex->Ref();
-			charge_ += kEstimatePairSize + key.size();
-			mutex_.unlock();
+		shard.mutex.lock();
+		RefMutex<T> *ref_mutex = head;
+		while (ref_mutex != nullptr && ref_mutex->key_ != key) {
+			ref_mutex = ref_mutex->next_;
+		}
 
-			ref_mutex->Lock();
-			//log_info ("tid=(%u) <Lock key=(%s) new", pthread_self(), key.c_str());
+		if (ref_mutex == nullptr) {
+			if (shard.pool != nullptr) {
+				ref_mutex = shard.pool;
+				shard.pool = ref_mutex->next_;
+				shard.pool_size--;
+			} else {
+				ref_mutex = new RefMutex<T>();
+			}
+			ref_mutex->key_.assign(key);
+			ref_mutex->next_ = head;
+			head = ref_mutex;
 		}
+		ref_mutex->Ref();
+		shard.mutex.unlock();
+
+		ref_mutex->Lock();
 	}
 
 	void Lock(const std::string &key) {
-        g_mutex_.lock();
-        g_mutex_.unlock();
-
 		lockKeyInternal(key);
 	}
 
 	void Unlock(const std::string &key) {
-		mutex_.lock();
-		typename std::unordered_map<std::string, RefMutex<T> *>::const_iterator it = records_.find(key);
+		size_t hash = std::hash<std::string>()(key);
+		Shard &shard = shards_[hash % kShards];
+		RefMutex<T> **link = &shard.buckets[(hash / kShards) % kBuckets];
 
-		//log_info ("tid=(%u) >Unlock key=(%s) new, map_size=%u --", pthread_self(), key.c_str(), records_.size());
-		if (it != records_.end()) {
-			RefMutex<T> *ref_mutex = it->second;
+		shard.mutex.lock();
+		while (*link != nullptr && (*link)->key_ != key) {
+			link = &(*link)->next_;
+		}
 
-			if (ref_mutex->IsLastRef()) {
-				charge_ -= kEstimatePairSize + key.size();
-				records_.erase(it);
-			}
+		RefMutex<T> *ref_mutex = *link;
+		if (ref_mutex != nullptr) {
 			ref_mutex->Unlock();
-			ref_mutex->Unref();
+			if (ref_mutex->Unref()) {
+				*link = ref_mutex->next_;
+				if (shard.pool_size < kPoolSize) {
+					ref_mutex->next_ = shard.pool;
+					shard.pool = ref_mutex;
+					shard.pool_size++;
+				} else {
+					delete ref_mutex;
+				}
+			}
+			shard.usage.fetch_sub(1);
 		}
 
-		mutex_.unlock();
-		//log_info ("tid=(%u) <Unlock key=(%s) new", pthread_self(), key.c_str());
+		shard.mutex.unlock();
 	}
 
 	SpinMutexLock g_mutex_;
 
 private:
-	T mutex_;
+	struct Shard {
+		T mutex;
+		std::atomic<int64_t> usage{0};
+		RefMutex<T> *buckets[kBuckets] = {};
+		RefMutex<T> *pool = nullptr;
+		size_t pool_size = 0;
+		// keeps the mutexes of neighbouring shards off one cache line
+		char padding[64];
+	};
 
-	std::unordered_map<std::string, RefMutex<T> *> records_;
-	int64_t charge_;
+	static void free_chain(RefMutex<T> *node) {
+		while (node != nullptr) {
+			RefMutex<T> *next = node->next_;
+			delete node;
+			node = next;
+		}
+	}
+
+	Shard shards_[kShards];
+	std::atomic<bool> global_;
 
 	// No copying
 	RecordMutex(const RecordMutex&);
@@ -345,16 +400,23 @@ class Queue{
 		int push(const T item);
 		// TODO: with timeout
 		int pop(T *data);
+		// wait for at least one item, then take up to max_items without waiting
+		int pop_batch(std::vector<T> *data, int max_items);
 };
 
 
 // Selectable queue, multi writers, single reader
+// fd() is readable exactly while the queue is not empty: only the push that
+// finds the queue empty signals it (an eventfd on linux, a pipe elsewhere),
+// and the reader clears it when it takes the last item.
 template <class T>
 class SelectableQueue{
 	private:
 		int fds[2];
 		pthread_mutex_t mutex;
-		std::queue<T> items;
+		std::vector<T> items;
+		void signal();
+		void clear_signal();
 	public:
 		SelectableQueue();
 		~SelectableQueue();
@@ -364,8 +426,11 @@ class SelectableQueue{
 		int size();
 		// multi writer
 		int push(const T item);
+		int push(const std::vector<T> &data);
 		// single reader
 		int pop(T *data);
+		// take every queued item with one wakeup, returns how many
+		int pop_all(std::vector<T> *data);
 };
 
 template<class W, class JOB>
@@ -380,6 +445,13 @@ class WorkerPool{
 				virtual void init(){}
 				virtual void destroy(){}
 				virtual int proc(JOB job) = 0;
+				// called instead of proc() when batch_size > 1
+				virtual int proc_batch(std::vector<JOB> &jobs){
+					for(int i=0; i<(int)jobs.size(); i++){
+						this->proc(jobs[i]);
+					}
+					return 0;
+				}
 			private:
 			protected:
 				std::string name;
@@ -390,6 +462,7 @@ class WorkerPool{
 		SelectableQueue<JOB> results;
 
 		int num_workers;
+		int batch_size;
 		std::vector<pthread_t> tids;
 		bool started;
 
@@ -409,10 +482,17 @@ class WorkerPool{
 		int start(int num_workers);
 		int stop();
 
+		// max jobs handed to Worker::proc_batch() at once, 1 means proc() per job
+		void set_batch_size(int batch_size){
+			this->batch_size = batch_size > 1 ? batch_size : 1;
+		}
+
 		std::queue<JOB> discard();
 		int queued();
 		int push(JOB job);
 		int pop(JOB *job);
+		// all finished jobs, for one readable event on fd()
+		int pop_all(std::vector<JOB> *jobs);
 };
 
 
@@ -505,13 +585,43 @@ int Queue<T>::pop(T *data){
 	return 1;
 }
 
+template <class T>
+int Queue<T>::pop_batch(std::vector<T> *data, int max_items){
+	if(pthread_mutex_lock(&mutex) != 0){
+		return -1;
+	}
+	{
+		while(items.empty()){
+			if(pthread_cond_wait(&cond, &mutex) != 0){
+				return -1;
+			}
+		}
+		while(!items.empty() && (int)data->size() < max_items){
+			data->push_back(items.front());
+			items.pop();
+		}
+	}
+	if(pthread_mutex_unlock(&mutex) != 0){
+		return -1;
+	}
+	return (int)data->size();
+}
+
 
 template <class T>
 SelectableQueue<T>::SelectableQueue(){
+#ifdef __linux__
+	fds[0] = fds[1] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if(fds[0] == -1){
+		fprintf(stderr, "create eventfd error\n");
+		exit(0);
+	}
+#else
 	if(pipe(fds) == -1){
 		fprintf(stderr, "create pipe error\n");
 		exit(0);
 	}
+#endif
 	pthread_mutex_init(&mutex, NULL);
 }
 
@@ -519,7 +629,36 @@ template <class T>
 SelectableQueue<T>::~SelectableQueue(){
 	pthread_mutex_destroy(&mutex);
 	close(fds[0]);
-	close(fds[1]);
+	if(fds[1] != fds[0]){
+		close(fds[1]);
+	}
+}
+
+// both called with mutex held
+template <class T>
+void SelectableQueue<T>::signal(){
+#ifdef __linux__
+	uint64_t one = 1;
+	if(::write(fds[1], &one, sizeof(one)) == -1){
+#else
+	if(::write(fds[1], "1", 1) == -1){
+#endif
+		fprintf(stderr, "write fds error\n");
+		exit(0);
+	}
+}
+
+template <class T>
+void SelectableQueue<T>::clear_signal(){
+#ifdef __linux__
+	uint64_t n;
+	while(::read(fds[0], &n, sizeof(n)) == -1 && errno == EINTR){
+	}
+#else
+	char buf[1];
+	while(::read(fds[0], buf, 1) == -1 && errno == EINTR){
+	}
+#endif
 }
 
 template <class T>
@@ -528,11 +667,29 @@ int SelectableQueue<T>::push(const T item){
 		return -1;
 	}
 	{
-		items.push(item);
+		items.push_back(item);
+		if(items.size() == 1){
+			signal();
+		}
 	}
-	if(::write(fds[1], "1", 1) == -1){
-		fprintf(stderr, "write fds error\n");
-		exit(0);
+	pthread_mutex_unlock(&mutex);
+	return 1;
+}
+
+template <class T>
+int SelectableQueue<T>::push(const std::vector<T> &data){
+	if(data.empty()){
+		return 1;
+	}
+	if(pthread_mutex_lock(&mutex) != 0){
+		return -1;
+	}
+	{
+		bool was_empty = items.empty();
+		items.insert(items.end(), data.begin(), data.end());
+		if(was_empty){
+			signal();
+		}
 	}
 	pthread_mutex_unlock(&mutex);
 	return 1;
@@ -549,37 +706,39 @@ int SelectableQueue<T>::size(){
 
 template <class T>
 int SelectableQueue<T>::pop(T *data){
-	int n, ret = 1;
-	char buf[1];
-
-	while(1){
-		n = ::read(fds[0], buf, 1);
-		if(n < 0){
-			if(errno == EINTR){
-				continue;
-			}else{
-				return -1;
-			}
-		}else if(n == 0){
-			ret = -1;
-		}else{
-			if(pthread_mutex_lock(&mutex) != 0){
-				return -1;
-			}
-			{
-				if(items.empty()){
-					fprintf(stderr, "%s %d error!\n", __FILE__, __LINE__);
-					pthread_mutex_unlock(&mutex);
-					return -1;
-				}
-				*data = items.front();
-				items.pop();
-			}
+	if(pthread_mutex_lock(&mutex) != 0){
+		return -1;
+	}
+	{
+		if(items.empty()){
+			fprintf(stderr, "%s %d error!\n", __FILE__, __LINE__);
 			pthread_mutex_unlock(&mutex);
+			return -1;
+		}
+		*data = items.front();
+		items.erase(items.begin());
+		if(items.empty()){
+			clear_signal();
 		}
-		break;
 	}
-	return ret;
+	pthread_mutex_unlock(&mutex);
+	return 1;
+}
+
+template <class T>
+int SelectableQueue<T>::pop_all(std::vector<T> *data){
+	data->clear();
+	if(pthread_mutex_lock(&mutex) != 0){
+		return -1;
+	}
+	{
+		if(!items.empty()){
+			data->swap(items);
+			clear_signal();
+		}
+	}
+	pthread_mutex_unlock(&mutex);
+	return (int)data->size();
 }
 
 
@@ -587,6 +746,7 @@ int SelectableQueue<T>::pop(T *data){
 template<class W, class JOB>
 WorkerPool<W, JOB>::WorkerPool(const char *name){
 	this->name = name;
+	this->batch_size = 1;
 	this->started = false;
 }
 
@@ -618,6 +778,11 @@ int WorkerPool<W, JOB>::pop(JOB *job){
 	return this->results.pop(job);
 }
 
+template<class W, class JOB>
+int WorkerPool<W, JOB>::pop_all(std::vector<JOB> *jobs){
+	return this->results.pop_all(jobs);
+}
+
 template<class W, class JOB>
 void* WorkerPool<W, JOB>::_run_worker(void *arg){
 	struct run_arg *p = (struct run_arg*)arg;
@@ -629,7 +794,23 @@ void* WorkerPool<W, JOB>::_run_worker(void *arg){
 	Worker *worker = (Worker *)&w;
 	worker->id = id;
 	worker->init();
+	std::vector<JOB> batch;
 	while(1){
+		if(tp->batch_size > 1){
+			batch.clear();
+			if(tp->jobs.pop_batch(&batch, tp->batch_size) == -1){
+				fprintf(stderr, "jobs.pop error\n");
+				::exit(0);
+				break;
+			}
+			worker->proc_batch(batch);
+			if(tp->results.push(batch) == -1){
+				fprintf(stderr, "results.push error\n");
+				::exit(0);
+			}
+			continue;
+		}
+
 		JOB job;
 		if(tp->jobs.pop(&job) == -1){
 			fprintf(stderr, "jobs.pop error\n");
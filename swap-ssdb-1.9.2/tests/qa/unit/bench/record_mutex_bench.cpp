@@ -0,0 +1,96 @@
+/*
+Copyright (c) 2017, Timothy. All rights reserved.
+Use of this source code is governed by a BSD-style license that can be
+found in the LICENSE file.
+*/
+
+/*
+ * record-mutex-bench [threads] [ops_per_thread] [keys]
+ *
+ * every thread locks a random key out of [keys], bumps its counter and unlocks,
+ * like a worker running one write command. a flusher thread takes the global
+ * lock now and then. prints the lock/unlock rate and fails on lost updates.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+#include <string>
+
+#include "util/thread.h"
+
+typedef RecordMutex<Mutex> RecordKeyMutex;
+typedef RecordLock<Mutex> RecordKeyLock;
+
+int main(int argc, char **argv) {
+    int threads = argc > 1 ? atoi(argv[1]) : 16;
+    int64_t ops = argc > 2 ? atoll(argv[2]) : 1000000;
+    int nkeys = argc > 3 ? atoi(argv[3]) : 10000;
+    if (threads <= 0 || ops <= 0 || nkeys <= 0) {
+        fprintf(stderr, "usage: %s [threads] [ops_per_thread] [keys]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<std::string> keys;
+    for (int i = 0; i < nkeys; i++) {
+        keys.push_back("bench_key_" + std::to_string(i));
+    }
+    std::vector<int64_t> counters(nkeys, 0);
+
+    RecordKeyMutex mutex_record;
+    volatile bool running = true;
+    int64_t global_locks = 0;
+
+    std::thread flusher([&]() {
+        while (running) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            Locking<RecordKeyMutex> gl(&mutex_record);
+            global_locks++;
+        }
+    });
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            std::mt19937 rng((unsigned int) t);
+            std::uniform_int_distribution<int> pick(0, nkeys - 1);
+            for (int64_t i = 0; i < ops; i++) {
+                int k = pick(rng);
+                RecordKeyLock l(&mutex_record, keys[k]);
+                counters[k]++;
+            }
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    running = false;
+    flusher.join();
+
+    double secs = std::chrono::duration<double>(end - start).count();
+    int64_t total = 0;
+    for (int64_t c : counters) {
+        total += c;
+    }
+
+    printf("threads: %d, keys: %d, ops: %" PRId64 ", global locks: %" PRId64 "\n",
+           threads, nkeys, total, global_locks);
+    printf("%.3f s, %.0f lock/unlock per second\n", secs, total / secs);
+
+    if (total != threads * ops) {
+        fprintf(stderr, "lost updates: %" PRId64 " of %" PRId64 "\n", threads * ops - total, threads * ops);
+        return 1;
+    }
+    if (mutex_record.GetUsage() != 0) {
+        fprintf(stderr, "usage not released: %" PRId64 "\n", mutex_record.GetUsage());
+        return 1;
+    }
+    return 0;
+}
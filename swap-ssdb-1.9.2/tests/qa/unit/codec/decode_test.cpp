@@ -403,3 +403,123 @@ TEST_F(DecodeTest, Test_EScoreItemKey) {
     for(int n = 0; n < sizeof(dummyDelKey)/sizeof(string); n++)
         EXPECT_EQ(-1, escorekey.DecodeItemKey(dummyDelKey[n]));
 }
+
+void compare_slot_format(const string & key, const string & field, uint64_t seq, uint16_t version){
+    uint16_t slot = (uint16_t)keyHashSlot(key.data(), (int)key.size());
+
+    set_key_format(KEY_FORMAT_SLOT);
+    string meta_key = encode_meta_key(key);
+    string hash_key = encode_hash_key(key, field, version);
+    string zscore_key = encode_zscore_key(key, field, 3.14, version);
+    string list_key = encode_list_key(key, seq, version);
+
+    MetaKey metakey;
+    EXPECT_EQ(0, metakey.DecodeMetaKey(meta_key));
+    EXPECT_EQ(slot, metakey.slot);
+    EXPECT_EQ(0, key.compare(metakey.key.String()));
+    EXPECT_EQ(0, meta_key.compare(0, 3, encode_slot_prefix(DataType::META, slot)));
+
+    ItemKey itemkey;
+    EXPECT_EQ(0, itemkey.DecodeItemKey(hash_key));
+    EXPECT_EQ(slot, itemkey.slot);
+    EXPECT_EQ(version, itemkey.version);
+    EXPECT_EQ(0, key.compare(itemkey.key));
+    EXPECT_EQ(0, field.compare(itemkey.field.String()));
+
+    ZScoreItemKey zscorekey;
+    EXPECT_EQ(0, zscorekey.DecodeItemKey(zscore_key));
+    EXPECT_EQ(slot, zscorekey.slot);
+    EXPECT_EQ(3.14, zscorekey.score);
+    EXPECT_EQ(0, field.compare(zscorekey.field.String()));
+
+    ListItemKey listkey;
+    EXPECT_EQ(0, listkey.DecodeItemKey(list_key));
+    EXPECT_EQ(slot, listkey.slot);
+    EXPECT_EQ(seq, listkey.seq);
+
+    set_key_format(KEY_FORMAT_PLAIN);
+    string converted;
+    EXPECT_EQ(1, convert_key_format(meta_key, KEY_FORMAT_SLOT, KEY_FORMAT_PLAIN, &converted));
+    EXPECT_EQ(encode_meta_key(key), converted);
+    EXPECT_EQ(1, convert_key_format(hash_key, KEY_FORMAT_SLOT, KEY_FORMAT_PLAIN, &converted));
+    EXPECT_EQ(encode_hash_key(key, field, version), converted);
+    EXPECT_EQ(1, convert_key_format(encode_zscore_key(key, field, 3.14, version), KEY_FORMAT_PLAIN, KEY_FORMAT_SLOT, &converted));
+    EXPECT_EQ(zscore_key, converted);
+    EXPECT_EQ(1, convert_key_format(encode_list_key(key, seq, version), KEY_FORMAT_PLAIN, KEY_FORMAT_SLOT, &converted));
+    EXPECT_EQ(list_key, converted);
+}
+
+TEST_F(DecodeTest, Test_SlotKeyFormat) {
+    uint16_t version = GetRandomVer_();
+    uint64_t seq = GetRandomSeq_();
+    string field = GetRandomField_();
+
+    //Some special keys
+    uint16_t keysNum = sizeof(Keys)/sizeof(string);
+
+    for(int n = 0; n < keysNum; n++)
+        compare_slot_format(Keys[n], field, seq, version);
+
+    //Some random keys
+    keysNum = 100;
+    for(int n = 0; n < keysNum; n++)
+    {
+        compare_slot_format(GetRandomKey_(), GetRandomField_(), GetRandomSeq_(), GetRandomVer_());
+    }
+
+    //keys without slot are kept as is
+    string converted;
+    string delete_key = encode_delete_key("key", version);
+    EXPECT_EQ(0, convert_key_format(delete_key, KEY_FORMAT_PLAIN, KEY_FORMAT_SLOT, &converted));
+    EXPECT_EQ(delete_key, converted);
+
+    //error return
+    EXPECT_EQ(-1, convert_key_format(string("S\x00\x09", 3), KEY_FORMAT_PLAIN, KEY_FORMAT_SLOT, &converted));
+}
+
+TEST_F(DecodeTest, Test_MetaDelta) {
+    uint16_t version = GetRandomVer_();
+    char type;
+    int64_t delta;
+
+    string operand = encode_meta_delta(DataType::HSIZE, -3);
+    EXPECT_EQ(0, decode_meta_delta(operand, &type, &delta));
+    EXPECT_EQ((char) DataType::HSIZE, type);
+    EXPECT_EQ(-3, delta);
+    EXPECT_EQ(-1, decode_meta_delta(operand.substr(0, 5), &type, &delta));
+
+    //collection length
+    string meta_val = encode_hash_meta_val(10, version);
+    EXPECT_EQ(0, apply_meta_delta(&meta_val, true, operand));
+    EXPECT_EQ(encode_hash_meta_val(7, version), meta_val);
+    EXPECT_EQ(-1, apply_meta_delta(&meta_val, true, encode_meta_delta(DataType::HSIZE, -7)));
+    EXPECT_EQ(-1, apply_meta_delta(&meta_val, true, encode_meta_delta(DataType::ZSIZE, 1)));
+    EXPECT_EQ(-1, apply_meta_delta(&meta_val, false, encode_meta_delta(DataType::HSIZE, 1)));
+    EXPECT_EQ(encode_hash_meta_val(7, version), meta_val);
+
+    string deleted = encode_set_meta_val(5, version, KEY_DELETE_MASK);
+    EXPECT_EQ(-1, apply_meta_delta(&deleted, true, encode_meta_delta(DataType::SSIZE, 1)));
+
+    //kv increment
+    string kv_val;
+    EXPECT_EQ(0, apply_meta_delta(&kv_val, false, encode_meta_delta(DataType::KV, 5)));
+    EXPECT_EQ(encode_kv_val("5", 0), kv_val);
+    EXPECT_EQ(0, apply_meta_delta(&kv_val, true, encode_meta_delta(DataType::KV, -8)));
+    EXPECT_EQ(encode_kv_val("-3", 0), kv_val);
+    EXPECT_EQ(-1, apply_meta_delta(&kv_val, true, encode_meta_delta(DataType::KV, INT64_MIN)));
+
+    kv_val = encode_kv_val("abc", version);
+    EXPECT_EQ(-1, apply_meta_delta(&kv_val, true, encode_meta_delta(DataType::KV, 1)));
+    kv_val = encode_kv_val("abc", UINT16_MAX, KEY_DELETE_MASK);
+    EXPECT_EQ(0, apply_meta_delta(&kv_val, true, encode_meta_delta(DataType::KV, 1)));
+    EXPECT_EQ(encode_kv_val("1", 0), kv_val);
+    meta_val = encode_hash_meta_val(10, version);
+    EXPECT_EQ(-1, apply_meta_delta(&meta_val, true, encode_meta_delta(DataType::KV, 1)));
+
+    //folding
+    string out;
+    EXPECT_EQ(0, combine_meta_delta(encode_meta_delta(DataType::ZSIZE, 4), encode_meta_delta(DataType::ZSIZE, -1), &out));
+    EXPECT_EQ(encode_meta_delta(DataType::ZSIZE, 3), out);
+    EXPECT_EQ(-1, combine_meta_delta(encode_meta_delta(DataType::ZSIZE, 4), encode_meta_delta(DataType::KV, 1), &out));
+    EXPECT_EQ(-1, combine_meta_delta(encode_meta_delta(DataType::KV, INT64_MAX), encode_meta_delta(DataType::KV, 1), &out));
+}
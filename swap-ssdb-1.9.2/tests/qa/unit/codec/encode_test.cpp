@@ -487,6 +487,67 @@ TEST_F(EncodeTest, Test_encode_zset_score_prefix) {
     delete space;
 }
 
+void compare_encode_zrank_key(const string & key, uint16_t version, double score, char* expectStr){
+    uint64_t bits = encodeScore(score);
+    uint8_t* pbits = (uint8_t*)&bits;
+    char prefix[8];
+    for(int i = 0; i < 8; i++)
+    {
+        prefix[i] = pbits[7-i];
+    }
+
+    uint16_t keylen = key.size();
+    uint8_t* pkeylen = (uint8_t*)&keylen;
+    uint8_t* pversion = (uint8_t*)&version;
+    expectStr[0] = 'r';
+    expectStr[1] = pkeylen[1];
+    expectStr[2] = pkeylen[0];
+    memcpy(expectStr+3, key.data(), keylen);
+    expectStr[keylen+3] = pversion[1];
+    expectStr[keylen+4] = pversion[0];
+
+    for(uint8_t level = 0; level <= 8; level++)
+    {
+        string key_zrank = encode_zrank_key(key, version, level, Bytes(prefix, level));
+        expectStr[keylen+5] = level;
+        memcpy(expectStr+6+keylen, prefix, level);
+        EXPECT_EQ(6+keylen+level, key_zrank.size());
+        EXPECT_EQ(0, key_zrank.compare(0, 6+keylen+level, expectStr, 6+keylen+level));
+    }
+}
+
+TEST_F(EncodeTest, Test_encode_zrank_key) {
+    char* space = new char[maxKeyLen_+14];
+    string key;
+    uint16_t version;
+
+    //Some random keys
+    uint16_t keysNum = 100;
+    for(int n = 0; n < keysNum; n++)
+    {
+        key = GetRandomKey_();
+        version = GetRandomVer_();
+        compare_encode_zrank_key(key, version, GetRandomDouble_(), space);
+    }
+
+    //Some special keys
+    keysNum = sizeof(Keys)/sizeof(string);
+
+    for(int n = 0; n < keysNum; n++)
+        compare_encode_zrank_key(Keys[n], version, GetRandomDouble_(), space);
+
+    //MaxLength key
+    compare_encode_zrank_key(GetRandomBytes_(maxKeyLen_), version, GetRandomDouble_(), space);
+
+    //siblings of a node sort the same as the scores
+    string lower = encode_zrank_key("key", 1, 1, Bytes("\x01", 1));
+    string upper = encode_zrank_key("key", 1, 1, Bytes("\x02", 1));
+    EXPECT_LT(lower, upper);
+    EXPECT_EQ(0, lower.compare(0, encode_zrank_prefix("key", 1).size(), encode_zrank_prefix("key", 1)));
+
+    delete space;
+}
+
 void compare_encode_escore_key(const string & key, uint64_t ts, char* expectStr){
     string escore_key = encode_escore_key(key, ts);
     expectStr[0] = 'T';
@@ -555,3 +616,46 @@ TEST_F(EncodeTest, Test_encode_eset_key) {
 
     delete space;
 }
+
+void compare_collection_prefix(const string & key, const string & field, uint16_t version){
+    for (int format : {KEY_FORMAT_PLAIN, KEY_FORMAT_SLOT}) {
+        set_key_format(format);
+        string prefix = encode_hash_key(key, "", version);
+
+        for (const string & item : {encode_hash_key(key, field, version), encode_list_key(key, 7, version),
+                                    encode_zscore_key(key, field, 3.14, version),
+                                    encode_zrank_key(key, version, 1, field.substr(0, 1))}) {
+            EXPECT_EQ((int) prefix.size(), collection_prefix_size(item.data(), item.size(), format));
+        }
+        EXPECT_EQ((int) prefix.size(), collection_prefix_size(prefix.data(), prefix.size(), format));
+        EXPECT_EQ(-1, collection_prefix_size(prefix.data(), prefix.size() - 1, format));
+
+        string meta_key = encode_meta_key(key);
+        EXPECT_EQ(-1, collection_prefix_size(meta_key.data(), meta_key.size(), format));
+    }
+    set_key_format(KEY_FORMAT_PLAIN);
+}
+
+TEST_F(EncodeTest, Test_collection_prefix_size) {
+    uint16_t version = GetRandomVer_();
+
+    //Some special keys
+    uint16_t keysNum = sizeof(Keys)/sizeof(string);
+
+    for(int n = 0; n < keysNum; n++)
+        compare_collection_prefix(Keys[n], GetRandomField_(), version);
+
+    //Some random keys
+    keysNum = 100;
+    for(int n = 0; n < keysNum; n++)
+    {
+        compare_collection_prefix(GetRandomKey_(), GetRandomField_(), GetRandomVer_());
+    }
+
+    //keys without a collection prefix
+    string delete_key = encode_delete_key("key", version);
+    EXPECT_EQ(-1, collection_prefix_size(delete_key.data(), delete_key.size(), KEY_FORMAT_PLAIN));
+    string escore_key = encode_escore_key("key", 100);
+    EXPECT_EQ(-1, collection_prefix_size(escore_key.data(), escore_key.size(), KEY_FORMAT_PLAIN));
+    EXPECT_EQ(-1, collection_prefix_size("", 0, KEY_FORMAT_PLAIN));
+}
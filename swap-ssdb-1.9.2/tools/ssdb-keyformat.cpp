@@ -0,0 +1,214 @@
+/*
+Copyright (c) 2017, Timothy. All rights reserved.
+Use of this source code is governed by a BSD-style license that can be
+found in the LICENSE file.
+*/
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "rocksdb/db.h"
+#include "rocksdb/options.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/iterator.h"
+#include "rocksdb/write_batch.h"
+
+#include "codec/encode.h"
+#include "util/bytes.h"
+#include "util/strings.h"
+#include "ssdb/t_merge.h"
+
+static const std::string REPOPID_CF = "repopid";
+static const int BATCH_KEYS = 10000;
+
+void welcome(){
+	printf("ssdb-keyformat - convert a swapdb data dir between key formats\n");
+	printf("\n");
+}
+
+void usage(int argc, char **argv){
+	printf("Usage:\n");
+	printf("    %s src_data_dir dst_data_dir plain|slot\n", argv[0]);
+	printf("\n");
+	printf("src_data_dir is the data dir of a stopped ssdb-server, e.g. ./var/data\n");
+	printf("dst_data_dir must not exist, set rocksdb.key_slot_prefix to match\n");
+	printf("the new format and point work_dir at it before restarting.\n");
+	printf("\n");
+}
+
+static rocksdb::DB* open_db(const std::string &dir, bool create, const std::vector<std::string> &names,
+						   std::vector<rocksdb::ColumnFamilyHandle*> *handles){
+	rocksdb::Options options;
+	options.create_if_missing = create;
+	options.error_if_exists = create;
+	options.create_missing_column_families = create;
+	// meta values may still hold merge operands of rocksdb.meta_merge
+	options.merge_operator = std::make_shared<MetaDeltaMergeOperator>();
+	if (create) {
+		options.PrepareForBulkLoad();
+	}
+
+	std::vector<rocksdb::ColumnFamilyDescriptor> column_families;
+	for (const auto &name : names) {
+		column_families.emplace_back(rocksdb::ColumnFamilyDescriptor(name, name == REPOPID_CF ?
+																		   rocksdb::ColumnFamilyOptions() : options));
+	}
+
+	rocksdb::DB *db = nullptr;
+	rocksdb::Status s = rocksdb::DB::Open(options, dir, column_families, handles, &db);
+	if (!s.ok()) {
+		fprintf(stderr, "open %s error: %s\n", dir.c_str(), s.ToString().c_str());
+		return nullptr;
+	}
+	return db;
+}
+
+static int copy_cf(rocksdb::DB *src, rocksdb::ColumnFamilyHandle *src_cf, rocksdb::DB *dst, rocksdb::ColumnFamilyHandle *dst_cf,
+				   int from, int to, uint64_t *total){
+	rocksdb::ReadOptions iterate_options(false, false);
+	std::unique_ptr<rocksdb::Iterator> it(src->NewIterator(iterate_options, src_cf));
+
+	rocksdb::WriteOptions write_opts;
+	write_opts.disableWAL = true;
+
+	rocksdb::WriteBatch batch;
+	std::string key;
+	for (it->SeekToFirst(); it->Valid(); it->Next()) {
+		Bytes raw(it->key().data(), (int) it->key().size());
+		if (convert_key_format(raw, from, to, &key) < 0) {
+			fprintf(stderr, "malformed key: %s\n", hexmem(raw.data(), raw.size()).c_str());
+			return -1;
+		}
+		batch.Put(dst_cf, key, it->value());
+		(*total)++;
+
+		if (batch.Count() >= BATCH_KEYS) {
+			rocksdb::Status s = dst->Write(write_opts, &batch);
+			if (!s.ok()) {
+				fprintf(stderr, "write error: %s\n", s.ToString().c_str());
+				return -1;
+			}
+			batch.Clear();
+		}
+		if ((*total) % 1000000 == 0) {
+			printf("%" PRIu64 " keys converted\n", *total);
+		}
+	}
+	if (!it->status().ok()) {
+		fprintf(stderr, "iterate error: %s\n", it->status().ToString().c_str());
+		return -1;
+	}
+
+	rocksdb::Status s = dst->Write(write_opts, &batch);
+	if (!s.ok()) {
+		fprintf(stderr, "write error: %s\n", s.ToString().c_str());
+		return -1;
+	}
+	return 0;
+}
+
+int main(int argc, char **argv){
+	welcome();
+
+	if(argc <= 3){
+		usage(argc, argv);
+		return 0;
+	}
+	std::string src_dir(argv[1]);
+	std::string dst_dir(argv[2]);
+	std::string format(argv[3]);
+
+	int to;
+	if (format == "plain") {
+		to = KEY_FORMAT_PLAIN;
+	} else if (format == "slot") {
+		to = KEY_FORMAT_SLOT;
+	} else {
+		usage(argc, argv);
+		return 1;
+	}
+
+	// repopid is always the second one, class column families follow when split
+	std::vector<std::string> names = {rocksdb::kDefaultColumnFamilyName, REPOPID_CF};
+	std::vector<std::string> existing;
+	rocksdb::Status s = rocksdb::DB::ListColumnFamilies(rocksdb::Options(), src_dir, &existing);
+	if (!s.ok()) {
+		fprintf(stderr, "list column families of %s error: %s\n", src_dir.c_str(), s.ToString().c_str());
+		return 1;
+	}
+	for (const auto &name : existing) {
+		if (name != rocksdb::kDefaultColumnFamilyName && name != REPOPID_CF) {
+			names.push_back(name);
+		}
+	}
+
+	std::vector<rocksdb::ColumnFamilyHandle*> src_handles;
+	rocksdb::DB *src = open_db(src_dir, false, names, &src_handles);
+	if (src == nullptr) {
+		return 1;
+	}
+
+	int from = KEY_FORMAT_PLAIN;
+	std::string val;
+	s = src->Get(rocksdb::ReadOptions(), src_handles[1], encode_key_format_key(), &val);
+	if (s.ok()) {
+		from = str_to_int(val);
+	} else if (!s.IsNotFound()) {
+		fprintf(stderr, "get key format error: %s\n", s.ToString().c_str());
+		return 1;
+	}
+	printf("converting %s (%s) to %s (%s)\n", src_dir.c_str(), from == KEY_FORMAT_SLOT ? "slot" : "plain",
+		   dst_dir.c_str(), format.c_str());
+
+	std::vector<rocksdb::ColumnFamilyHandle*> dst_handles;
+	rocksdb::DB *dst = open_db(dst_dir, true, names, &dst_handles);
+	if (dst == nullptr) {
+		return 1;
+	}
+
+	uint64_t total = 0;
+	for (size_t i = 0; i < names.size(); i++) {
+		if (names[i] != REPOPID_CF && copy_cf(src, src_handles[i], dst, dst_handles[i], from, to, &total) != 0) {
+			return 1;
+		}
+	}
+	// repo keys carry no slot, copy them as they are
+	uint64_t repo_total = 0;
+	if (copy_cf(src, src_handles[1], dst, dst_handles[1], KEY_FORMAT_PLAIN, KEY_FORMAT_PLAIN, &repo_total) != 0) {
+		return 1;
+	}
+
+	s = dst->Put(rocksdb::WriteOptions(), dst_handles[1], encode_key_format_key(), str(to));
+	if (!s.ok()) {
+		fprintf(stderr, "save key format error: %s\n", s.ToString().c_str());
+		return 1;
+	}
+	for (auto handle : dst_handles) {
+		s = dst->Flush(rocksdb::FlushOptions(), handle);
+		if (!s.ok()) {
+			fprintf(stderr, "flush error: %s\n", s.ToString().c_str());
+			return 1;
+		}
+	}
+	printf("compacting %s\n", dst_dir.c_str());
+	for (size_t i = 0; i < names.size(); i++) {
+		if (names[i] != REPOPID_CF) {
+			dst->CompactRange(rocksdb::CompactRangeOptions(), dst_handles[i], nullptr, nullptr);
+		}
+	}
+
+	for (auto handle : src_handles) {
+		delete handle;
+	}
+	for (auto handle : dst_handles) {
+		delete handle;
+	}
+	delete src;
+	delete dst;
+
+	printf("done, %" PRIu64 " keys converted\n", total);
+	return 0;
+}